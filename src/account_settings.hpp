@@ -8,6 +8,7 @@
 #include <core/entity/proxy_query.hpp>
 #include <core/helpers/utils.hpp>
 #include <formatters.hpp>
+#include <service/session.hpp>
 
 namespace app
 {
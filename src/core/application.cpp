@@ -20,6 +20,7 @@ using namespace phosphor::logging;
 using namespace app::obmc::entity;
 
 constexpr const char* yawebInitGuradFile = YAWEB_INIT_GUARD_FILE;
+constexpr auto initializationCheckPeriod = 500ms;
 
 void Application::initDBusConnect()
 {
@@ -62,19 +63,46 @@ void Application::removeInitGuardFile()
     fs::remove(filePath);
 }
 
-void Application::finishInitialization()
+void Application::scheduleInitializationCheck(
+    const std::shared_ptr<std::promise<void>>& initialized)
 {
-    while (!isBaseEntitiesInitialized())
-    {
+    timerWheel.schedule(initializationCheckPeriod, [this, initialized]() {
+        try
+        {
+            if (isBaseEntitiesInitialized())
+            {
+                initialized->set_value();
+                return;
+            }
+        }
+        catch (...)
+        {
+            // The check is performed by the timer wheel thread, so the error
+            // is passed to the waiting thread via the promise.
+            initialized->set_exception(std::current_exception());
+            return;
+        }
         log<level::DEBUG>("Waits for important Entity instances initialization "
                           "are completed...");
-        std::this_thread::sleep_for(5s);
+        scheduleInitializationCheck(initialized);
+    });
+}
+
+void Application::finishInitialization()
+{
+    if (!isBaseEntitiesInitialized())
+    {
+        auto initialized = std::make_shared<std::promise<void>>();
+        auto initializedFuture = initialized->get_future();
+        scheduleInitializationCheck(initialized);
+        initializedFuture.get();
     }
     removeInitGuardFile();
 }
 
 void Application::configure()
 {
+    timerWheel.run();
     waitBootingBmc();
     registerAllRoutes();
     initDBusConnect();
@@ -100,6 +128,7 @@ void Application::start()
 void Application::terminate()
 {
     fastCgiManager.terminate();
+    timerWheel.terminate();
     dbusConnection.reset();
 }
 
@@ -6,9 +6,11 @@
 #include <core/connect/dbus_connect.hpp>
 #include <core/connection.hpp>
 #include <core/entity/entity_manager.hpp>
+#include <core/timer_wheel.hpp>
 #include <fastcgi++/manager.hpp>
 #include <phosphor-logging/log.hpp>
 
+#include <future>
 #include <memory>
 
 namespace app
@@ -61,6 +63,16 @@ class Application final
 
     const connect::DBusConnectUni& getDBusConnect() const;
 
+    /**
+     * @brief Get the timer wheel to perform deferred tasks
+     *
+     * @return TimerWheel&
+     */
+    TimerWheel& getTimerWheel()
+    {
+        return this->timerWheel;
+    }
+
   protected:
     void initEntities();
     void initDBusConnect();
@@ -69,6 +81,8 @@ class Application final
     void waitBootingBmc();
     bool isBaseEntitiesInitialized();
     void finishInitialization();
+    void scheduleInitializationCheck(
+        const std::shared_ptr<std::promise<void>>& initialized);
     inline void createInitGuardFile();
     inline void removeInitGuardFile();
     static void handleSignals(int signal);
@@ -77,6 +91,7 @@ class Application final
     connect::DBusConnectUni dbusConnection;
     entity::EntityManager entityManager;
     Fastcgipp::Manager<Connection> fastCgiManager;
+    TimerWheel timerWheel;
 };
 
 extern Application application;
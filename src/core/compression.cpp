@@ -0,0 +1,376 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2022 YADRO
+
+#include <zlib.h>
+
+#include <core/compression.hpp>
+#include <core/helpers/utils.hpp>
+#include <http/headers.hpp>
+#include <phosphor-logging/log.hpp>
+
+#include <array>
+#include <sstream>
+#include <streambuf>
+
+namespace app
+{
+namespace core
+{
+
+using namespace phosphor::logging;
+
+namespace
+{
+
+constexpr const char* codingGzip = "gzip";
+constexpr const char* codingDeflate = "deflate";
+constexpr const char* codingAny = "*";
+
+const char* getCodingName(ResponseCompressor::Encoding encoding)
+{
+    return encoding == ResponseCompressor::Encoding::gzip ? codingGzip
+                                                          : codingDeflate;
+}
+
+bool initDeflateStream(z_stream& stream, ResponseCompressor::Encoding encoding)
+{
+    static constexpr int windowBits = 15;
+    static constexpr int gzipWrapper = 16;
+    static constexpr int memLevel = 8;
+
+    const int streamWindowBits = encoding == ResponseCompressor::Encoding::gzip
+                                     ? windowBits + gzipWrapper
+                                     : windowBits;
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                     streamWindowBits, memLevel, Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+        log<level::ERR>("Fail to initialize the zlib stream");
+        return false;
+    }
+    return true;
+}
+
+void setEncodingHeader(const ResponsePtr& response,
+                       ResponseCompressor::Encoding encoding)
+{
+    using namespace app::http;
+
+    response->setHeader(headers::contentEncoding, getCodingName(encoding));
+}
+
+/**
+ * @class DeflateStreamBuf
+ * @brief The stream buffer which deflates the written data to the output
+ *        stream chunk by chunk.
+ */
+class DeflateStreamBuf final : public std::streambuf
+{
+    static constexpr std::size_t chunkSize = 16384;
+
+  public:
+    DeflateStreamBuf(const DeflateStreamBuf&) = delete;
+    DeflateStreamBuf& operator=(const DeflateStreamBuf&) = delete;
+    DeflateStreamBuf(DeflateStreamBuf&&) = delete;
+    DeflateStreamBuf& operator=(DeflateStreamBuf&&) = delete;
+
+    DeflateStreamBuf(std::ostream& output,
+                     ResponseCompressor::Encoding encoding) :
+        output(output),
+        stream{}, initialized(initDeflateStream(stream, encoding))
+    {
+        setp(input.data(), input.data() + input.size());
+    }
+
+    ~DeflateStreamBuf() override
+    {
+        if (initialized)
+        {
+            deflateEnd(&stream);
+        }
+    }
+
+    /**
+     * @brief Deflate the rest of data and write the stream trailer
+     */
+    bool finish()
+    {
+        return deflateInput(Z_FINISH);
+    }
+
+  protected:
+    int_type overflow(int_type ch) override
+    {
+        if (!deflateInput(Z_NO_FLUSH))
+        {
+            return traits_type::eof();
+        }
+        if (!traits_type::eq_int_type(ch, traits_type::eof()))
+        {
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+        }
+        return traits_type::not_eof(ch);
+    }
+
+    int sync() override
+    {
+        // The explicit flush of zlib would worsen the compression ratio, so
+        // only the pending input is consumed.
+        return deflateInput(Z_NO_FLUSH) ? 0 : -1;
+    }
+
+  private:
+    bool deflateInput(int flushMode)
+    {
+        if (!initialized)
+        {
+            return false;
+        }
+        stream.next_in = reinterpret_cast<Bytef*>(pbase());
+        stream.avail_in = static_cast<uInt>(pptr() - pbase());
+        int status = Z_OK;
+        do
+        {
+            stream.next_out = reinterpret_cast<Bytef*>(compressed.data());
+            stream.avail_out = static_cast<uInt>(compressed.size());
+            status = ::deflate(&stream, flushMode);
+            if (status == Z_STREAM_ERROR)
+            {
+                log<level::ERR>("Fail to compress the response body",
+                                entry("STATUS=%d", status));
+                initialized = false;
+                deflateEnd(&stream);
+                return false;
+            }
+            output.write(compressed.data(),
+                         static_cast<std::streamsize>(compressed.size() -
+                                                      stream.avail_out));
+        } while (stream.avail_out == 0 ||
+                 (flushMode == Z_FINISH && status != Z_STREAM_END));
+        setp(input.data(), input.data() + input.size());
+        return true;
+    }
+
+    std::ostream& output;
+    z_stream stream;
+    bool initialized;
+    std::array<char, chunkSize> input;
+    std::array<char, chunkSize> compressed;
+};
+
+} // namespace
+
+void ResponseCompressor::compress(const RequestPtr& request,
+                                  const ResponsePtr& response)
+{
+    setVaryHeader(response);
+    const auto encoding = negotiate(request->getAcceptEncoding());
+    if (encoding == Encoding::identity)
+    {
+        return;
+    }
+
+    const auto streamedResponse = std::dynamic_pointer_cast<Response>(response);
+    if (streamedResponse && streamedResponse->isStreamed())
+    {
+        streamedResponse->setBodyWriter(
+            [plainBody = streamedResponse->releaseBody(),
+             encoding](std::ostream& os) {
+                DeflateStreamBuf deflatedBuffer(os, encoding);
+                std::ostream deflated(&deflatedBuffer);
+                plainBody(deflated);
+                deflatedBuffer.finish();
+            });
+        setEncodingHeader(response, encoding);
+        return;
+    }
+
+    const auto& body = response->getBody();
+    if (response->isStreamed() || body.size() < compressionThreshold)
+    {
+        return;
+    }
+    const auto compressedBody = deflate(body, encoding);
+    if (!compressedBody)
+    {
+        return;
+    }
+    response->clear();
+    response->push(*compressedBody);
+    setEncodingHeader(response, encoding);
+}
+
+void ResponseCompressor::compress(const RequestPtr& request,
+                                  const ResponsePtr& response,
+                                  const std::string& validator)
+{
+    setVaryHeader(response);
+    const auto encoding = negotiate(request->getAcceptEncoding());
+    if (encoding == Encoding::identity)
+    {
+        return;
+    }
+
+    // The compressed body is kept to serve the representation later, hence
+    // the plain body is materialized once per representation change.
+    std::string streamedBody;
+    if (response->isStreamed())
+    {
+        std::ostringstream body;
+        response->writeBody(body);
+        streamedBody = body.str();
+    }
+    const std::string& body =
+        response->isStreamed() ? streamedBody : response->getBody();
+    if (body.size() < compressionThreshold)
+    {
+        if (response->isStreamed())
+        {
+            response->clear();
+            response->push(streamedBody);
+        }
+        return;
+    }
+    auto compressedBody = deflate(body, encoding);
+    if (!compressedBody)
+    {
+        return;
+    }
+
+    auto cachedBody =
+        std::make_shared<const std::string>(std::move(*compressedBody));
+    response->clear();
+    response->push(*cachedBody);
+    setEncodingHeader(response, encoding);
+    compressedBodies.insert(validator + ' ' + getCodingName(encoding),
+                            CachedBody{response->getContentType(),
+                                       std::move(cachedBody)});
+}
+
+ResponsePtr ResponseCompressor::find(const RequestPtr& request,
+                                     const std::string& validator)
+{
+    using namespace app::http;
+
+    const auto encoding = negotiate(request->getAcceptEncoding());
+    if (encoding == Encoding::identity)
+    {
+        return nullptr;
+    }
+    const auto cachedBody =
+        compressedBodies.find(validator + ' ' + getCodingName(encoding));
+    if (!cachedBody)
+    {
+        return nullptr;
+    }
+
+    auto response = std::make_shared<Response>();
+    response->setStatus(statuses::Code::OK);
+    response->setContentType(cachedBody->contentType);
+    response->push(*cachedBody->compressedBody);
+    setVaryHeader(response);
+    setEncodingHeader(response, encoding);
+    return response;
+}
+
+void ResponseCompressor::setVaryHeader(const ResponsePtr& response)
+{
+    using namespace app::http;
+
+    response->setHeader(headers::vary, "Accept-Encoding");
+}
+
+ResponseCompressor::Encoding
+    ResponseCompressor::negotiate(const std::string& acceptEncoding)
+{
+    using namespace app::helpers::utils;
+
+    std::optional<double> gzipQuality;
+    std::optional<double> deflateQuality;
+    std::optional<double> anyQuality;
+    for (const auto& item :
+         splitToVector(std::stringstream(acceptEncoding), ','))
+    {
+        const auto parameters = splitToVector(std::stringstream(item), ';');
+        if (parameters.empty())
+        {
+            continue;
+        }
+        const auto coding = toLower(trim(parameters.front()));
+        double quality = 1.0;
+        for (auto paramIt = std::next(parameters.begin());
+             paramIt != parameters.end(); ++paramIt)
+        {
+            const auto parameter = trim(*paramIt);
+            if (parameter.starts_with("q=") || parameter.starts_with("Q="))
+            {
+                try
+                {
+                    quality = std::stod(parameter.substr(2));
+                }
+                catch (const std::exception&)
+                {
+                    quality = 0.0;
+                }
+            }
+        }
+        if (coding == codingGzip || coding == "x-gzip")
+        {
+            gzipQuality = quality;
+        }
+        else if (coding == codingDeflate)
+        {
+            deflateQuality = quality;
+        }
+        else if (coding == codingAny)
+        {
+            anyQuality = quality;
+        }
+    }
+
+    const auto gzip = gzipQuality.value_or(anyQuality.value_or(0.0));
+    const auto deflate = deflateQuality.value_or(anyQuality.value_or(0.0));
+    if (gzip <= 0.0 && deflate <= 0.0)
+    {
+        return Encoding::identity;
+    }
+    return gzip >= deflate ? Encoding::gzip : Encoding::deflate;
+}
+
+std::optional<std::string> ResponseCompressor::deflate(const std::string& data,
+                                                       Encoding encoding)
+{
+    z_stream stream{};
+    if (!initDeflateStream(stream, encoding))
+    {
+        return std::nullopt;
+    }
+
+    std::string compressed;
+    compressed.resize(deflateBound(&stream, data.size()));
+    stream.next_in =
+        reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_out = reinterpret_cast<Bytef*>(compressed.data());
+    stream.avail_out = static_cast<uInt>(compressed.size());
+
+    const int status = ::deflate(&stream, Z_FINISH);
+    deflateEnd(&stream);
+    if (status != Z_STREAM_END)
+    {
+        log<level::ERR>("Fail to compress the response body",
+                        entry("STATUS=%d", status));
+        return std::nullopt;
+    }
+    compressed.resize(stream.total_out);
+    return compressed;
+}
+
+ResponseCompressor& ResponseCompressor::getInstance()
+{
+    static ResponseCompressor responseCompressor;
+    return responseCompressor;
+}
+
+} // namespace core
+} // namespace app
@@ -0,0 +1,123 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2022 YADRO
+
+#pragma once
+
+#include <core/helpers/lru_cache.hpp>
+#include <core/request.hpp>
+#include <core/response.hpp>
+
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace app
+{
+namespace core
+{
+
+/**
+ * @class ResponseCompressor
+ * @brief Compresses the response body with the content coding negotiated by
+ *        the 'Accept-Encoding' request header. The compressed bodies of the
+ *        validated representations are cached by the representation and its
+ *        ETag, so the unchanged resources polled repeatedly are neither
+ *        rendered nor deflated again.
+ */
+class ResponseCompressor final
+{
+    /** The bodies of the lesser size are sent as is */
+    static constexpr std::size_t compressionThreshold = 1024;
+    static constexpr std::size_t maxCachedBodies = 64;
+
+  public:
+    enum class Encoding
+    {
+        identity,
+        gzip,
+        deflate,
+    };
+
+    ResponseCompressor(const ResponseCompressor&) = delete;
+    ResponseCompressor& operator=(const ResponseCompressor&) = delete;
+    ResponseCompressor(ResponseCompressor&&) = delete;
+    ResponseCompressor& operator=(ResponseCompressor&&) = delete;
+
+    ~ResponseCompressor() = default;
+
+    /**
+     * @brief Compress the response body if the client accepts that and the
+     *        body is large enough. The streamed body is deflated while it is
+     *        written to the output, so its size is never checked. The
+     *        response is marked as varying by 'Accept-Encoding' even if it is
+     *        sent as is, since another client might get it compressed.
+     *
+     * @param request  - the request to negotiate the encoding
+     * @param response - the response to compress
+     */
+    void compress(const RequestPtr& request, const ResponsePtr& response);
+    /**
+     * @brief Compress the body of the validated representation and remember
+     *        it to serve the same representation later via `find()`.
+     *
+     * @param request   - the request to negotiate the encoding
+     * @param response  - the response to compress
+     * @param validator - the identity of the representation and its ETag
+     */
+    void compress(const RequestPtr& request, const ResponsePtr& response,
+                  const std::string& validator);
+    /**
+     * @brief Find the compressed body of the validated representation
+     *
+     * @param request   - the request to negotiate the encoding
+     * @param validator - the identity of the representation and its ETag
+     *
+     * @return ResponsePtr - the response with the compressed body or nullptr
+     *                       if the representation isn't compressed yet
+     */
+    ResponsePtr find(const RequestPtr& request, const std::string& validator);
+
+    /**
+     * @brief Choose the content coding by the 'Accept-Encoding' value
+     *
+     * @param acceptEncoding - the value of the request header
+     *
+     * @return Encoding - the most preferred supported coding
+     */
+    static Encoding negotiate(const std::string& acceptEncoding);
+
+    /**
+     * @brief Mark the response as the one which content coding is chosen by
+     *        the 'Accept-Encoding' request header, so the caches don't serve
+     *        the compressed body to the clients which don't accept that.
+     *
+     * @param response - the response to set the 'Vary' header
+     */
+    static void setVaryHeader(const ResponsePtr& response);
+
+    /**
+     * @brief Compress the data with zlib
+     *
+     * @return std::optional<std::string> - the compressed data or std::nullopt
+     *                                       if zlib fails
+     */
+    static std::optional<std::string> deflate(const std::string& data,
+                                              Encoding encoding);
+
+    static ResponseCompressor& getInstance();
+
+  private:
+    struct CachedBody
+    {
+        std::string contentType;
+        std::shared_ptr<const std::string> compressedBody;
+    };
+
+    ResponseCompressor() : compressedBodies(maxCachedBodies)
+    {}
+
+    helpers::LruCache<std::string, CachedBody> compressedBodies;
+};
+
+} // namespace core
+} // namespace app
@@ -3,7 +3,10 @@
 
 #include "dbus_connect.hpp"
 
+#include <poll.h>
+#include <sys/eventfd.h>
 #include <systemd/sd-bus.h>
+#include <time.h>
 #include <unistd.h>
 
 #include <core/connect/connect.hpp>
@@ -14,7 +17,9 @@
 #include <sdbusplus/bus/match.hpp>
 #include <sdbusplus/exception.hpp>
 
+#include <array>
 #include <chrono>
+#include <climits>
 #include <cstring>
 #include <functional>
 #include <memory>
@@ -30,17 +35,59 @@ using namespace std::chrono_literals;
 using namespace std::literals;
 using namespace phosphor::logging;
 
-DBusConnect::DBusConnect() : alive(false), dbusConnect(nullptr)
+namespace
+{
+
+int onAsyncReply(sd_bus_message* reply, void* userdata, sd_bus_error*)
+{
+    auto handler = static_cast<DBusConnect::AsyncReplyHandler*>(userdata);
+    try
+    {
+        sdbusplus::message::message replyMessage(reply);
+        std::invoke(*handler, replyMessage);
+    }
+    catch (const std::exception& ex)
+    {
+        log<level::ERR>("Fail to handle DBus method reply",
+                        entry("ERROR=%s", ex.what()));
+    }
+    return 0;
+}
+
+void onAsyncReplyDestroy(void* userdata)
+{
+    delete static_cast<DBusConnect::AsyncReplyHandler*>(userdata);
+}
+
+} // namespace
+
+DBusConnect::DBusConnect() :
+    alive(false), dbusConnect(nullptr), wakeupFd(-1), stopped(false)
 {}
 
 DBusConnect::~DBusConnect() noexcept
 {
     this->terminate();
     this->disconnect();
+    if (wakeupFd >= 0)
+    {
+        close(wakeupFd);
+    }
 }
 
 void DBusConnect::run()
 {
+    if (wakeupFd < 0)
+    {
+        wakeupFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (wakeupFd < 0)
+        {
+            throw std::runtime_error(
+                std::string("Can't create the DBus event loop wakeup fd: ") +
+                std::strerror(errno));
+        }
+    }
+    stopped.store(false);
     alive.store(true);
     thread =
         std::make_unique<std::thread>(std::bind(&DBusConnect::process, this));
@@ -51,43 +98,142 @@ void DBusConnect::terminate() noexcept
     alive.store(false);
     if (thread && thread->joinable())
     {
+        if (wakeupFd >= 0)
+        {
+            eventfd_write(wakeupFd, 1);
+        }
         thread->join();
         log<level::DEBUG>("DBus connection thread is terminated");
     }
+    // The event loop is joined and nobody else performs the submitted tasks.
+    // Don't leave requesters waiting for the tasks submitted right before
+    // termination, the later ones are rejected by `post()`.
+    stopped.store(true);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    runSubmittedTasks();
 }
 
 match::match DBusConnect::createWatcher(const std::string& rule,
                                         match::match::callback_t handler)
 {
-    DBusCallGuard<match::match> guard(capturedByThreadId, [&] {
-        log<level::DEBUG>("Create DBus signal watcher",
-                          entry("RULE=%s", rule.c_str()));
-        return std::forward<match::match>(
-            match::match(*getConnect(), rule, handler));
-    });
-    return std::forward<match::match>(guard());
+    return submit<match::match>([&] {
+               log<level::DEBUG>("Create DBus signal watcher",
+                                 entry("RULE=%s", rule.c_str()));
+               return match::match(*getConnect(), rule, handler);
+           })
+        .get();
+}
+
+bool DBusConnect::isEventLoopThread() const noexcept
+{
+    return eventLoopThreadId.load(std::memory_order_acquire) ==
+           std::this_thread::get_id();
+}
+
+void DBusConnect::post(Task&& task)
+{
+    if (submissionQueue.push(std::move(task)) && wakeupFd >= 0)
+    {
+        eventfd_write(wakeupFd, 1);
+    }
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (stopped.load())
+    {
+        // The event loop has been terminated while the task was submitted.
+        // The tasks must not be performed concurrently with the terminating
+        // thread, hence they are dropped to notify the requesters.
+        const auto rejected = submissionQueue.popAll();
+        if (!rejected.empty())
+        {
+            log<level::WARNING>(
+                "DBus event loop is terminated, the submitted tasks are "
+                "rejected",
+                entry("COUNT=%zu", rejected.size()));
+        }
+    }
+}
+
+void DBusConnect::runSubmittedTasks()
+{
+    for (auto& task : submissionQueue.popAll())
+    {
+        std::invoke(task);
+    }
+}
+
+void DBusConnect::callAsync(sdbusplus::message::message& request,
+                            const AsyncReplyHandler& handler)
+{
+    auto replyHandler = std::make_unique<AsyncReplyHandler>(handler);
+    sd_bus_slot* slot = nullptr;
+    auto status = sd_bus_call_async(getConnect()->get(), &slot, request.get(),
+                                    onAsyncReply, replyHandler.get(), 0);
+    if (status < 0)
+    {
+        throw sdbusplus::exception::SdBusError(-status, "sd_bus_call_async");
+    }
+    // The slot is owned by the bus until the reply is handled, then the
+    // reply handler is released by the destroy callback.
+    sd_bus_slot_set_destroy_callback(slot, onAsyncReplyDestroy);
+    replyHandler.release();
+    sd_bus_slot_set_floating(slot, 1);
+    sd_bus_slot_unref(slot);
+}
+
+void DBusConnect::waitEvents()
+{
+    auto bus = getConnect()->get();
+    uint64_t timeoutUsec = UINT64_MAX;
+    int timeoutMs = -1;
+    if (sd_bus_get_timeout(bus, &timeoutUsec) >= 0 && timeoutUsec != UINT64_MAX)
+    {
+        // The sd-bus timeout is an absolute time of CLOCK_MONOTONIC.
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        const uint64_t nowUsec =
+            static_cast<uint64_t>(now.tv_sec) * 1000000 + now.tv_nsec / 1000;
+        timeoutMs = timeoutUsec > nowUsec
+                        ? static_cast<int>(std::min<uint64_t>(
+                              (timeoutUsec - nowUsec + 999) / 1000, INT_MAX))
+                        : 0;
+    }
+
+    std::array<struct pollfd, 2> fds{};
+    fds[0].fd = sd_bus_get_fd(bus);
+    fds[0].events = static_cast<short>(sd_bus_get_events(bus));
+    fds[1].fd = wakeupFd;
+    fds[1].events = POLLIN;
+    if (poll(fds.data(), fds.size(), timeoutMs) < 0 && errno != EINTR)
+    {
+        log<level::ERR>("Fail to wait DBus events",
+                        entry("ERROR=%s", std::strerror(errno)));
+        return;
+    }
+    if (fds[1].revents & POLLIN)
+    {
+        eventfd_t counter;
+        eventfd_read(wakeupFd, &counter);
+    }
 }
 
 void DBusConnect::process()
 {
+    eventLoopThreadId.store(std::this_thread::get_id(),
+                            std::memory_order_release);
     while (alive.load())
     {
         query::dbus::DBusInstance::cleanupInstacesWatchers();
         try
         {
+            runSubmittedTasks();
+            // Dispatch all incoming messages before going to sleep.
+            while (getConnect()->process_discard())
+            {}
+            if (!alive.load())
             {
-                // non-blocking wait to allow atomic exchange dbus-call-window
-                // state
-                DBusCallGuard<void> guard(
-                    capturedByThreadId,
-                    [&]() {
-                        getConnect()->wait(0);
-                        getConnect()->process_discard();
-                    },
-                    10);
-                guard();
+                break;
             }
-            std::this_thread::sleep_for(1ms);
+            waitEvents();
         }
         catch (const sdbusplus::exception_t& ex)
         {
@@ -105,6 +251,8 @@ void DBusConnect::process()
             }
         }
     }
+    runSubmittedTasks();
+    eventLoopThreadId.store(std::thread::id(), std::memory_order_release);
     log<level::DEBUG>("Finish task of dbus connection handler");
 }
 
@@ -202,6 +350,8 @@ void DBusConnect::initServiceNamesWatcher()
                 return;
             }
             setServiceName(newOwner.size() ? newOwner : oldOwner, name);
+            app::query::dbus::DBusQuery::processServiceOwnerChanged(
+                name, !newOwner.empty());
         });
 }
 
@@ -253,6 +403,17 @@ const std::string&
     return it->second;
 }
 
+std::optional<std::string>
+    DBusConnect::findWellKnownServiceName(const std::string& uniqueName) const
+{
+    auto it = serviceNamesDict.find(uniqueName);
+    if (it == serviceNamesDict.end())
+    {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
 DBusConnectUni DBusConnect::createDbusConnection()
 {
 #ifdef BMC_DBUS_CONNECT_SYSTEM
@@ -6,16 +6,22 @@
 #include <config.h>
 
 #include <core/connect/connect.hpp>
+#include <core/helpers/mpsc_queue.hpp>
 #include <phosphor-logging/log.hpp>
 #include <sdbusplus/bus.hpp>
 #include <sdbusplus/bus/match.hpp>
+#include <sdbusplus/exception.hpp>
 
 #include <atomic>
 #include <chrono>
 #include <cstring>
 #include <functional>
+#include <future>
+#include <map>
 #include <memory>
+#include <optional>
 #include <thread>
+#include <vector>
 
 namespace app
 {
@@ -37,94 +43,14 @@ class DBusConnect : protected IConnect
 {
     /** sdbusplus connection object wrapper around `sd_bus*` */
     std::unique_ptr<sdbusplus::bus::bus> sdbusConnect;
-    std::atomic<std::thread::id> capturedByThreadId;
-
-  private:
-    /**
-     * @brief DBus call may be requested from different threads and we must
-     *        protect dbus-resources access.
-     *        The DBusCallGuard performs non-blocking wait until configured
-     *        operation from anather thread is completed.
-     */
-    template <typename TOpRet>
-    class DBusCallGuard
-    {
-        std::atomic<std::thread::id>& threadIdRef;
-        std::function<TOpRet()> operation;
-        const uint8_t priority;
-        bool calledUnsafe;
-
-      public:
-        DBusCallGuard(std::atomic<std::thread::id>& capturedByThreadId,
-                      std::function<TOpRet()>&& operation,
-                      uint8_t priority = 5) :
-            threadIdRef(capturedByThreadId),
-            operation(operation), priority(priority), calledUnsafe(false)
-        {
-            if (priority == 0)
-            {
-                throw std::logic_error("Priority cannot be zero");
-            }
-        }
-
-        TOpRet operator()()
-        {
-            using namespace std::chrono;
-            using namespace std::chrono_literals;
-            auto currentThreadId = std::this_thread::get_id();
-            auto vocationThreadId = std::thread::id(0);
-
-            while (!threadIdRef.compare_exchange_strong(
-                vocationThreadId, currentThreadId, std::memory_order_seq_cst))
-            {
-                if (isSameThread(vocationThreadId))
-                {
-                    auto currentThreadHash =
-                        std::hash<std::thread::id>{}(currentThreadId);
-                    log<level::DEBUG>(
-                        "Call DBus unsafe",
-                        entry("THREAD_ID=0x%08X", currentThreadHash));
-                    calledUnsafe = true;
-                    return std::invoke(operation);
-                }
-                std::this_thread::sleep_for(priority * 20us);
-                vocationThreadId = std::thread::id(0);
-            }
-            return std::invoke(operation);
-        }
-
-        /**
-         * @brief Destroy the DBusCallGuard object
-         *        The configured operation may raise an exception and
-         *        the threadIdRef might be frozen in a busy state.
-         *        Destructor cared about safe reverting threadIdRef to ready
-         *        state.
-         */
-        ~DBusCallGuard()
-        {
-            if (calledUnsafe)
-            {
-                return;
-            }
-            threadIdRef.store(std::thread::id(0), std::memory_order_acq_rel);
-        }
-
-      protected:
-        inline bool
-            isSameThread(std::atomic<std::thread::id> capturedByThreadId,
-                         std::thread::id currentThreadId =
-                             std::this_thread::get_id()) noexcept
-        {
-            // After comparing it doesn't matter which value of
-            // `currentThreadId` is.
-            // So do memory_order_relaxed without synchronization.
-            auto tmpThreadId = capturedByThreadId.load();
-            return capturedByThreadId.compare_exchange_strong(
-                currentThreadId, tmpThreadId, std::memory_order_relaxed);
-        }
-    };
+    /** the thread that runs the event loop and owns the dbus connection */
+    std::atomic<std::thread::id> eventLoopThreadId;
 
   public:
+    using Task = std::function<void()>;
+    using AsyncReplyHandler =
+        std::function<void(sdbusplus::message::message&)>;
+
     DBusConnect(const DBusConnect&) = delete;
     DBusConnect& operator=(const DBusConnect&) = delete;
     DBusConnect(DBusConnect&&) = delete;
@@ -165,15 +91,81 @@ class DBusConnect : protected IConnect
                           const std::string& interface,
                           const std::string& method, Args... args)
     {
-        DBusCallGuard<Ret> guard(
-            capturedByThreadId,
-            [&]() -> Ret {
-                return callMethodAndReadUnsafe<Ret, Args...>(
-                    busName, path, interface, method,
-                    std::forward<Args>(args)...);
-            },
-            1);
-        return guard();
+        if (!alive.load() || isEventLoopThread())
+        {
+            // Nobody else owns the connection: either the event loop isn't
+            // started yet or the call is requested by a signal handler.
+            return callMethodAndReadUnsafe<Ret, Args...>(
+                busName, path, interface, method, std::forward<Args>(args)...);
+        }
+        return callMethodAsync<Ret, Args...>(busName, path, interface, method,
+                                             std::forward<Args>(args)...)
+            .get();
+    }
+
+    /** @brief Asynchronously call DBus method with specified return type.
+     *         The call is performed by the event loop thread and the
+     *         requester isn't blocked until the reply is received.
+     *
+     * @note   The future must not be waited by the event loop thread itself
+     *         (i.e. from a signal handler), the reply is dispatched by the
+     *         same thread.
+     *
+     * @tparam Ret                    - Type of method call result
+     * @tparam Args                   - A set of types of the dbus-method
+     *                                  parameters
+     *
+     * @param busName                 - DBus service name
+     * @param path                    - DBus object path
+     * @param interface               - DBus interface
+     * @param method                  - DBus method name
+     * @param args                    - DBus method parameters
+     *
+     * @return std::future<Ret>       - The future of DBus method call result.
+     *                                  The DBus error is rethrown as
+     *                                  sdbusplus::exception_t on `get()`.
+     */
+    template <typename Ret, typename... Args>
+    std::future<Ret> callMethodAsync(const std::string& busName,
+                                     const std::string& path,
+                                     const std::string& interface,
+                                     const std::string& method, Args... args)
+    {
+        auto promise = std::make_shared<std::promise<Ret>>();
+        auto result = promise->get_future();
+        auto replyHandler = [promise](sdbusplus::message::message& reply) {
+            try
+            {
+                if (reply.is_method_error())
+                {
+                    throw sdbusplus::exception::SdBusError(reply.get_errno(),
+                                                           "DBus method call");
+                }
+                Ret resp;
+                reply.read(resp);
+                promise->set_value(std::move(resp));
+            }
+            catch (...)
+            {
+                promise->set_exception(std::current_exception());
+            }
+        };
+        submit<void>([this, promise, busName, path, interface, method,
+                      replyHandler = std::move(replyHandler), args...]() {
+            try
+            {
+                auto reqMsg = getConnect()->new_method_call(
+                    busName.c_str(), path.c_str(), interface.c_str(),
+                    method.c_str());
+                reqMsg.append(args...);
+                callAsync(reqMsg, replyHandler);
+            }
+            catch (...)
+            {
+                promise->set_exception(std::current_exception());
+            }
+        });
+        return result;
     }
 
     /** @brief Directly call DBus method with specified return type
@@ -215,7 +207,6 @@ class DBusConnect : protected IConnect
      * @tparam Args                   - A set of types of the dbus-method
      *                                  parameters
      *
-     * @param guard                   - DBus request guard
      * @param busName                 - DBus service name
      * @param path                    - DBus object path
      * @param interface               - DBus interface
@@ -231,12 +222,57 @@ class DBusConnect : protected IConnect
                     const std::string& interface, const std::string& method,
                     Args&&... args)
     {
-        auto reqMsg = getConnect()->new_method_call(
-            busName.c_str(), path.c_str(), interface.c_str(), method.c_str());
-        reqMsg.append(std::forward<Args>(args)...);
-        getConnect()->call_noreply(reqMsg);
+        submit<void>([&]() {
+            auto reqMsg = getConnect()->new_method_call(
+                busName.c_str(), path.c_str(), interface.c_str(),
+                method.c_str());
+            reqMsg.append(std::forward<Args>(args)...);
+            getConnect()->call_noreply(reqMsg);
+        }).get();
+    }
+
+    /**
+     * @brief Submit the operation to be performed by the DBus event loop
+     *        thread. The operation is performed immediately if it is
+     *        requested by the event loop thread itself or if the event loop
+     *        isn't started.
+     *
+     * @tparam TOpRet                 - Type of the operation result
+     *
+     * @param operation               - The operation that accesses the DBus
+     *                                  connection
+     *
+     * @return std::future<TOpRet>    - The future of the operation result
+     */
+    template <typename TOpRet>
+    std::future<TOpRet> submit(std::function<TOpRet()>&& operation)
+    {
+        auto task = std::make_shared<std::packaged_task<TOpRet()>>(
+            std::move(operation));
+        auto result = task->get_future();
+        if (!alive.load() || isEventLoopThread())
+        {
+            std::invoke(*task);
+            return result;
+        }
+        post([task]() { std::invoke(*task); });
+        return result;
     }
 
+    /**
+     * @brief Push the task to the submission queue and wake up the event
+     *        loop. Unlike `submit()` the task is always deferred, even if it
+     *        is posted by the event loop thread: it will be performed after
+     *        all pending DBus messages are dispatched.
+     *
+     * @note  The task posted after the event loop is terminated is dropped
+     *        without performing, so the requester waiting for its result
+     *        gets the broken promise error.
+     *
+     * @param task - The task to perform
+     */
+    void post(Task&& task);
+
     /**
      * @brief Create a DBus signals watcher
      *
@@ -254,6 +290,16 @@ class DBusConnect : protected IConnect
      * @return const std::string& - DBus well-known service name
      */
     const std::string& getWellKnownServiceName(const std::string& uniqueName);
+    /**
+     * @brief Find the Well-Known DBus-service name by specified dbus-unique
+     *        name without waiting for the service appearance
+     *
+     * @param uniqueName - DBus unique service name
+     * @return std::optional<std::string> - DBus well-known service name or
+     *                                      std::nullopt if it isn't known yet
+     */
+    std::optional<std::string>
+        findWellKnownServiceName(const std::string& uniqueName) const;
     /**
      * @brief Force update DBus well-known to unique service names dictionary
      */
@@ -264,12 +310,38 @@ class DBusConnect : protected IConnect
      * @return DBusConnectUni
      */
     static DBusConnectUni createDbusConnection();
+    /**
+     * @brief Check whether the current thread is the event loop thread
+     */
+    bool isEventLoopThread() const noexcept;
 
   protected:
     /**
-     * @brief Main process of observing dbus signals.
+     * @brief Main process of observing dbus signals and performing submitted
+     *        tasks. The thread sleeps until the DBus connection or the
+     *        submission queue has something to do.
      */
     void process();
+    /**
+     * @brief Perform all tasks pending in the submission queue.
+     */
+    void runSubmittedTasks();
+    /**
+     * @brief Wait until the DBus connection has events to process, the
+     *        connection timeout is expired or a task is submitted.
+     */
+    void waitEvents();
+    /**
+     * @brief Send the DBus method call message without blocking.
+     *        The reply handler is invoked by the event loop thread.
+     *
+     * @param request - The method call message
+     * @param handler - The callback to handle method reply or error
+     *
+     * @throw sdbusplus::exception_t - failure to send the message
+     */
+    void callAsync(sdbusplus::message::message& request,
+                   const AsyncReplyHandler& handler);
     /**
      * @brief Initialize DBus connection.
      */
@@ -312,6 +384,12 @@ class DBusConnect : protected IConnect
     sd_bus* dbusConnect;
     /** dbus-signal watcher thread */
     std::unique_ptr<std::thread> thread;
+    /** the tasks to be performed by the event loop thread */
+    helpers::MpscQueue<Task> submissionQueue;
+    /** eventfd to wake up the event loop on the task submission */
+    int wakeupFd;
+    /** flag to reject the tasks posted after the event loop is joined */
+    std::atomic_bool stopped;
     /** DBus unique to well-known service names dictionary */
     std::map<std::string, std::string> serviceNamesDict;
     /** Global singal handlers dict to store sdbusplus matchers */
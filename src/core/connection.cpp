@@ -5,6 +5,9 @@
 #include <core/connection.hpp>
 #include <phosphor-logging/log.hpp>
 
+#include <atomic>
+#include <limits>
+
 namespace app
 {
 namespace core
@@ -13,10 +16,24 @@ namespace core
 using namespace phosphor::logging;
 
 Connection::Connection() :
-    Fastcgipp::Request<char>(maxBodySizeByte), totalBytesRecived(0), request(),
-    router()
+    Fastcgipp::Request<char>(maxBodySizeByte), totalBytesRecived(0),
+    resumeToken(nextResumeToken()), request(), router()
 {}
 
+int Connection::nextResumeToken() noexcept
+{
+    // The message type zero is reserved by fastcgi++ for the FastCGI records.
+    static std::atomic<unsigned> lastToken(0);
+    static constexpr auto tokenMask =
+        static_cast<unsigned>(std::numeric_limits<int>::max());
+    int token;
+    do
+    {
+        token = static_cast<int>(++lastToken & tokenMask);
+    } while (token == 0);
+    return token;
+}
+
 void Connection::inHandler(int postSize)
 {
     log<level::DEBUG>("Accpeted new request", entry("POST_SIZE=%d", postSize));
@@ -56,13 +73,32 @@ bool Connection::response()
 {
     using namespace Fastcgipp::Http;
 
+    if (m_message.type != 0 && m_message.type != resumeToken)
+    {
+        log<level::DEBUG>("Response: ignore the resume message of another "
+                          "request",
+                          entry("TYPE=%d", m_message.type));
+        return false;
+    }
     if (!router)
     {
         log<level::ERR>("Response: router not initialized");
         return false;
     }
 
-    out << *(router->process());
+    // The request is suspended while the credentials are verified by the PAM
+    // workers. The fastcgi++ calls the 'response' again on the message posted
+    // by the resume callback.
+    const auto response = router->process(
+        [resume = callback(), token = resumeToken]() {
+            resume(Fastcgipp::Message(token));
+        });
+    if (!response)
+    {
+        return false;
+    }
+
+    out << *response;
     out.flush();
 
     return true;
@@ -37,7 +37,18 @@ class Connection : public Fastcgipp::Request<char>
     bool inProcessor() override;
 
   private:
+    /**
+     * @brief Get the unique token to match the resume messages of the request
+     */
+    static int nextResumeToken() noexcept;
+
     size_t totalBytesRecived;
+    /**
+     * The type of the resume messages of this request. The request id might
+     * be reused by the next request while the resume message of the previous
+     * one is still in flight, so the id alone can't match the message.
+     */
+    const int resumeToken;
 
     RequestPtr request;
     RouteUni router;
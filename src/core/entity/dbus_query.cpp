@@ -23,11 +23,362 @@ using namespace app::connect;
 
 DBusQuery::InstanceCreateHandlers DBusQuery::instanceCreateHandlers;
 DBusQuery::InstanceRemoveHandlers DBusQuery::instanceRemoveHandlers;
+std::unordered_map<std::size_t, DBusQuery::PendingObjectCreation>
+    DBusQuery::pendingObjectCreations;
+std::mutex DBusQuery::pendingObjectCreationsMutex;
+ObjectMapperCache DBusQuery::objectMapperCache;
+
+DBusInstance::ObservedInstancesMap DBusInstance::observedInstances;
+std::vector<ObjectPath> DBusInstance::toCleanupPaths;
+std::mutex DBusInstance::observedInstancesMutex;
+DBusInstance::NamespaceWatchersMap DBusInstance::namespaceWatchers;
+std::mutex DBusInstance::namespaceWatchersMutex;
+helpers::MpscQueue<DBusInstance::PropertiesUpdate>
+    DBusInstance::ingestionQueue;
+
+constexpr std::chrono::seconds objectMapperSettleWindow(1);
+
+std::optional<ObjectMapperCache::SubTree>
+    ObjectMapperCache::getSubTree(const DBusConnectUni& connect,
+                                  const ObjectPath& path, int32_t depth,
+                                  const InterfaceList& interfaces)
+{
+    return getSubTree(DBusSource(connect), path, depth, interfaces);
+}
+
+std::optional<ObjectMapperCache::SubTree>
+    ObjectMapperCache::getSubTree(const ISource& source,
+                                  const ObjectPath& path, int32_t depth,
+                                  const InterfaceList& interfaces)
+{
+    ObjectPath reqPath(path);
+    if (reqPath.size() > 1 && reqPath.ends_with('/'))
+    {
+        reqPath.pop_back();
+    }
+
+    auto lock = acquireLoaded(source);
+    SubTree subTree;
+    bool pathFound = objects.count(reqPath) > 0;
+    // Only the descendants are requested, the siblings sharing the name
+    // prefix (e.g. '/a/b1' for '/a/b') must be skipped.
+    const ObjectPath childPrefix = reqPath == "/" ? reqPath : reqPath + "/";
+    for (auto objectIt = objects.lower_bound(childPrefix);
+         objectIt != objects.end() && objectIt->first.starts_with(childPrefix);
+         ++objectIt)
+    {
+        const auto& [objectPath, services] = *objectIt;
+        if (objectPath == reqPath)
+        {
+            continue;
+        }
+        // The ObjectMapper implicitly knows all ancestors of its objects.
+        pathFound = true;
+        if (depth > 0 && app::helpers::utils::countExtraSegmentsOfPath(
+                             reqPath, objectPath) > depth)
+        {
+            continue;
+        }
+        DBusServiceInterfaces matchedServices;
+        for (const auto& [serviceName, implemented] : services)
+        {
+            if (hasAnyInterface(implemented, interfaces))
+            {
+                matchedServices.emplace(
+                    serviceName,
+                    InterfaceList(implemented.begin(), implemented.end()));
+            }
+        }
+        if (!matchedServices.empty())
+        {
+            subTree.emplace_back(objectPath, std::move(matchedServices));
+        }
+    }
+
+    if (!pathFound)
+    {
+        return std::nullopt;
+    }
+    return subTree;
+}
+
+ObjectMapperCache::ObjectServices
+    ObjectMapperCache::getObject(const DBusConnectUni& connect,
+                                 const ObjectPath& path,
+                                 const InterfaceList& interfaces)
+{
+    return getObject(DBusSource(connect), path, interfaces);
+}
+
+ObjectMapperCache::ObjectServices
+    ObjectMapperCache::getObject(const ISource& source, const ObjectPath& path,
+                                 const InterfaceList& interfaces)
+{
+    auto lock = acquireLoaded(source);
+    ObjectServices objectServices;
+    auto objectIt = objects.find(path);
+    if (objectIt == objects.end())
+    {
+        return objectServices;
+    }
+    for (const auto& [serviceName, implemented] : objectIt->second)
+    {
+        if (hasAnyInterface(implemented, interfaces))
+        {
+            objectServices.emplace_back(
+                serviceName,
+                InterfaceList(implemented.begin(), implemented.end()));
+        }
+    }
+    return objectServices;
+}
+
+ObjectMapperCache::SubTree
+    ObjectMapperCache::getAncestors(const DBusConnectUni& connect,
+                                    const ObjectPath& path,
+                                    const InterfaceList& interfaces)
+{
+    return getAncestors(DBusSource(connect), path, interfaces);
+}
+
+ObjectMapperCache::SubTree
+    ObjectMapperCache::getAncestors(const ISource& source,
+                                    const ObjectPath& path,
+                                    const InterfaceList& interfaces)
+{
+    auto lock = acquireLoaded(source);
+    SubTree ancestors;
+    for (auto separator = path.find('/'); separator != ObjectPath::npos;
+         separator = path.find('/', separator + 1))
+    {
+        const ObjectPath ancestorPath =
+            separator == 0 ? "/" : path.substr(0, separator);
+        if (ancestorPath == path)
+        {
+            break;
+        }
+        auto objectIt = objects.find(ancestorPath);
+        if (objectIt == objects.end())
+        {
+            continue;
+        }
+        DBusServiceInterfaces matchedServices;
+        for (const auto& [serviceName, implemented] : objectIt->second)
+        {
+            if (hasAnyInterface(implemented, interfaces))
+            {
+                matchedServices.emplace(
+                    serviceName,
+                    InterfaceList(implemented.begin(), implemented.end()));
+            }
+        }
+        if (!matchedServices.empty())
+        {
+            ancestors.emplace_back(ancestorPath, std::move(matchedServices));
+        }
+    }
+    return ancestors;
+}
+
+void ObjectMapperCache::addInterfaces(const ServiceName& service,
+                                      const ObjectPath& path,
+                                      const InterfaceList& interfaces)
+{
+    applyUpdate([service, path, interfaces](ObjectsMap& objectsMap) {
+        objectsMap[path][service].insert(interfaces.begin(), interfaces.end());
+    });
+}
+
+void ObjectMapperCache::removeInterfaces(const ServiceName& service,
+                                         const ObjectPath& path,
+                                         const InterfaceList& interfaces)
+{
+    applyUpdate([service, path, interfaces](ObjectsMap& objectsMap) {
+        auto objectIt = objectsMap.find(path);
+        if (objectIt == objectsMap.end())
+        {
+            return;
+        }
+        auto serviceIt = objectIt->second.find(service);
+        if (serviceIt == objectIt->second.end())
+        {
+            return;
+        }
+        for (const auto& interface : interfaces)
+        {
+            serviceIt->second.erase(interface);
+        }
+        if (serviceIt->second.empty())
+        {
+            objectIt->second.erase(serviceIt);
+        }
+        if (objectIt->second.empty())
+        {
+            objectsMap.erase(objectIt);
+        }
+    });
+}
+
+void ObjectMapperCache::removeService(const ServiceName& service)
+{
+    applyUpdate([service](ObjectsMap& objectsMap) {
+        for (auto objectIt = objectsMap.begin(); objectIt != objectsMap.end();)
+        {
+            objectIt->second.erase(service);
+            if (objectIt->second.empty())
+            {
+                objectIt = objectsMap.erase(objectIt);
+                continue;
+            }
+            ++objectIt;
+        }
+    });
+}
+
+void ObjectMapperCache::invalidate()
+{
+    std::lock_guard lock(mutex);
+    // The mirror which is loading right now is already fresh.
+    if (!loading)
+    {
+        loaded = false;
+        objects.clear();
+    }
+}
+
+std::shared_lock<std::shared_mutex>
+    ObjectMapperCache::acquireLoaded(const ISource& source)
+{
+    while (true)
+    {
+        {
+            std::shared_lock readLock(mutex);
+            if (loaded)
+            {
+                return readLock;
+            }
+        }
+
+        std::unique_lock lock(mutex);
+        if (source.isDispatcherThread())
+        {
+            if (loaded)
+            {
+                continue;
+            }
+            // The concurrent loader (if any) waits for its reply to be
+            // dispatched by this thread, so this thread must not wait for it.
+            // The signals aren't dispatched meanwhile either, so the directly
+            // loaded mirror is up to date.
+            lock.unlock();
+            auto loadedObjects = loadObjects(source);
+            lock.lock();
+            if (!loaded)
+            {
+                objects = std::move(loadedObjects);
+                loaded = true;
+                loadedCondition.notify_all();
+            }
+            continue;
+        }
+
+        loadedCondition.wait(lock, [this]() { return loaded || !loading; });
+        if (loaded)
+        {
+            continue;
+        }
+        loading = true;
+        loadingUpdates.clear();
+        // Don't hold the lock while the DBus call is in progress: the DBus
+        // event loop applies the signals to the mirror meanwhile.
+        lock.unlock();
+
+        ObjectsMap loadedObjects;
+        try
+        {
+            loadedObjects = loadObjects(source);
+        }
+        catch (const sdbusplus::exception_t&)
+        {
+            lock.lock();
+            loading = false;
+            loadingUpdates.clear();
+            loadedCondition.notify_all();
+            throw;
+        }
+
+        lock.lock();
+        for (const auto& update : loadingUpdates)
+        {
+            update(loadedObjects);
+        }
+        loadingUpdates.clear();
+        objects = std::move(loadedObjects);
+        loaded = true;
+        loading = false;
+        loadedCondition.notify_all();
+        log<level::DEBUG>("ObjectMapper mirror is loaded",
+                          entry("COUNT=%ld", objects.size()));
+    }
+}
+
+ObjectMapperCache::ObjectsMap
+    ObjectMapperCache::loadObjects(const ISource& source)
+{
+    ObjectsMap loadedObjects;
+    for (const auto& [objectPath, services] : source.getTree())
+    {
+        auto& objectServices = loadedObjects[objectPath];
+        for (const auto& [serviceName, interfaces] : services)
+        {
+            objectServices[serviceName].insert(interfaces.begin(),
+                                               interfaces.end());
+        }
+    }
+    return loadedObjects;
+}
+
+void ObjectMapperCache::applyUpdate(Update&& update)
+{
+    std::lock_guard lock(mutex);
+    // The mirror might be loaded by the dispatcher thread while another
+    // loader is still in progress, both of them have to be updated.
+    if (loaded)
+    {
+        update(objects);
+    }
+    if (loading)
+    {
+        loadingUpdates.emplace_back(std::move(update));
+    }
+}
+
+ObjectMapperCache::SubTree ObjectMapperCache::DBusSource::getTree() const
+{
+    return connect->callMethodAndRead<SubTree>(
+        "xyz.openbmc_project.ObjectMapper",
+        "/xyz/openbmc_project/object_mapper",
+        "xyz.openbmc_project.ObjectMapper", "GetSubTree", ObjectPath("/"),
+        int32_t(0), InterfaceList());
+}
 
-DBusInstance::WatchersMap DBusInstance::listeners;
-std::vector<DBusInstance::InstanceHash> DBusInstance::toCleanupInstances;
-std::atomic<std::thread::id> DBusInstance::instanceAccessGuard =
-    std::thread::id(0);
+bool ObjectMapperCache::DBusSource::isDispatcherThread() const noexcept
+{
+    return connect->isEventLoopThread();
+}
+
+bool ObjectMapperCache::hasAnyInterface(const InterfaceSet& implemented,
+                                        const InterfaceList& interfaces)
+{
+    if (interfaces.empty())
+    {
+        return true;
+    }
+    return std::any_of(interfaces.begin(), interfaces.end(),
+                       [&implemented](const InterfaceName& interface) {
+                           return implemented.count(interface) > 0;
+                       });
+}
 
 std::size_t FindObjectDBusQuery::DBusObjectEndpoint::getHash() const
 {
@@ -48,18 +399,24 @@ std::size_t FindObjectDBusQuery::DBusObjectEndpoint::getHash() const
 
 const entity::IEntity::InstanceCollection FindObjectDBusQuery::process()
 {
-    using DBusSubTreeOut =
-        std::vector<std::pair<std::string, DBusServiceInterfaces>>;
     std::vector<DBusInstancePtr> dbusInstances;
-    DBusSubTreeOut mapperResponse;
+    ObjectMapperCache::SubTree mapperResponse;
     try
     {
-        mapperResponse = getConnect()->callMethodAndRead<DBusSubTreeOut>(
-            "xyz.openbmc_project.ObjectMapper",
-            "/xyz/openbmc_project/object_mapper",
-            "xyz.openbmc_project.ObjectMapper", "GetSubTree",
-            getQueryCriteria().path, getQueryCriteria().depth,
+        auto subTree = getObjectMapperCache().getSubTree(
+            getConnect(), getQueryCriteria().path, getQueryCriteria().depth,
             getQueryCriteria().interfaces);
+        if (subTree.has_value())
+        {
+            mapperResponse = std::move(*subTree);
+        }
+        else
+        {
+            log<level::DEBUG>(
+                "Fail to process DBus query (namespace is not found)",
+                entry("DBUS_PATH=%s", getQueryCriteria().path.c_str()));
+            this->raiseError();
+        }
     }
     catch (const sdbusplus::exception_t& ex)
     {
@@ -72,6 +429,10 @@ const entity::IEntity::InstanceCollection FindObjectDBusQuery::process()
         this->raiseError();
     }
 
+    // Group the found objects by services to populate all objects of a
+    // service via the single ObjectManager call if it is available.
+    using ServiceObjects = std::vector<std::pair<ObjectPath, InterfaceList>>;
+    std::map<ServiceName, ServiceObjects> objectsByService;
     for (const auto& [objectPath, serviceInfoList] : mapperResponse)
     {
         for (const auto& [serviceName, interfaces] : serviceInfoList)
@@ -81,8 +442,51 @@ const entity::IEntity::InstanceCollection FindObjectDBusQuery::process()
             {
                 continue;
             }
-            auto instance =
-                this->createInstance(serviceName, objectPath, interfaces);
+            objectsByService[serviceName].emplace_back(objectPath, interfaces);
+        }
+    }
+
+    const auto hasBulkCandidates =
+        std::any_of(objectsByService.begin(), objectsByService.end(),
+                    [](const auto& serviceObjects) {
+                        return serviceObjects.second.size() >=
+                               minBulkPopulateObjects;
+                    });
+    const auto objectManagers = hasBulkCandidates
+                                    ? findObjectManagers()
+                                    : std::map<ServiceName, ObjectPath>();
+    for (const auto& [serviceName, objects] : objectsByService)
+    {
+        DBusManagedObjects managedObjects;
+        const auto managerIt = objectManagers.find(serviceName);
+        if (objects.size() >= minBulkPopulateObjects &&
+            managerIt != objectManagers.end())
+        {
+            try
+            {
+                managedObjects =
+                    getManagedObjects(serviceName, managerIt->second);
+            }
+            catch (const sdbusplus::exception_t& ex)
+            {
+                // Fallback to query properties of each object
+                log<level::DEBUG>("Fail to get managed objects",
+                                  entry("DBUS_SVC=%s", serviceName.c_str()),
+                                  entry("DBUS_PATH=%s",
+                                        managerIt->second.c_str()),
+                                  entry("ERROR=%s", ex.what()));
+            }
+        }
+
+        static const DBusInterfacesMap notPrefetched;
+        for (const auto& [objectPath, interfaces] : objects)
+        {
+            const auto managedIt = managedObjects.find(
+                sdbusplus::message::object_path(objectPath));
+            auto instance = this->createInstance(
+                serviceName, objectPath, interfaces,
+                managedIt != managedObjects.end() ? managedIt->second
+                                                  : notPrefetched);
             dbusInstances.push_back(instance);
             instance->bindListeners(getConnect());
         }
@@ -100,6 +504,60 @@ const entity::IEntity::InstanceCollection FindObjectDBusQuery::process()
     return result;
 }
 
+std::map<ServiceName, ObjectPath>
+    FindObjectDBusQuery::findObjectManagers() const
+{
+    static const InterfaceList objectManagerIface{
+        "org.freedesktop.DBus.ObjectManager"};
+
+    std::map<ServiceName, ObjectPath> objectManagers;
+    auto registerManager = [&objectManagers](const ServiceName& serviceName,
+                                             const ObjectPath& managerPath) {
+        auto [managerIt, added] =
+            objectManagers.try_emplace(serviceName, managerPath);
+        // The deepest ObjectManager returns the smallest set of objects.
+        if (!added && managerIt->second.size() < managerPath.size())
+        {
+            managerIt->second = managerPath;
+        }
+    };
+
+    const auto& criteriaPath = getQueryCriteria().path;
+    try
+    {
+        const auto ancestors = getObjectMapperCache().getAncestors(
+            getConnect(), criteriaPath, objectManagerIface);
+        for (const auto& [managerPath, services] : ancestors)
+        {
+            for (const auto& [serviceName, _] : services)
+            {
+                registerManager(serviceName, managerPath);
+            }
+        }
+    }
+    catch (const sdbusplus::exception_t& ex)
+    {
+        log<level::DEBUG>("Fail to find ancestor object managers",
+                          entry("DBUS_PATH=%s", criteriaPath.c_str()),
+                          entry("ERROR=%s", ex.what()));
+    }
+    try
+    {
+        const auto managers = getObjectMapperCache().getObject(
+            getConnect(), criteriaPath, objectManagerIface);
+        for (const auto& [serviceName, _] : managers)
+        {
+            registerManager(serviceName, criteriaPath);
+        }
+    }
+    catch (const sdbusplus::exception_t&)
+    {
+        // The namespace object itself is not an ObjectManager
+    }
+
+    return objectManagers;
+}
+
 bool FindObjectDBusQuery::checkCriteria(
     const ObjectPath& objectPath,
     std::optional<ServiceName> optionalServiceName) const
@@ -234,16 +692,12 @@ const ObjectPath& FindObjectDBusQuery::getObjectPathNamespace() const
 
 const IEntity::InstanceCollection IntrospectServiceDBusQuery::process()
 {
-    using ObjectValueTree =
-        std::map<sdbusplus::message::object_path, DBusInterfacesMap>;
     IEntity::InstanceCollection dbusInstances;
-    ObjectValueTree interfacesResponse;
+    DBusManagedObjects interfacesResponse;
 
     try
     {
-        interfacesResponse = getConnect()->callMethodAndRead<ObjectValueTree>(
-            serviceName.c_str(), "/", "org.freedesktop.DBus.ObjectManager",
-            "GetManagedObjects");
+        interfacesResponse = getManagedObjects(serviceName, "/");
     }
     catch (const sdbusplus::exception_t& e)
     {
@@ -329,11 +783,22 @@ const ObjectPath& IntrospectServiceDBusQuery::getObjectPathNamespace() const
 }
 
 void DBusInstance::initialize()
+{
+    initialize(DBusInterfacesMap());
+}
+
+void DBusInstance::initialize(const DBusInterfacesMap& prefetchedInterfaces)
 {
     bool hasError = false;
     setUninitialized();
     for (const auto& [interface, _] : targetProperties)
     {
+        const auto prefetchedIt = prefetchedInterfaces.find(interface);
+        if (prefetchedIt != prefetchedInterfaces.end())
+        {
+            fillMembers(interface, prefetchedIt->second);
+            continue;
+        }
         try
         {
             auto properties =
@@ -364,9 +829,11 @@ void DBusInstance::verifyState()
     }
 }
 
-DBusInstancePtr DBusQuery::createInstance(const ServiceName& serviceName,
-                                          const ObjectPath& objectPath,
-                                          const InterfaceList& interfaces)
+DBusInstancePtr
+    DBusQuery::createInstance(const ServiceName& serviceName,
+                              const ObjectPath& objectPath,
+                              const InterfaceList& interfaces,
+                              const DBusInterfacesMap& prefetchedInterfaces)
 {
     DBusPropertyEndpointMap epMap;
     for (const auto& interface : interfaces)
@@ -386,10 +853,22 @@ DBusInstancePtr DBusQuery::createInstance(const ServiceName& serviceName,
     auto instance = std::make_shared<DBusInstance>(serviceName, objectPath,
                                                    epMap, getWeakPtr());
 
-    instance->initialize();
+    instance->initialize(prefetchedInterfaces);
     return std::forward<DBusInstancePtr>(instance);
 }
 
+DBusManagedObjects
+    DBusQuery::getManagedObjects(const ServiceName& serviceName,
+                                 const ObjectPath& managerPath) const
+{
+    log<level::DEBUG>("Query managed objects of DBus service",
+                      entry("DBUS_SVC=%s", serviceName.c_str()),
+                      entry("DBUS_PATH=%s", managerPath.c_str()));
+    return getConnect()->callMethodAndRead<DBusManagedObjects>(
+        serviceName, managerPath, "org.freedesktop.DBus.ObjectManager",
+        "GetManagedObjects");
+}
+
 void DBusQuery::addObserver(sdbusplus::bus::match::match&& observer)
 {
     observers.push_back(std::move(observer));
@@ -442,18 +921,24 @@ bool DBusInstance::fillMembers(
     return true;
 }
 
-const IEntity::IEntityMember::InstancePtr&
+const IEntity::IEntityMember::InstancePtr
     DBusInstance::getField(const IEntity::EntityMemberPtr& member) const
 {
     return Entity::StaticInstance::getField(member);
 }
 
-const IEntity::IEntityMember::InstancePtr&
+const IEntity::IEntityMember::InstancePtr
     DBusInstance::getField(const MemberName& memberName) const
 {
     return Entity::StaticInstance::getField(memberName);
 }
 
+const IEntity::IEntityMember::InstancePtr
+    DBusInstance::getField(FieldSlot slot) const
+{
+    return Entity::StaticInstance::getField(slot);
+}
+
 const std::vector<MemberName> DBusInstance::getMemberNames() const
 {
     return std::forward<const std::vector<MemberName>>(
@@ -497,54 +982,152 @@ const DBusPropertiesMap
 }
 
 void DBusInstance::bindListeners(const connect::DBusConnectUni& connection)
+{
+    {
+        std::lock_guard lock(observedInstancesMutex);
+        auto& instances = observedInstances[objectPath];
+        std::erase_if(instances, [](const auto& instance) {
+            return instance.expired();
+        });
+        instances.emplace_back(weak_from_this());
+    }
+
+    const auto query = dbusQuery.lock();
+    ObjectPath namespacePath =
+        query ? query->getObjectPathNamespace() : objectPath;
+    // The path_namespace rule doesn't accept the trailing slash.
+    while (namespacePath.size() > 1 && namespacePath.ends_with('/'))
+    {
+        namespacePath.pop_back();
+    }
+    const bool isNamespace = !namespacePath.empty() && namespacePath != "/";
+    for (const auto& [interface, _] : targetProperties)
+    {
+        watchNamespace(connection,
+                       WatchScope{isNamespace ? namespacePath : objectPath,
+                                  interface, isNamespace});
+    }
+}
+
+void DBusInstance::watchNamespace(const connect::DBusConnectUni& connection,
+                                  const WatchScope& scope)
 {
     using namespace sdbusplus::bus::match;
 
-    auto selfWeak = weak_from_this();
+    auto isObserved = [&scope]() {
+        for (const auto& [observed, _] : namespaceWatchers)
+        {
+            if (observed.interface != scope.interface)
+            {
+                continue;
+            }
+            if (observed.isNamespace
+                    ? scope.path == observed.path ||
+                          scope.path.starts_with(observed.path + "/")
+                    : !scope.isNamespace && scope.path == observed.path)
+            {
+                return true;
+            }
+        }
+        return false;
+    };
+    {
+        std::lock_guard lock(namespaceWatchersMutex);
+        if (isObserved())
+        {
+            return;
+        }
+    }
+
+    // Don't hold the lock while the watcher is registered by the event loop
+    // that might wait for the same lock to apply properties updates.
+    auto connectionPtr = connection.get();
+    auto matcher = connection->createWatcher(
+        rules::type::signal() + rules::member("PropertiesChanged") +
+            rules::interface("org.freedesktop.DBus.Properties") +
+            (scope.isNamespace ? rules::pathNamespace(scope.path)
+                               : rules::path(scope.path)) +
+            rules::argN(0, scope.interface),
+        [connectionPtr](sdbusplus::message::message& message) {
+            ingestPropertiesChanged(*connectionPtr, message);
+        });
 
-    for (auto [interface, _] : targetProperties)
+    std::lock_guard lock(namespaceWatchersMutex);
+    if (isObserved())
     {
-        auto matcher = connection->createWatcher(
-            rules::propertiesChanged(this->getObjectPath(), interface),
-            [selfWeak,
-             queryPtr = dbusQuery](sdbusplus::message::message& message) {
-                std::map<PropertyName, DbusVariantType> changedValues;
-                InterfaceName interfaceName;
-                auto self = selfWeak.lock();
-                if (!self)
-                {
-                    return;
-                }
-                try
-                {
-                    message.read(interfaceName, changedValues);
-                }
-                catch (const std::exception& e)
-                {
-                    log<level::ERR>("Failed to process DBus signal handler",
-                                    entry("SIGNAL=PropertyChanged"),
-                                    entry("DBUS_OBJ=%s", message.get_path()),
-                                    entry("ERROR=%s", e.what()));
-                }
-                self->fillMembers(interfaceName, changedValues);
-                auto query = queryPtr.lock();
-                if (query)
-                {
-                    query->supplementByStaticFields(self);
-                }
-            });
+        // Another thread has registered the same scope meanwhile.
+        return;
+    }
+    namespaceWatchers.emplace(scope, std::move(matcher));
+    log<level::DEBUG>("The DBus signal watcher successfully registered",
+                      entry("SIGNAL=PropertyChanged"),
+                      entry("DBUS_NAMESPACE=%s", scope.path.c_str()),
+                      entry("DBUS_IFACE=%s", scope.interface.c_str()));
+}
 
-        log<level::DEBUG>("The DBus signal watcher successfully registered",
-                          entry("SIGNAL=PropertyChanged"),
-                          entry("DBUS_OBJ=%s", getObjectPath().c_str()),
-                          entry("DBUS_IFACE=%s", interface.c_str()));
+void DBusInstance::ingestPropertiesChanged(connect::DBusConnect& connection,
+                                           sdbusplus::message::message& message)
+{
+    PropertiesUpdate update;
+    try
+    {
+        update.objectPath = message.get_path();
+        message.read(update.interfaceName, update.properties);
+    }
+    catch (const std::exception& e)
+    {
+        log<level::ERR>("Failed to process DBus signal handler",
+                        entry("SIGNAL=PropertyChanged"),
+                        entry("DBUS_OBJ=%s", message.get_path()),
+                        entry("ERROR=%s", e.what()));
+        return;
+    }
+    if (ingestionQueue.push(std::move(update)))
+    {
+        connection.post(&DBusInstance::applyPropertiesUpdates);
+    }
+}
 
-        auto isLocked = instanceAccessGuardLock();
-        listeners[getHash()].emplace_back(
-            std::forward<sdbusplus::bus::match::match>(matcher));
-        if (isLocked)
+void DBusInstance::applyPropertiesUpdates()
+{
+    using UpdateKey = std::pair<ObjectPath, InterfaceName>;
+    std::map<UpdateKey, DBusPropertiesMap> coalescedUpdates;
+    for (auto& update : ingestionQueue.popAll())
+    {
+        auto& properties = coalescedUpdates[UpdateKey(
+            std::move(update.objectPath), std::move(update.interfaceName))];
+        // The latest value of a property wins.
+        for (auto& [propertyName, value] : update.properties)
         {
-            instanceAccessGuardUnlock();
+            properties.insert_or_assign(propertyName, std::move(value));
+        }
+    }
+
+    for (const auto& [key, properties] : coalescedUpdates)
+    {
+        const auto& [path, interfaceName] = key;
+        std::vector<std::weak_ptr<DBusInstance>> instances;
+        {
+            std::lock_guard lock(observedInstancesMutex);
+            auto instancesIt = observedInstances.find(path);
+            if (instancesIt == observedInstances.end())
+            {
+                continue;
+            }
+            instances = instancesIt->second;
+        }
+        for (const auto& instanceWeak : instances)
+        {
+            auto instance = instanceWeak.lock();
+            if (!instance || !instance->fillMembers(interfaceName, properties))
+            {
+                continue;
+            }
+            auto query = instance->dbusQuery.lock();
+            if (query)
+            {
+                query->supplementByStaticFields(instance);
+            }
         }
     }
 }
@@ -593,8 +1176,11 @@ void DBusInstance::supplementOrUpdate(const IEntity::InstancePtr& destination)
         {
             continue;
         }
-        this->supplementOrUpdate(memberName,
-                                 destination->getField(memberName)->getValue());
+        const auto value = destination->getFieldValue(fieldSlot(memberName));
+        if (value)
+        {
+            this->supplementOrUpdate(memberName, *value);
+        }
     }
 }
 
@@ -664,6 +1250,7 @@ void DBusInstance::captureDBusAssociations(
         this->complexInstances.insert_or_assign(childInstance->getHash(),
                                                 childInstance);
     }
+    notifyComplexChanged();
 }
 
 void DBusInstance::resolveDBusVariant(const MemberName& memberName,
@@ -707,7 +1294,8 @@ bool DBusInstance::isComplex() const
     return complexInstances.empty();
 }
 
-void DBusInstance::initDefaultFieldsValue()
+void DBusInstance::initDefaultFieldsValue(
+    const std::set<MemberName>& providedMembers)
 {
     const auto queryShr = dbusQuery.lock();
     if (!queryShr)
@@ -718,6 +1306,10 @@ void DBusInstance::initDefaultFieldsValue()
 
     for (const auto& [memberName, memberValueSetter] : defaultFields)
     {
+        if (providedMembers.contains(memberName))
+        {
+            continue;
+        }
         this->supplementOrUpdate(
             memberName, std::invoke(memberValueSetter, shared_from_this()));
     }
@@ -725,32 +1317,35 @@ void DBusInstance::initDefaultFieldsValue()
 
 void DBusInstance::cleanupInstacesWatchers()
 {
-    auto isLocked = instanceAccessGuardLock();
-
-    for (auto hash : toCleanupInstances)
+    std::lock_guard lock(observedInstancesMutex);
+    for (const auto& path : toCleanupPaths)
     {
-        auto it = listeners.find(hash);
-        if (it != listeners.end())
+        auto it = observedInstances.find(path);
+        if (it == observedInstances.end())
         {
-            listeners.erase(it);
+            continue;
+        }
+        std::erase_if(it->second, [](const auto& instance) {
+            return instance.expired();
+        });
+        if (it->second.empty())
+        {
+            observedInstances.erase(it);
+            // The watchers of the single object are not needed anymore.
+            std::lock_guard watchersLock(namespaceWatchersMutex);
+            std::erase_if(namespaceWatchers, [&path](const auto& watcher) {
+                return !watcher.first.isNamespace &&
+                       watcher.first.path == path;
+            });
         }
     }
-    toCleanupInstances.clear();
-
-    if (isLocked)
-    {
-        instanceAccessGuardUnlock();
-    }
+    toCleanupPaths.clear();
 }
 
 void DBusInstance::markInstanceIsUnavailable(const DBusInstance& instance)
 {
-    auto isLocked = instanceAccessGuardLock();
-    toCleanupInstances.emplace_back(instance.getHash());
-    if (isLocked)
-    {
-        instanceAccessGuardUnlock();
-    }
+    std::lock_guard lock(observedInstancesMutex);
+    toCleanupPaths.emplace_back(instance.getObjectPath());
 }
 
 const DBusPropertySetters&
@@ -786,14 +1381,26 @@ const DbusVariantType DBusQuery::processFormatters(const PropertyName& property,
     return formattedValue;
 }
 
+static std::size_t getSignalHash(const DBusQuery* query,
+                                 const ServiceName& serviceName,
+                                 const ObjectPath& objectPath)
+{
+    std::size_t hashQuery = std::hash<const DBusQuery*>{}(query);
+    std::size_t hashPath = std::hash<std::string>{}(objectPath);
+    std::size_t hashService = std::hash<std::string>{}(serviceName);
+
+    return (hashQuery ^ (hashService << 1) ^ (hashPath << 2));
+}
+
 void DBusQuery::registerObjectCreationObserver(
     std::reference_wrapper<entity::IEntity> entity)
 {
     using namespace sdbusplus::bus::match;
-    auto handler = [dbusQueryShr = this->getSharedPtr(),
-                    entity](const sdbusplus::message::object_path& objectPath,
-                            const DBusInterfacesMap& interfacesAdded,
-                            const std::string& sender) -> bool {
+    auto createInstanceHandler =
+        [dbusQueryShr = this->getSharedPtr(),
+         entity](const sdbusplus::message::object_path& objectPath,
+                 const DBusInterfacesMap& interfacesAdded,
+                 const std::string& sender) -> bool {
         InterfaceList interfacesList;
         const std::string& objectPathStr = objectPath.str;
 
@@ -855,6 +1462,76 @@ void DBusQuery::registerObjectCreationObserver(
         return true;
     };
 
+    // The signals are handled out of the DBus event loop thread. The signals
+    // of the same object arrived within the debounce window are coalesced to
+    // the single instance creation with the merged interfaces list.
+    auto handler = [dbusQueryShr = this->getSharedPtr(),
+                    createInstanceHandler = std::move(createInstanceHandler)](
+                       const sdbusplus::message::object_path& objectPath,
+                       const DBusInterfacesMap& interfacesAdded,
+                       const std::string& sender) -> bool {
+        const auto signalHash =
+            getSignalHash(dbusQueryShr.get(), sender, objectPath);
+        {
+            std::unique_lock lock(pendingObjectCreationsMutex);
+            auto [pendingIt, inserted] = pendingObjectCreations.try_emplace(
+                signalHash,
+                PendingObjectCreation{objectPath, interfacesAdded, sender,
+                                      std::chrono::steady_clock::now()});
+            if (!inserted)
+            {
+                auto& pending = pendingIt->second;
+                if (pending.objectPath == objectPath &&
+                    pending.sender == sender)
+                {
+                    pending.interfaces.insert(interfacesAdded.begin(),
+                                              interfacesAdded.end());
+                    return true;
+                }
+                // The signal hash collision: the pending creation belongs to
+                // another object, so the signal is handled without
+                // debouncing, but still out of the DBus event loop thread.
+                lock.unlock();
+                app::core::application.getTimerWheel().schedule(
+                    std::chrono::steady_clock::duration::zero(),
+                    [objectPath, interfacesAdded, sender,
+                     createInstanceHandler]() {
+                        createInstanceHandler(objectPath, interfacesAdded,
+                                              sender);
+                    });
+                return true;
+            }
+        }
+
+        app::core::application.getTimerWheel().debounce(
+            {typeid(DBusQuery), signalHash},
+            dbusQueryShr->getSignalDebounceWindow(),
+            [signalHash, createInstanceHandler]() {
+                PendingObjectCreation pending;
+                {
+                    std::lock_guard lock(pendingObjectCreationsMutex);
+                    auto pendingIt = pendingObjectCreations.find(signalHash);
+                    if (pendingIt == pendingObjectCreations.end())
+                    {
+                        return;
+                    }
+                    pending = std::move(pendingIt->second);
+                    pendingObjectCreations.erase(pendingIt);
+                }
+                createInstanceHandler(pending.objectPath, pending.interfaces,
+                                      pending.sender);
+
+                const auto latency =
+                    std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::steady_clock::now() - pending.signalTime);
+                log<level::DEBUG>("Handled 'InterfaceAdded' signal",
+                                  entry("DBUS_OBJ=%s",
+                                        pending.objectPath.str.c_str()),
+                                  entry("LATENCY_MS=%ld", latency.count()));
+            });
+        return true;
+    };
+
     DBusQuery::instanceCreateHandlers.push_back(std::move(handler));
 }
 
@@ -873,6 +1550,26 @@ void DBusQuery::registerObjectRemovingObserver(
         {
             return true;
         }
+        {
+            // The removed interfaces must not be resurrected by the creation
+            // which is still waiting for the debounce window.
+            std::lock_guard lock(pendingObjectCreationsMutex);
+            auto pendingIt = pendingObjectCreations.find(
+                getSignalHash(dbusQuery.get(), sender, objectPath));
+            if (pendingIt != pendingObjectCreations.end() &&
+                pendingIt->second.objectPath == objectPath &&
+                pendingIt->second.sender == sender)
+            {
+                for (const auto& interface : removedInterfaces)
+                {
+                    pendingIt->second.interfaces.erase(interface);
+                }
+                if (pendingIt->second.interfaces.empty())
+                {
+                    pendingObjectCreations.erase(pendingIt);
+                }
+            }
+        }
 
         try
         {
@@ -909,74 +1606,6 @@ void DBusQuery::registerObjectRemovingObserver(
     DBusQuery::instanceRemoveHandlers.push_back(std::move(handler));
 }
 
-template <typename THandlerCb>
-static void enqueueSignalHandler(size_t signalHash, THandlerCb handler)
-{
-    using namespace std::literals;
-
-    struct LockGuard
-    {
-        explicit LockGuard(std::atomic_bool& locked) : locked(locked)
-        {
-            bool expected = false;
-            while (!locked.compare_exchange_strong(expected, true,
-                                                   std::memory_order_seq_cst))
-            {
-                std::this_thread::sleep_for(1ms);
-                expected = false;
-            }
-        }
-        ~LockGuard()
-        {
-            locked.store(false);
-        }
-
-      private:
-        std::atomic_bool& locked;
-    };
-    static std::map<size_t, std::pair<std::time_t, THandlerCb>> handlers;
-    static std::atomic_bool locked;
-    static std::thread signalWorker([]() {
-        while (true)
-        {
-            std::this_thread::sleep_for(5s);
-            LockGuard guard(locked);
-            std::time_t now = std::time(nullptr);
-            std::vector<std::size_t> handled;
-            for (const auto& [hash, handlerPair] : handlers)
-            {
-                if (handlerPair.first < now)
-                {
-                    handlerPair.second();
-                    handled.emplace_back(hash);
-                }
-            }
-            // cleanup
-            for (const auto key : handled)
-            {
-                handlers.erase(key);
-            }
-        }
-    });
-
-    LockGuard guard(locked);
-    if (handlers.find(signalHash) == handlers.end())
-    {
-        // avoid debounce for 5 seconds
-        std::time_t now = std::time(nullptr) + 5;
-        handlers.emplace(signalHash, std::make_pair(now, handler));
-    }
-}
-
-static std::size_t getSignalHash(const ServiceName& serviceName,
-                                 const ObjectPath& objectPath)
-{
-    std::size_t hashPath = std::hash<std::string>{}(objectPath);
-    std::size_t hashService = std::hash<std::string>{}(serviceName);
-
-    return (hashService ^ (hashPath << 2));
-}
-
 static std::size_t getSignalHash(const ServiceName& serviceName,
                                  const ObjectPath& objectPath,
                                  const InterfaceList& interfaces)
@@ -1014,22 +1643,35 @@ bool DBusQuery::processGlobalSignal(sdbusplus::message::message& message,
     }
 
     const std::string sender = message.get_sender();
-    for (const auto& handler : handlers)
+    // The services which have no well-known name are not tracked by the
+    // ObjectMapper.
+    const auto serviceName =
+        app::core::application.getDBusConnect()->findWellKnownServiceName(
+            sender);
+    if (serviceName.has_value())
     {
-        if constexpr (std::is_same_v<decltype(handlers),
-                                     InstanceCreateHandlers>)
+        if constexpr (std::is_same_v<TInterfacesDict, DBusInterfacesMap>)
         {
-            auto signalHash = getSignalHash(sender, objectPath);
-            enqueueSignalHandler(signalHash, std::bind(handler, objectPath,
-                                                       interfacesDict, sender));
-            status = true;
+            InterfaceList interfaces;
+            for (const auto& [interfaceName, _] : interfacesDict)
+            {
+                interfaces.push_back(interfaceName);
+            }
+            objectMapperCache.addInterfaces(*serviceName, objectPath,
+                                            interfaces);
         }
         else
         {
-            if (handler(objectPath, interfacesDict, message.get_sender()))
-            {
-                status = true;
-            }
+            objectMapperCache.removeInterfaces(*serviceName, objectPath,
+                                               interfacesDict);
+        }
+    }
+
+    for (const auto& handler : handlers)
+    {
+        if (handler(objectPath, interfacesDict, sender))
+        {
+            status = true;
         }
     }
     return status;
@@ -1039,16 +1681,11 @@ InterfaceList DBusQuery::introspectDBusObjectInterfaces(
     const ServiceName& sn, const ObjectPath& op,
     const InterfaceList& searchInterfaces) const
 {
-    using DBusGetObjectOut = std::vector<std::pair<ServiceName, InterfaceList>>;
-    std::vector<DBusGetObjectOut> objectInfo;
-    DBusGetObjectOut mapperResponse;
+    ObjectMapperCache::ObjectServices mapperResponse;
     try
     {
-        mapperResponse = getConnect()->callMethodAndRead<DBusGetObjectOut>(
-            "xyz.openbmc_project.ObjectMapper",
-            "/xyz/openbmc_project/object_mapper",
-            "xyz.openbmc_project.ObjectMapper", "GetObject", op.c_str(),
-            searchInterfaces);
+        mapperResponse = getObjectMapperCache().getObject(getConnect(), op,
+                                                          searchInterfaces);
     }
     catch (const sdbusplus::exception_t& ex)
     {
@@ -1091,6 +1728,28 @@ void DBusQuery::processObjectRemove(sdbusplus::message::message& message)
                                        DBusQuery::instanceRemoveHandlers);
 }
 
+void DBusQuery::processServiceOwnerChanged(const ServiceName& serviceName,
+                                           bool hasOwner)
+{
+    if (!hasOwner)
+    {
+        objectMapperCache.removeService(serviceName);
+        return;
+    }
+    // The ObjectMapper introspects the started service asynchronously.
+    // Reload the mirror once the services startup burst settles down.
+    static const app::core::TimerWheel::DebounceKey invalidationKey{
+        typeid(ObjectMapperCache), 0};
+    app::core::application.getTimerWheel().debounce(
+        invalidationKey, objectMapperSettleWindow,
+        []() { objectMapperCache.invalidate(); });
+}
+
+ObjectMapperCache& DBusQuery::getObjectMapperCache()
+{
+    return objectMapperCache;
+}
+
 const DBusPropertyFormatters&
     DBusQuery::getFormatters(const PropertyName& property) const
 {
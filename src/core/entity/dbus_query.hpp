@@ -6,12 +6,20 @@
 #include <core/connect/dbus_connect.hpp>
 #include <core/entity/entity.hpp>
 #include <core/entity/event.hpp>
+#include <core/helpers/mpsc_queue.hpp>
 #include <sdbusplus/bus/match.hpp>
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <functional>
 #include <map>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <shared_mutex>
 #include <tuple>
+#include <unordered_map>
 #include <utility>
 #include <variant>
 #include <vector>
@@ -57,6 +65,8 @@ using DbusVariantType =
                  uint8_t, bool>;
 using DBusPropertiesMap = std::map<PropertyName, DbusVariantType>;
 using DBusInterfacesMap = std::map<InterfaceName, DBusPropertiesMap>;
+using DBusManagedObjects =
+    std::map<sdbusplus::message::object_path, DBusInterfacesMap>;
 
 using DBusServiceObjects = std::vector<std::pair<ObjectPath, ServiceName>>;
 
@@ -89,9 +99,33 @@ class DBusInstance final :
 {
     /** @brief Type of instance hash */
     using InstanceHash = std::size_t;
-    /** @brief The dictionary type of dbus-match watchers */
-    using WatchersMap =
-        std::map<InstanceHash, std::vector<sdbusplus::bus::match::match>>;
+    /** @brief The dictionary type of instances observed by dbus-signals */
+    using ObservedInstancesMap =
+        std::unordered_map<ObjectPath,
+                           std::vector<std::weak_ptr<DBusInstance>>>;
+    /**
+     * @brief The scope of the PropertiesChanged signal watcher: either the
+     *        objects namespace or the single object, and the interface of
+     *        changed properties.
+     */
+    struct WatchScope
+    {
+        ObjectPath path;
+        InterfaceName interface;
+        bool isNamespace;
+
+        auto operator<=>(const WatchScope&) const = default;
+    };
+    /** @brief The dictionary type of dbus-match watchers by scope */
+    using NamespaceWatchersMap =
+        std::map<WatchScope, sdbusplus::bus::match::match>;
+    /** @brief The payload of the PropertiesChanged signal */
+    struct PropertiesUpdate
+    {
+        ObjectPath objectPath;
+        InterfaceName interfaceName;
+        DBusPropertiesMap properties;
+    };
     /** @brief The DBus service of instance */
     const std::string serviceName;
     /** @brief The DBus object path of instace*/
@@ -116,21 +150,30 @@ class DBusInstance final :
      */
     std::map<InstanceHash, DBusInstancePtr> complexInstances;
     /**
-     * @brief watchers to observe the object/properties signals to
-     *        remove/update
+     * @brief The instances to update by the PropertiesChanged signal.
      */
-    static WatchersMap listeners;
+    static ObservedInstancesMap observedInstances;
     /**
-     * @brief when instances are removed, it is requried to clean up the dictionary
-     *        of registered dbus-match watchers. This dictionary contains those
-     *        instances that were already removed but haven't yet been pruned.
+     * @brief when instances are removed, it is requried to clean up the
+     *        dictionary of observed instances. This list contains the object
+     *        paths of instances that were already removed but haven't yet
+     *        been pruned.
      */
-    static std::vector<InstanceHash> toCleanupInstances;
-
+    static std::vector<ObjectPath> toCleanupPaths;
+    static std::mutex observedInstancesMutex;
+    /**
+     * @brief The dbus-match watchers of the PropertiesChanged signal by the
+     *        observed objects namespace and interface. The single watcher
+     *        serves all objects of the namespace. The objects of the root
+     *        namespace are watched one by one to not subscribe to the whole
+     *        bus.
+     */
+    static NamespaceWatchersMap namespaceWatchers;
+    static std::mutex namespaceWatchersMutex;
     /**
-     * @brief The DBusInstances internal resources access guard.
+     * @brief The received properties updates which are not applied yet.
      */
-    static std::atomic<std::thread::id> instanceAccessGuard;
+    static helpers::MpscQueue<PropertiesUpdate> ingestionQueue;
 
   public:
     DBusInstance(const DBusInstance&) = delete;
@@ -201,19 +244,28 @@ class DBusInstance final :
     /**
      * @brief Get the field by entity-member instance
      *
-     * @return const IEntity::IEntityMember::InstancePtr&
+     * @return const IEntity::IEntityMember::InstancePtr
      */
-    const IEntity::IEntityMember::InstancePtr&
+    const IEntity::IEntityMember::InstancePtr
         getField(const IEntity::EntityMemberPtr&) const override;
 
     /**
      * @brief Get the field by name
      *
-     * @return const IEntity::IEntityMember::InstancePtr& object of query field
-     *                                                    instance
+     * @return const IEntity::IEntityMember::InstancePtr the copy of query
+     *                                                   field instance
      */
-    const IEntity::IEntityMember::InstancePtr&
+    const IEntity::IEntityMember::InstancePtr
         getField(const MemberName&) const override;
+
+    /**
+     * @brief Get the field by slot identifier
+     *
+     * @return const IEntity::IEntityMember::InstancePtr the copy of query
+     *                                                   field instance
+     */
+    const IEntity::IEntityMember::InstancePtr
+        getField(FieldSlot) const override;
     /**
      * @brief Get the list of well-known members of instance that is origins
      *        from an IEntity
@@ -366,16 +418,25 @@ class DBusInstance final :
      *        avoid provide null-value if configured by endpoint map is not
      *        obtained
      */
-    void initDefaultFieldsValue() override;
+    void initDefaultFieldsValue(const std::set<MemberName>&) override;
 
     /**
-     * @brief Clean up dbus-match watchers
+     * @brief Clean up the removed instances from the dictionary of
+     *        instances that are observed by dbus-signals.
      *
      * @note thread-safe
      */
     static void cleanupInstacesWatchers();
 
     virtual void initialize();
+    /**
+     * @brief Initialize members by the properties which are already obtained
+     *        (e.g. via the ObjectManager). The properties of interfaces which
+     *        are absent in the specified dictionary are queried directly.
+     *
+     * @param prefetchedInterfaces - the properties of the object interfaces
+     */
+    void initialize(const DBusInterfacesMap& prefetchedInterfaces);
 
     void verifyState() override;
 
@@ -410,47 +471,180 @@ class DBusInstance final :
 
   private:
     /**
-     * @brief Lock access to the DBusInstances internal resources.
-     *
-     * @note Thread safe, non-blocking (like spin-lock), global scope
+     * @brief Register the PropertiesChanged signal watcher for the scope
+     *        unless the scope is already observed.
      *
-     * @return bool - true if locked, false if protection is not required.
+     * @param connection - DBus connection
+     * @param scope - the observed objects and interface
      */
-    inline static bool instanceAccessGuardLock()
-    {
-        using namespace std::chrono;
-        using namespace std::chrono_literals;
+    static void watchNamespace(const connect::DBusConnectUni& connection,
+                               const WatchScope& scope);
+    /**
+     * @brief Put the PropertiesChanged signal to the ingestion queue. The
+     *        queue is applied by the event loop after all pending signals
+     *        are received, so bursts of updates are coalesced.
+     */
+    static void ingestPropertiesChanged(connect::DBusConnect& connection,
+                                        sdbusplus::message::message& message);
+    /**
+     * @brief Apply the ingested properties updates to the observed
+     *        instances. The updates of the same object interface are merged
+     *        to touch the each field only once.
+     */
+    static void applyPropertiesUpdates();
+};
 
-        auto vocation = std::thread::id(0);
-        auto currentThreadId = std::this_thread::get_id();
+/**
+ * @class ObjectMapperCache
+ * @brief The in-process mirror of the ObjectMapper tree. The mirror is
+ *        loaded by the single `GetSubTree` call on `/` and then kept coherent
+ *        by the global `InterfacesAdded`/`InterfacesRemoved` signals and the
+ *        services owner changes. The lookups follow the ObjectMapper methods
+ *        semantic and are resolved locally without DBus round trips.
+ */
+class ObjectMapperCache final
+{
+  public:
+    /** @brief Output of the ObjectMapper `GetSubTree`/`GetAncestors` */
+    using SubTree = std::vector<std::pair<ObjectPath, DBusServiceInterfaces>>;
+    /** @brief Output of the ObjectMapper `GetObject` */
+    using ObjectServices = std::vector<std::pair<ServiceName, InterfaceList>>;
 
-        /* non-blocking guard to prevent onetime access to the
-         * `toCleanupInstances` from different threads
+    /**
+     * @class ISource
+     * @brief The source of the ObjectMapper tree to load the mirror from
+     */
+    class ISource
+    {
+      public:
+        virtual ~ISource() = default;
+        /**
+         * @brief Get the whole ObjectMapper tree
+         *
+         * @throw sdbusplus::exception_t - fail to get the tree
          */
-        while (!instanceAccessGuard.compare_exchange_strong(
-            vocation, currentThreadId, std::memory_order_release))
-        {
-            if (vocation == currentThreadId)
-            {
-                return false;
-            }
-            std::this_thread::sleep_for(10ms);
-            vocation = std::thread::id(0);
-        }
+        virtual SubTree getTree() const = 0;
+        /**
+         * @brief Check whether the current thread dispatches the replies of
+         *        the source. Such thread must never wait for the mirror
+         *        loaded by another thread, which in turn waits for the
+         *        reply dispatched by this one.
+         */
+        virtual bool isDispatcherThread() const noexcept = 0;
+    };
 
-        return true;
-    }
+    ObjectMapperCache(const ObjectMapperCache&) = delete;
+    ObjectMapperCache& operator=(const ObjectMapperCache&) = delete;
+    ObjectMapperCache(ObjectMapperCache&&) = delete;
+    ObjectMapperCache& operator=(ObjectMapperCache&&) = delete;
+
+    explicit ObjectMapperCache() noexcept : loaded(false), loading(false)
+    {}
+    ~ObjectMapperCache() = default;
 
     /**
-     * @brief Unlock access to the DBusInstances internal resources.
+     * @brief Get objects of the subtree which implement at least one of the
+     *        specified interfaces. The root object of the subtree is not
+     *        included.
+     *
+     * @param connect       - DBus connection to load the mirror
+     * @param path          - root path of the subtree
+     * @param depth         - maximal depth of objects, no limit if 0
+     * @param interfaces    - interfaces to search, any if empty
+     *
+     * @throw sdbusplus::exception_t - fail to load the mirror
+     *
+     * @return std::nullopt - the subtree path is unknown to the ObjectMapper
+     */
+    std::optional<SubTree> getSubTree(const DBusConnectUni& connect,
+                                      const ObjectPath& path, int32_t depth,
+                                      const InterfaceList& interfaces);
+    std::optional<SubTree> getSubTree(const ISource& source,
+                                      const ObjectPath& path, int32_t depth,
+                                      const InterfaceList& interfaces);
+    /**
+     * @brief Get services of the object which implement at least one of the
+     *        specified interfaces.
      *
-     * @note Thread safe, non-blocking (like spin-lock), global scope
+     * @throw sdbusplus::exception_t - fail to load the mirror
+     */
+    ObjectServices getObject(const DBusConnectUni& connect,
+                             const ObjectPath& path,
+                             const InterfaceList& interfaces);
+    ObjectServices getObject(const ISource& source, const ObjectPath& path,
+                             const InterfaceList& interfaces);
+    /**
+     * @brief Get ancestor objects of the path which implement at least one
+     *        of the specified interfaces.
      *
+     * @throw sdbusplus::exception_t - fail to load the mirror
+     */
+    SubTree getAncestors(const DBusConnectUni& connect, const ObjectPath& path,
+                         const InterfaceList& interfaces);
+    SubTree getAncestors(const ISource& source, const ObjectPath& path,
+                         const InterfaceList& interfaces);
+
+    void addInterfaces(const ServiceName& service, const ObjectPath& path,
+                       const InterfaceList& interfaces);
+    void removeInterfaces(const ServiceName& service, const ObjectPath& path,
+                          const InterfaceList& interfaces);
+    void removeService(const ServiceName& service);
+    /**
+     * @brief Drop the mirror to reload it on the next lookup
+     */
+    void invalidate();
+
+  private:
+    using InterfaceSet = std::set<InterfaceName>;
+    using ObjectServicesMap = std::map<ServiceName, InterfaceSet>;
+    using ObjectsMap = std::map<ObjectPath, ObjectServicesMap>;
+    using Update = std::function<void(ObjectsMap&)>;
+
+    /**
+     * @class DBusSource
+     * @brief The ObjectMapper service as the source of the tree
      */
-    inline static void instanceAccessGuardUnlock()
+    class DBusSource final : public ISource
     {
-        instanceAccessGuard.store(std::thread::id(0));
-    }
+      public:
+        explicit DBusSource(const DBusConnectUni& connect) : connect(connect)
+        {}
+        ~DBusSource() override = default;
+
+        SubTree getTree() const override;
+        bool isDispatcherThread() const noexcept override;
+
+      private:
+        const DBusConnectUni& connect;
+    };
+
+    /**
+     * @brief Load the mirror if it isn't loaded yet. The dispatcher thread
+     *        of the source never waits for another loader: it loads the
+     *        mirror by itself.
+     *
+     * @return std::shared_lock - the lock to read the loaded mirror
+     */
+    std::shared_lock<std::shared_mutex> acquireLoaded(const ISource& source);
+    /**
+     * @brief Get the tree from the source and build the mirror objects
+     */
+    static ObjectsMap loadObjects(const ISource& source);
+    /**
+     * @brief Apply the update to the mirror. The updates arrived while the
+     *        mirror is loading are replayed over the loaded one.
+     */
+    void applyUpdate(Update&& update);
+
+    static bool hasAnyInterface(const InterfaceSet& implemented,
+                                const InterfaceList& interfaces);
+
+    ObjectsMap objects;
+    std::vector<Update> loadingUpdates;
+    bool loaded;
+    bool loading;
+    std::shared_mutex mutex;
+    std::condition_variable_any loadedCondition;
 };
 
 class DBusQuery : public IQuery, public virtual Event<app::query::QueryEvent>
@@ -577,6 +771,16 @@ class DBusQuery : public IQuery, public virtual Event<app::query::QueryEvent>
 
     static void processObjectRemove(sdbusplus::message::message& message);
 
+    /**
+     * @brief Keep the ObjectMapper mirror coherent with the services owners
+     *
+     * @param serviceName   - the well-known service name
+     * @param hasOwner      - the service is started if true, otherwise it is
+     *                        stopped.
+     */
+    static void processServiceOwnerChanged(const ServiceName& serviceName,
+                                           bool hasOwner);
+
     inline void raiseError() const
     {
         this->emitEvent(app::query::QueryEvent::hasFailures);
@@ -595,13 +799,35 @@ class DBusQuery : public IQuery, public virtual Event<app::query::QueryEvent>
     virtual DBusQueryConstWeakPtr getWeakPtr() const = 0;
     virtual DBusQueryPtr getSharedPtr() = 0;
 
-    virtual DBusInstancePtr createInstance(const ServiceName&,
-                                           const ObjectPath&,
-                                           const InterfaceList&);
+    virtual DBusInstancePtr
+        createInstance(const ServiceName&, const ObjectPath&,
+                       const InterfaceList&,
+                       const DBusInterfacesMap& prefetchedInterfaces = {});
+
+    /**
+     * @brief Get all objects of the service under the specified
+     *        ObjectManager via the single `GetManagedObjects` call.
+     *
+     * @param serviceName - DBus service name
+     * @param managerPath - DBus object path of the ObjectManager
+     *
+     * @throw sdbusplus::exception_t - DBus error
+     *
+     * @return DBusManagedObjects - properties of the objects interfaces
+     */
+    DBusManagedObjects getManagedObjects(const ServiceName& serviceName,
+                                         const ObjectPath& managerPath) const;
 
     void addObserver(sdbusplus::bus::match::match&&);
 
-    virtual const ObjectPath& getObjectPathNamespace() const = 0;
+    /**
+     * @brief Get the window to coalesce the DBus signals which trigger the
+     *        instances creation of the query.
+     */
+    virtual std::chrono::milliseconds getSignalDebounceWindow() const
+    {
+        return std::chrono::milliseconds(DBUS_SIGNAL_DEBOUNCE_MS);
+    }
 
     void
         registerObjectCreationObserver(std::reference_wrapper<entity::IEntity>);
@@ -612,6 +838,8 @@ class DBusQuery : public IQuery, public virtual Event<app::query::QueryEvent>
     static bool processGlobalSignal(sdbusplus::message::message& message,
                                     const TCacheUpdatingDict& handlers);
 
+    static ObjectMapperCache& getObjectMapperCache();
+
     InterfaceList introspectDBusObjectInterfaces(
         const ServiceName& sn, const ObjectPath& op,
         const InterfaceList& searchInterfaces) const;
@@ -619,11 +847,27 @@ class DBusQuery : public IQuery, public virtual Event<app::query::QueryEvent>
   public:
     const DBusConnectUni& getConnect();
     const DBusConnectUni& getConnect() const;
+    /**
+     * @brief Get the root DBus path of objects which the query might obtain
+     */
+    virtual const ObjectPath& getObjectPathNamespace() const = 0;
 
   private:
+    struct PendingObjectCreation
+    {
+        sdbusplus::message::object_path objectPath;
+        DBusInterfacesMap interfaces;
+        std::string sender;
+        std::chrono::steady_clock::time_point signalTime;
+    };
+
     std::vector<sdbusplus::bus::match::match> observers;
     static InstanceCreateHandlers instanceCreateHandlers;
     static InstanceRemoveHandlers instanceRemoveHandlers;
+    static std::unordered_map<std::size_t, PendingObjectCreation>
+        pendingObjectCreations;
+    static std::mutex pendingObjectCreationsMutex;
+    static ObjectMapperCache objectMapperCache;
 };
 
 class IFormatter
@@ -696,9 +940,23 @@ class FindObjectDBusQuery :
   protected:
     static constexpr int32_t noDepth = 0U;
     static constexpr int32_t nextOneDepth = 1U;
+    /**
+     * @brief The minimal count of the service objects to populate them via
+     *        the ObjectManager instead of querying each object.
+     */
+    static constexpr std::size_t minBulkPopulateObjects = 2U;
 
     virtual constexpr const DBusObjectEndpoint& getQueryCriteria() const = 0;
 
+    /**
+     * @brief Find the deepest ObjectManager of each service that covers the
+     *        query namespace.
+     *
+     * @return std::map<ServiceName, ObjectPath> - the ObjectManager path by
+     *                                             the service name
+     */
+    std::map<ServiceName, ObjectPath> findObjectManagers() const;
+
     const ObjectPath& getObjectPathNamespace() const override;
     DBusQueryConstWeakPtr getWeakPtr() const override;
     DBusQueryPtr getSharedPtr() override;
@@ -6,6 +6,13 @@
 #include <core/application.hpp>
 #include <core/entity/dbus_query.hpp>
 #include <core/entity/entity.hpp>
+#include <core/entity/generation_tracker.hpp>
+
+#include <algorithm>
+#include <deque>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
 
 namespace app
 {
@@ -15,6 +22,59 @@ namespace entity
 using namespace exceptions;
 using namespace phosphor::logging;
 
+namespace
+{
+
+/**
+ * @brief The member names by the field slots. The names are kept in the
+ *        deque to never move them, so the instances refer the names without
+ *        locking the registry.
+ */
+struct FieldSlotsRegistry
+{
+    std::shared_mutex mutex;
+    std::unordered_map<std::string_view, FieldSlot> slots;
+    std::deque<MemberName> names;
+};
+
+FieldSlotsRegistry& getFieldSlotsRegistry()
+{
+    static FieldSlotsRegistry registry;
+    return registry;
+}
+
+} // namespace
+
+FieldSlot fieldSlot(std::string_view memberName)
+{
+    auto& registry = getFieldSlotsRegistry();
+    {
+        std::shared_lock lock(registry.mutex);
+        const auto findIt = registry.slots.find(memberName);
+        if (findIt != registry.slots.end())
+        {
+            return findIt->second;
+        }
+    }
+    std::unique_lock lock(registry.mutex);
+    const auto findIt = registry.slots.find(memberName);
+    if (findIt != registry.slots.end())
+    {
+        return findIt->second;
+    }
+    const auto slot = static_cast<FieldSlot>(registry.names.size());
+    const auto& name = registry.names.emplace_back(memberName);
+    registry.slots.emplace(name, slot);
+    return slot;
+}
+
+const MemberName& fieldSlotName(FieldSlot slot)
+{
+    auto& registry = getFieldSlotsRegistry();
+    std::shared_lock lock(registry.mutex);
+    return registry.names.at(static_cast<std::size_t>(slot));
+}
+
 const MemberName BaseEntity::EntityMember::getName() const noexcept
 {
     return name;
@@ -101,30 +161,72 @@ IEntity::IRelation::LinkWay BaseEntity::Relation::getLinkWay() const
     return linkWay;
 }
 
-const IEntity::IEntityMember::InstancePtr& BaseEntity::StaticInstance::getField(
+const std::vector<std::pair<MemberName, MemberName>>
+    BaseEntity::Relation::getLinkMembers() const
+{
+    std::vector<std::pair<MemberName, MemberName>> linkMembers;
+    linkMembers.reserve(conditionBuildRules.size());
+    for (const auto& [memberSource, memberDest, _] : conditionBuildRules)
+    {
+        linkMembers.emplace_back(memberSource, memberDest);
+    }
+    return linkMembers;
+}
+
+const IEntity::IEntityMember::InstancePtr BaseEntity::StaticInstance::getField(
     const IEntity::EntityMemberPtr& entityMember) const
 {
     return getField(entityMember->getName());
 }
 
-const IEntity::IEntityMember::InstancePtr& BaseEntity::StaticInstance::getField(
+const IEntity::IEntityMember::InstancePtr BaseEntity::StaticInstance::getField(
     const MemberName& entityMemberName) const
 {
-    auto findInstanceIt = memberInstances.find(entityMemberName);
-    if (findInstanceIt == memberInstances.end())
+    return getField(fieldSlot(entityMemberName));
+}
+
+const IEntity::IEntityMember::InstancePtr
+    BaseEntity::StaticInstance::getField(FieldSlot slot) const
+{
+    auto value = getFieldValue(slot);
+    if (!value)
     {
         return instanceNotFound();
     }
+    return std::make_shared<EntityMember::StaticInstance>(*value);
+}
 
-    return findInstanceIt->second;
+std::optional<IEntity::IEntityMember::IInstance::FieldType>
+    BaseEntity::StaticInstance::getFieldValue(FieldSlot slot) const
+{
+    std::shared_lock lock(fieldsMutex);
+    const auto findInstanceIt = findField(slot);
+    if (findInstanceIt == memberInstances.end() ||
+        findInstanceIt->slot != slot)
+    {
+        return std::nullopt;
+    }
+    return findInstanceIt->value;
+}
+
+BaseEntity::StaticInstance::FieldEntries::const_iterator
+    BaseEntity::StaticInstance::findField(FieldSlot slot) const
+{
+    return std::lower_bound(
+        memberInstances.begin(), memberInstances.end(), slot,
+        [](const FieldEntry& entry, FieldSlot target) {
+            return entry.slot < target;
+        });
 }
 
 const std::vector<MemberName> BaseEntity::StaticInstance::getMemberNames() const
 {
     std::vector<MemberName> result;
-    for (const auto& [memberName, memberInstance] : memberInstances)
+    std::shared_lock lock(fieldsMutex);
+    result.reserve(memberInstances.size());
+    for (const auto& entry : memberInstances)
     {
-        result.emplace_back(memberName);
+        result.emplace_back(*entry.name);
     }
 
     return std::forward<const std::vector<MemberName>>(result);
@@ -134,25 +236,51 @@ void BaseEntity::StaticInstance::supplement(
     const MemberName& member,
     const IEntity::IEntityMember::IInstance::FieldType& value)
 {
-    auto memberInstance = std::make_shared<EntityMember::StaticInstance>(value);
-    if (!memberInstances.emplace(member, std::move(memberInstance)).second)
+    const auto slot = fieldSlot(member);
     {
-        throw std::logic_error("The requested member '" + member +
-                               "' is already registried.");
+        std::unique_lock lock(fieldsMutex);
+        const auto findInstanceIt = findField(slot);
+        if (findInstanceIt != memberInstances.end() &&
+            findInstanceIt->slot == slot)
+        {
+            throw std::logic_error("The requested member '" + member +
+                                   "' is already registried.");
+        }
+        memberInstances.emplace(findInstanceIt,
+                                FieldEntry{slot, &fieldSlotName(slot), value});
     }
+    notifyFieldChanged(member, value);
 }
 
 void BaseEntity::StaticInstance::supplementOrUpdate(
     const MemberName& memberName,
     const IEntity::IEntityMember::IInstance::FieldType& value)
 {
-    if (hasField(memberName))
+    const auto slot = fieldSlot(memberName);
     {
-        getField(memberName)->setValue(value);
-        return;
+        std::unique_lock lock(fieldsMutex);
+        const auto findInstanceIt = findField(slot);
+        if (findInstanceIt == memberInstances.end() ||
+            findInstanceIt->slot != slot)
+        {
+            memberInstances.emplace(
+                findInstanceIt, FieldEntry{slot, &fieldSlotName(slot), value});
+        }
+        else if (findInstanceIt->value == value)
+        {
+            // Nothing is changed, the observers must not be bothered.
+            return;
+        }
+        else
+        {
+            memberInstances[static_cast<std::size_t>(std::distance(
+                                memberInstances.cbegin(), findInstanceIt))]
+                .value = value;
+        }
     }
-
-    supplement(memberName, value);
+    // The observers are notified without the lock to let them read the
+    // instance fields.
+    notifyFieldChanged(memberName, value);
 }
 
 void BaseEntity::StaticInstance::supplementOrUpdate(
@@ -160,14 +288,21 @@ void BaseEntity::StaticInstance::supplementOrUpdate(
 {
     for (const auto& memberName : destination->getMemberNames())
     {
-        this->supplementOrUpdate(memberName,
-                                 destination->getField(memberName)->getValue());
+        const auto value = destination->getFieldValue(fieldSlot(memberName));
+        if (value)
+        {
+            this->supplementOrUpdate(memberName, *value);
+        }
     }
 }
 
 bool BaseEntity::StaticInstance::hasField(const MemberName& memberName) const
 {
-    return memberInstances.find(memberName) != memberInstances.end();
+    const auto slot = fieldSlot(memberName);
+    std::shared_lock lock(fieldsMutex);
+    const auto findInstanceIt = findField(slot);
+    return findInstanceIt != memberInstances.end() &&
+           findInstanceIt->slot == slot;
 }
 
 bool BaseEntity::StaticInstance::checkCondition(
@@ -187,7 +322,8 @@ bool BaseEntity::StaticInstance::isComplex() const
     return false;
 }
 
-void BaseEntity::StaticInstance::initDefaultFieldsValue()
+void BaseEntity::StaticInstance::initDefaultFieldsValue(
+    const std::set<MemberName>&)
 {
     // nothing to do
 }
@@ -198,6 +334,11 @@ std::size_t BaseEntity::StaticInstance::getHash() const
     return hash;
 }
 
+std::size_t BaseEntity::StaticInstance::getGeneration() const
+{
+    return generation.load(std::memory_order_acquire);
+}
+
 const IEntity::IEntityMember::InstancePtr&
     BaseEntity::StaticInstance::instanceNotFound() const
 {
@@ -207,11 +348,348 @@ const IEntity::IEntityMember::InstancePtr&
     return notAvailable;
 }
 
+void BaseEntity::StaticInstance::addFieldObserver(
+    const FieldObserverWeak& observer)
+{
+    auto current = std::atomic_load(&fieldObservers);
+    std::shared_ptr<const FieldObservers> modified;
+    do
+    {
+        auto observers = std::make_shared<FieldObservers>();
+        if (current)
+        {
+            for (const auto& registered : *current)
+            {
+                if (registered.expired())
+                {
+                    continue;
+                }
+                if (!registered.owner_before(observer) &&
+                    !observer.owner_before(registered))
+                {
+                    // already subscribed
+                    return;
+                }
+                observers->push_back(registered);
+            }
+        }
+        observers->push_back(observer);
+        modified = std::move(observers);
+    } while (
+        !std::atomic_compare_exchange_weak(&fieldObservers, &current, modified));
+}
+
+void BaseEntity::StaticInstance::notifyFieldChanged(
+    const MemberName& memberName,
+    const IEntity::IEntityMember::IInstance::FieldType& value) const
+{
+    generation.fetch_add(1, std::memory_order_release);
+    const auto observers = std::atomic_load(&fieldObservers);
+    if (!observers)
+    {
+        return;
+    }
+    for (const auto& observerWeak : *observers)
+    {
+        if (auto observer = observerWeak.lock())
+        {
+            observer->onFieldChanged(*this, memberName, value);
+        }
+    }
+}
+
+void BaseEntity::StaticInstance::notifyComplexChanged() const
+{
+    generation.fetch_add(1, std::memory_order_release);
+    const auto observers = std::atomic_load(&fieldObservers);
+    if (!observers)
+    {
+        return;
+    }
+    for (const auto& observerWeak : *observers)
+    {
+        if (auto observer = observerWeak.lock())
+        {
+            observer->onComplexChanged(*this);
+        }
+    }
+}
+
+void BaseEntity::InstancesIndex::setIndexableMembers(
+    std::set<MemberName>&& members)
+{
+    std::unique_lock lock(mutex);
+    indexableMembers = std::move(members);
+    indexes.clear();
+}
+
+void BaseEntity::InstancesIndex::attach(const InstancePtr& instance)
+{
+    instance->addFieldObserver(weak_from_this());
+    const bool isComplex = !instance->getComplex().empty();
+    const auto instanceHash = instance->getHash();
+
+    std::unique_lock lock(mutex);
+    hasComplexInstances = hasComplexInstances || isComplex;
+    owners.insert_or_assign(instanceHash, Owner(instance.get(), instance));
+    for (auto& [memberName, memberIndex] : indexes)
+    {
+        updateIndex(memberIndex, instanceHash,
+                    hashValue(instance->getField(memberName)->getValue()));
+    }
+}
+
+void BaseEntity::InstancesIndex::detach(InstanceHash instanceHash)
+{
+    std::unique_lock lock(mutex);
+    owners.erase(instanceHash);
+    for (auto& [_, memberIndex] : indexes)
+    {
+        removeFromIndex(memberIndex, instanceHash);
+    }
+}
+
+void BaseEntity::InstancesIndex::clear()
+{
+    std::unique_lock lock(mutex);
+    owners.clear();
+    indexes.clear();
+    hasComplexInstances = false;
+}
+
+const std::optional<std::vector<IEntity::InstanceHash>>
+    BaseEntity::InstancesIndex::lookup(const ConditionsList& conditions)
+{
+    std::vector<ICondition::EqualityRule> rules;
+    for (const auto& condition : conditions)
+    {
+        if (!condition)
+        {
+            continue;
+        }
+        const auto conditionRules = condition->getEqualityRules();
+        rules.insert(rules.end(), conditionRules.begin(),
+                     conditionRules.end());
+    }
+    if (rules.empty())
+    {
+        return std::nullopt;
+    }
+
+    auto isIndexMissing = [this, &rules]() {
+        return std::any_of(rules.begin(), rules.end(), [this](const auto& rule) {
+            return indexableMembers.contains(rule.first) &&
+                   !indexes.contains(rule.first);
+        });
+    };
+    std::shared_lock lock(mutex);
+    if (hasComplexInstances)
+    {
+        return std::nullopt;
+    }
+    if (isIndexMissing())
+    {
+        lock.unlock();
+        {
+            std::unique_lock buildLock(mutex);
+            for (const auto& [memberName, _] : rules)
+            {
+                if (indexableMembers.contains(memberName) &&
+                    !indexes.contains(memberName))
+                {
+                    buildIndex(memberName);
+                }
+            }
+        }
+        lock.lock();
+    }
+
+    const MemberIndex* bestIndex = nullptr;
+    ValueHash bestValueHash = 0;
+    std::size_t bestCount = 0;
+    for (const auto& [memberName, value] : rules)
+    {
+        const auto indexIt = indexes.find(memberName);
+        if (indexIt == indexes.end())
+        {
+            continue;
+        }
+        const auto valueHash = hashValue(value);
+        const auto count = indexIt->second.byValue.count(valueHash);
+        if (!bestIndex || count < bestCount)
+        {
+            bestIndex = &indexIt->second;
+            bestValueHash = valueHash;
+            bestCount = count;
+        }
+    }
+    if (!bestIndex)
+    {
+        return std::nullopt;
+    }
+
+    std::vector<InstanceHash> candidates;
+    candidates.reserve(bestCount);
+    const auto [begin, end] = bestIndex->byValue.equal_range(bestValueHash);
+    for (auto it = begin; it != end; ++it)
+    {
+        candidates.push_back(it->second);
+    }
+    // Keep the same order as the instances dictionary provides.
+    std::sort(candidates.begin(), candidates.end());
+    return candidates;
+}
+
+void BaseEntity::InstancesIndex::onFieldChanged(
+    const IInstance& instance, const MemberName& memberName,
+    const IEntity::IEntityMember::IInstance::FieldType&)
+{
+    const auto instanceHash = instance.getHash();
+    std::unique_lock lock(mutex);
+    const auto ownerIt = owners.find(instanceHash);
+    if (ownerIt == owners.end() || ownerIt->second.first != &instance)
+    {
+        // The instance was replaced or removed from the entity.
+        return;
+    }
+    fieldsGeneration.fetch_add(1, std::memory_order_release);
+    ++membersGeneration[memberName];
+    auto indexIt = indexes.find(memberName);
+    if (indexIt == indexes.end())
+    {
+        return;
+    }
+    // Take the value that is visible to conditions, the null value is
+    // substituted by the field instance.
+    updateIndex(indexIt->second, instanceHash,
+                hashValue(instance.getField(memberName)->getValue()));
+}
+
+void BaseEntity::InstancesIndex::onComplexChanged(const IInstance& instance)
+{
+    const bool isComplex = !instance.getComplex().empty();
+    std::unique_lock lock(mutex);
+    const auto ownerIt = owners.find(instance.getHash());
+    if (ownerIt == owners.end() || ownerIt->second.first != &instance)
+    {
+        return;
+    }
+    // The complex instances are listed by the entity, so the representations
+    // that have read them are not actual anymore.
+    fieldsGeneration.fetch_add(1, std::memory_order_release);
+    hasComplexInstances = hasComplexInstances || isComplex;
+}
+
+std::size_t BaseEntity::InstancesIndex::getFieldsGeneration() const
+{
+    return fieldsGeneration.load(std::memory_order_acquire);
+}
+
+std::optional<std::size_t> BaseEntity::InstancesIndex::getMemberGeneration(
+    const MemberName& memberName) const
+{
+    std::shared_lock lock(mutex);
+    if (!indexableMembers.contains(memberName))
+    {
+        return std::nullopt;
+    }
+    const auto generationIt = membersGeneration.find(memberName);
+    if (generationIt == membersGeneration.end())
+    {
+        return 0;
+    }
+    return generationIt->second;
+}
+
+BaseEntity::InstancesIndex::ValueHash BaseEntity::InstancesIndex::hashValue(
+    const IEntity::IEntityMember::IInstance::FieldType& value)
+{
+    auto visitCallback = [](auto&& value) -> ValueHash {
+        using TValue = std::decay_t<decltype(value)>;
+        if constexpr (std::is_same_v<std::string, TValue> ||
+                      std::is_arithmetic_v<TValue> ||
+                      std::is_null_pointer_v<TValue>)
+        {
+            return std::hash<TValue>{}(value);
+        }
+        else
+        {
+            // Collections are rarely compared, it is enough to get the
+            // equal hash for the equal values.
+            return value.size();
+        }
+    };
+    return std::visit(std::move(visitCallback), value) ^
+           (value.index() << 1);
+}
+
+void BaseEntity::InstancesIndex::buildIndex(const MemberName& memberName)
+{
+    MemberIndex memberIndex;
+    for (const auto& [instanceHash, owner] : owners)
+    {
+        const auto instance = owner.second.lock();
+        if (!instance)
+        {
+            continue;
+        }
+        updateIndex(memberIndex, instanceHash,
+                    hashValue(instance->getField(memberName)->getValue()));
+    }
+    log<level::DEBUG>("Entity index is built",
+                      entry("MEMBER=%s", memberName.c_str()),
+                      entry("INSTANCES=%ld", memberIndex.byInstance.size()));
+    indexes.insert_or_assign(memberName, std::move(memberIndex));
+}
+
+void BaseEntity::InstancesIndex::updateIndex(MemberIndex& memberIndex,
+                                             InstanceHash instanceHash,
+                                             ValueHash valueHash)
+{
+    auto [instanceIt, inserted] =
+        memberIndex.byInstance.try_emplace(instanceHash, valueHash);
+    if (!inserted)
+    {
+        if (instanceIt->second == valueHash)
+        {
+            return;
+        }
+        removeFromIndex(memberIndex, instanceHash);
+        memberIndex.byInstance.emplace(instanceHash, valueHash);
+    }
+    memberIndex.byValue.emplace(valueHash, instanceHash);
+}
+
+void BaseEntity::InstancesIndex::removeFromIndex(MemberIndex& memberIndex,
+                                                 InstanceHash instanceHash)
+{
+    auto instanceIt = memberIndex.byInstance.find(instanceHash);
+    if (instanceIt == memberIndex.byInstance.end())
+    {
+        return;
+    }
+    auto [begin, end] = memberIndex.byValue.equal_range(instanceIt->second);
+    for (auto it = begin; it != end; ++it)
+    {
+        if (it->second == instanceHash)
+        {
+            memberIndex.byValue.erase(it);
+            break;
+        }
+    }
+    memberIndex.byInstance.erase(instanceIt);
+}
+
 void BaseEntity::Condition::addRule(
     const MemberName& destinationMember,
     const IEntity::IEntityMember::IInstance::FieldType& value,
     CompareCallback compareCallback)
 {
+    if (IRelation::dummyField != destinationMember &&
+        isEqualComparer(compareCallback))
+    {
+        this->equalityRules.emplace_back(destinationMember, value);
+    }
     this->rules.emplace_back(std::make_pair(destinationMember, value),
                              compareCallback);
 }
@@ -233,6 +711,20 @@ bool BaseEntity::Condition::check(
     return fieldValueCompare(sourceInstance);
 }
 
+const std::vector<IEntity::ICondition::EqualityRule>
+    BaseEntity::Condition::getEqualityRules() const
+{
+    return equalityRules;
+}
+
+bool BaseEntity::Condition::isEqualComparer(
+    const CompareCallback& compareCallback)
+{
+    return holdsEqualComparer<std::string, int64_t, uint64_t, double, int32_t,
+                              uint32_t, int16_t, uint16_t, uint8_t, bool>(
+        compareCallback);
+}
+
 bool BaseEntity::Condition::fieldValueCompare(
     const IEntity::IInstance& sourceInstance) const
 {
@@ -252,7 +744,11 @@ bool BaseEntity::Condition::fieldValueCompare(
     return result;
 }
 
-BaseEntity::BaseEntity() noexcept
+BaseEntity::BaseEntity() noexcept :
+    instancesIndex(std::make_shared<InstancesIndex>()),
+    dataObserver(std::make_shared<DataObserver>(*this)),
+    supplementsPruneThreshold(minSupplementsPruneThreshold),
+    supplementedInstance(nullptr)
 {
     this->createMember(app::query::dbus::metaObjectPath);
     this->createMember(app::query::dbus::metaObjectService);
@@ -281,6 +777,9 @@ bool BaseEntity::addMember(const EntityMemberPtr& memberPtr)
 
 bool BaseEntity::createMember(const MemberName& member)
 {
+    // The slot of the member field is assigned beforehand to not contend
+    // for the slots registry on reading the instances.
+    fieldSlot(member);
     return addMember(std::make_shared<Entity::EntityMember>(member));
 }
 
@@ -311,9 +810,10 @@ const IEntity::EntityMemberPtr
 
 const IEntity::InstancePtr BaseEntity::getInstance(std::size_t hash) const
 {
-    std::lock_guard<std::mutex> lock(mutex);
-    auto findInstanceIt = this->instances.find(hash);
-    if (findInstanceIt == instances.end())
+    GenerationTracker::touch(*this);
+    const auto snapshot = instances.get();
+    auto findInstanceIt = snapshot->find(hash);
+    if (findInstanceIt == snapshot->end())
     {
         return IEntity::InstancePtr();
     }
@@ -324,33 +824,25 @@ const IEntity::InstancePtr BaseEntity::getInstance(std::size_t hash) const
 const std::vector<IEntity::InstancePtr>
     BaseEntity::getInstances(const ConditionsList& conditions) const
 {
-    // FIXME need optimization to prevent high load on CPU per request
     std::vector<IEntity::InstancePtr> result;
-    // Copy the list of instances to avoid corruption on iteration, the cache can
-    // be invalidated in another thread at the same time.
-    // The `instances` dictionary contains smart-pointers to IInstance objects,
-    // the copying will be simple and there is no expensive overhead at memory.
-    mutex.lock();
-    const auto instTmp = instances;
-    mutex.unlock();
-    for (const auto [_, instanceObject] : instTmp)
-    {
-        instanceObject->initDefaultFieldsValue();
+    GenerationTracker::touch(*this);
+    // The snapshot is an immutable version of the instances dictionary. The
+    // cache can be modified in another thread at the same time, but it will
+    // publish a new version and the acquired one stays consistent.
+    const auto snapshot = instances.get();
+    auto processInstance = [this, &conditions,
+                            &result](const InstancePtr& instanceObject) {
+        // The providers contribution is materialized on the providers
+        // change, the default values must not override it.
+        instanceObject->initDefaultFieldsValue(
+            *getProvidedMembers(instanceObject));
 
         auto complexInstances = instanceObject->getComplex();
         complexInstances.insert_or_assign(instanceObject->getHash(),
                                           instanceObject);
-        for (const auto [_, instance] : complexInstances)
+        for (const auto& [_, instance] : complexInstances)
         {
             instance->verifyState();
-            const auto& providers = getProviders();
-            for (auto provider : providers)
-            {
-                log<level::DEBUG>(
-                    "Supplement instance by provider",
-                    entry("PROVIDER=%s", provider.first->getName().c_str()));
-                provider.first->supplementInstance(instance, provider.second);
-            }
             bool conditionPassed = true;
             for (auto condition : conditions)
             {
@@ -366,42 +858,354 @@ const std::vector<IEntity::InstancePtr>
                 result.push_back(instance);
             }
         }
+    };
+
+    // The equality conditions might be resolved via the secondary indexes to
+    // avoid checking each instance of the entity.
+    const auto candidates = instancesIndex->lookup(conditions);
+    if (candidates)
+    {
+        result.reserve(candidates->size());
+        for (const auto instanceHash : *candidates)
+        {
+            const auto findInstanceIt = snapshot->find(instanceHash);
+            if (findInstanceIt != snapshot->end())
+            {
+                processInstance(findInstanceIt->second);
+            }
+        }
+        return std::forward<const std::vector<IEntity::InstancePtr>>(result);
+    }
+
+    result.reserve(snapshot->size());
+    for (const auto& [_, instanceObject] : *snapshot)
+    {
+        processInstance(instanceObject);
     }
     return std::forward<const std::vector<IEntity::InstancePtr>>(result);
 }
 
+void BaseEntity::supplementByProviders(const InstancePtr& instance) const
+{
+    if (getProviders().empty())
+    {
+        return;
+    }
+    std::lock_guard lock(supplementByProvidersMutex);
+    supplementInstanceByProviders(instance);
+    for (const auto& [_, complexInstance] : instance->getComplex())
+    {
+        supplementInstanceByProviders(complexInstance);
+    }
+}
+
+void BaseEntity::supplementByProviders() const
+{
+    if (getProviders().empty())
+    {
+        return;
+    }
+    const auto snapshot = instances.get();
+    for (const auto& [_, instance] : *snapshot)
+    {
+        supplementByProviders(instance);
+    }
+}
+
+void BaseEntity::supplementInstanceByProviders(
+    const InstancePtr& instance) const
+{
+    // The link rules are applied to the draft, so the contribution doesn't
+    // depend on the previous one or the values computed on read.
+    const auto previousMembers = getProvidedMembers(instance);
+    auto draft =
+        std::make_shared<StaticInstance>(std::to_string(instance->getHash()));
+    std::map<MemberName, IEntity::IEntityMember::IInstance::FieldType>
+        instanceFields;
+    for (const auto& memberName : instance->getMemberNames())
+    {
+        const auto value = instance->getFieldValue(fieldSlot(memberName));
+        if (value && !previousMembers->contains(memberName) &&
+            !computedMembers.contains(memberName))
+        {
+            draft->supplementOrUpdate(memberName, *value);
+            instanceFields.emplace(memberName, *value);
+        }
+    }
+    for (const auto& [provider, linkRule] : getProviders())
+    {
+        log<level::DEBUG>("Supplement instance by provider",
+                          entry("PROVIDER=%s", provider->getName().c_str()));
+        provider->supplementInstance(draft, linkRule);
+    }
+
+    auto members = std::make_shared<std::set<MemberName>>();
+    std::vector<
+        std::pair<MemberName, IEntity::IEntityMember::IInstance::FieldType>>
+        contribution;
+    for (const auto& memberName : draft->getMemberNames())
+    {
+        // The fields of entity queries are owned by the DBus data and must
+        // never be overridden by providers.
+        if (ownMembers.contains(memberName) &&
+            !computedMembers.contains(memberName))
+        {
+            continue;
+        }
+        const auto value = draft->getFieldValue(fieldSlot(memberName));
+        const auto instanceFieldIt = instanceFields.find(memberName);
+        if (value && (instanceFieldIt == instanceFields.end() ||
+                      instanceFieldIt->second != *value))
+        {
+            members->insert(memberName);
+            contribution.emplace_back(memberName, *value);
+        }
+    }
+
+    // The members are registered before the fields are applied, so the
+    // concurrent reading doesn't override them by the default values.
+    {
+        std::lock_guard lock(supplementsMutex);
+        if (!supplements.contains(instance.get()) &&
+            supplements.size() >= supplementsPruneThreshold)
+        {
+            std::erase_if(supplements, [](const auto& supplement) {
+                return supplement.second.owner.expired();
+            });
+            supplementsPruneThreshold =
+                std::max(minSupplementsPruneThreshold, supplements.size() * 2);
+        }
+        supplements.insert_or_assign(instance.get(),
+                                     ProvidersSupplement{instance, members});
+    }
+    const auto outerInstance = supplementedInstance;
+    supplementedInstance = instance.get();
+    for (const auto& [memberName, value] : contribution)
+    {
+        instance->supplementOrUpdate(memberName, value);
+    }
+    for (const auto& memberName : *previousMembers)
+    {
+        // The member isn't supplied anymore, the default value takes its
+        // place on read.
+        if (!members->contains(memberName))
+        {
+            instance->supplementOrUpdate(memberName, nullptr);
+        }
+    }
+    supplementedInstance = outerInstance;
+}
+
+const BaseEntity::ProvidedMembers
+    BaseEntity::getProvidedMembers(const InstancePtr& instance) const
+{
+    static const ProvidedMembers noMembers =
+        std::make_shared<const std::set<MemberName>>();
+    if (getProviders().empty())
+    {
+        return noMembers;
+    }
+    std::lock_guard lock(supplementsMutex);
+    const auto findIt = supplements.find(instance.get());
+    if (findIt == supplements.end() || findIt->second.owner.lock() != instance)
+    {
+        return noMembers;
+    }
+    return findIt->second.members;
+}
+
+const IEntity::InstancePtr
+    BaseEntity::findInstance(const IInstance& instance) const
+{
+    const auto snapshot = instances.get();
+    const auto findIt = snapshot->find(instance.getHash());
+    if (findIt == snapshot->end() || findIt->second.get() != &instance)
+    {
+        return IEntity::InstancePtr();
+    }
+    return findIt->second;
+}
+
+void BaseEntity::addChangeObserver(const ChangeObserverWeak& observer)
+{
+    std::lock_guard lock(changeObserversMutex);
+    std::erase_if(changeObservers,
+                  [](const auto& weak) { return weak.expired(); });
+    const auto isSubscribed =
+        std::any_of(changeObservers.begin(), changeObservers.end(),
+                    [observer = observer.lock()](const auto& weak) {
+                        return weak.lock() == observer;
+                    });
+    if (!isSubscribed)
+    {
+        changeObservers.push_back(observer);
+    }
+}
+
+void BaseEntity::notifyChanged() const
+{
+    std::vector<ChangeObserverWeak> observers;
+    {
+        std::lock_guard lock(changeObserversMutex);
+        if (changeObservers.empty())
+        {
+            return;
+        }
+        observers = changeObservers;
+    }
+    // The observers are notified without the lock to let them subscribe.
+    for (const auto& observerWeak : observers)
+    {
+        if (auto observer = observerWeak.lock())
+        {
+            observer->onEntityChanged();
+        }
+    }
+}
+
+void BaseEntity::DataObserver::onFieldChanged(
+    const IInstance& instance, const MemberName& memberName,
+    const IEntity::IEntityMember::IInstance::FieldType&)
+{
+    const auto instancePtr = entity.findInstance(instance);
+    if (!instancePtr)
+    {
+        // The instance was replaced or removed from the entity.
+        return;
+    }
+    entity.notifyChanged();
+    if (entity.getProviders().empty() ||
+        entity.computedMembers.contains(memberName))
+    {
+        return;
+    }
+    // The link rules of providers might depend on any field of the instance
+    // except the supplemented ones.
+    std::lock_guard lock(entity.supplementByProvidersMutex);
+    if (entity.supplementedInstance != &instance &&
+        !entity.getProvidedMembers(instancePtr)->contains(memberName))
+    {
+        entity.supplementByProviders(instancePtr);
+    }
+}
+
+void BaseEntity::DataObserver::onComplexChanged(const IInstance& instance)
+{
+    const auto instancePtr = entity.findInstance(instance);
+    if (!instancePtr)
+    {
+        return;
+    }
+    entity.notifyChanged();
+    entity.supplementByProviders(instancePtr);
+}
+
+void BaseEntity::DataObserver::onEntityChanged()
+{
+    entity.supplementByProviders();
+}
+
 void BaseEntity::setInstances(std::vector<InstancePtr> instancesList)
 {
-    std::lock_guard<std::mutex> lock(mutex);
+    if (instancesList.empty())
+    {
+        return;
+    }
+    // The instances are supplemented before publishing to be read complete.
     for (const auto& inputInstance : instancesList)
     {
-        this->instances.insert_or_assign(inputInstance->getHash(),
-                                         inputInstance);
+        supplementByProviders(inputInstance);
     }
+    instances.update([this, &instancesList](InstancesHashmap& data) {
+        for (const auto& inputInstance : instancesList)
+        {
+            data.insert_or_assign(inputInstance->getHash(), inputInstance);
+            instancesIndex->attach(inputInstance);
+            inputInstance->addFieldObserver(dataObserver);
+        }
+        return true;
+    });
+    notifyChanged();
 }
 
 IEntity::InstancePtr BaseEntity::mergeInstance(InstancePtr instance)
 {
-    std::lock_guard<std::mutex> lock(mutex);
-    InstancesHashmap::iterator foundIt = instances.find(instance->getHash());
-    if (foundIt == instances.end())
+    if (!instances.get()->contains(instance->getHash()))
+    {
+        // The new instance is supplemented before publishing to be read
+        // complete. It's just dropped if the same one is added meanwhile.
+        supplementByProviders(instance);
+    }
+    IEntity::InstancePtr result = instance;
+    auto isNewInstance = [&instance, &result](const InstancesHashmap& data) {
+        const auto foundIt = data.find(instance->getHash());
+        if (foundIt == data.end())
+        {
+            return true;
+        }
+        // The instance object is shared between versions, so it is updated
+        // in-place and there is no need to copy and publish a new version.
+        foundIt->second->supplementOrUpdate(instance);
+        foundIt->second->mergeInternalMetadata(instance);
+        result = foundIt->second;
+        return false;
+    };
+    instances.update(isNewInstance,
+                     [this, &instance](InstancesHashmap& data) {
+                         data.insert_or_assign(instance->getHash(), instance);
+                         instancesIndex->attach(instance);
+                         instance->addFieldObserver(dataObserver);
+                         return true;
+                     });
+    if (result == instance)
     {
-        this->instances.insert_or_assign(instance->getHash(), instance);
-        return instance;
+        notifyChanged();
     }
-    foundIt->second->supplementOrUpdate(instance);
-    foundIt->second->mergeInternalMetadata(instance);
-    return foundIt->second;
+    return result;
 }
 
 void BaseEntity::removeInstance(InstanceHash hash)
 {
-    auto instance = this->instances.extract(hash);
+    instances.update(
+        [hash](const InstancesHashmap& data) { return data.contains(hash); },
+        [this, hash](InstancesHashmap& data) {
+            instancesIndex->detach(hash);
+            return data.erase(hash) > 0;
+        });
+    notifyChanged();
     log<level::DEBUG>("Entity instance successfully removed",
                       entry("INSTANCE_HASH=%ld", hash),
                       entry("ENTITY=%s", getName().c_str()));
 }
 
+std::size_t BaseEntity::getInstancesVersion() const
+{
+    return instances.getVersion();
+}
+
+std::size_t BaseEntity::getGeneration() const
+{
+    return instances.getVersion() + instancesIndex->getFieldsGeneration();
+}
+
+std::size_t BaseEntity::getMemberGeneration(const MemberName& memberName) const
+{
+    const auto memberGeneration =
+        instancesIndex->getMemberGeneration(memberName);
+    if (memberGeneration)
+    {
+        return instances.getVersion() + *memberGeneration;
+    }
+    // The member is supplemented by providers or computed while instances
+    // are read, so any data of the entity or its providers might change it.
+    std::size_t generation = getGeneration();
+    for (const auto& [provider, _] : getProviders())
+    {
+        generation += provider->getGeneration();
+    }
+    return generation;
+}
+
 const std::vector<IEntity::RelationPtr>& BaseEntity::getRelations() const
 {
     static const Relations noRelations;
@@ -416,6 +1220,7 @@ void BaseEntity::initialize()
     initMembers();
     initRelations();
     initProviders();
+    initIndexes();
 }
 
 void BaseEntity::initMembers()
@@ -438,7 +1243,46 @@ void BaseEntity::initProviders()
     for (auto providerRule : getProviders())
     {
         providerRule.first->initialize();
+        providerRule.first->addChangeObserver(dataObserver);
+    }
+}
+
+void BaseEntity::initIndexes()
+{
+    // Only fields that are populated by the entity own queries might be
+    // indexed. The fields of providers are supplemented on demand and can't
+    // be tracked.
+    std::set<MemberName> indexableMembers{app::query::dbus::metaObjectPath,
+                                          app::query::dbus::metaObjectService};
+    for (const auto& memberName : getMembersNames())
+    {
+        indexableMembers.insert(memberName);
+    }
+    for (const auto& [provider, _] : getProviders())
+    {
+        for (const auto& [memberName, _2] : provider->getMembers())
+        {
+            indexableMembers.erase(memberName);
+        }
+    }
+    ownMembers = indexableMembers;
+    // The default fields are computed while the instances are read, hence
+    // the indexes built before that can't select the candidates by them.
+    for (const auto& query : getQueries())
+    {
+        const auto dbusQuery =
+            std::dynamic_pointer_cast<app::query::dbus::DBusQuery>(query);
+        if (!dbusQuery)
+        {
+            continue;
+        }
+        for (const auto& [memberName, _] : dbusQuery->getDefaultFieldsValue())
+        {
+            indexableMembers.erase(memberName);
+            computedMembers.insert(memberName);
+        }
     }
+    instancesIndex->setIndexableMembers(std::move(indexableMembers));
 }
 
 void BaseEntity::processQueries()
@@ -467,14 +1311,17 @@ void BaseEntity::processQueries()
 
 void BaseEntity::resetCache()
 {
+    instances.reset();
+    instancesIndex->clear();
     {
-        std::lock_guard<std::mutex> lock(mutex);
-        this->instances.clear();
+        std::lock_guard lock(supplementsMutex);
+        supplements.clear();
     }
     for (auto provider : getProviders())
     {
         provider.first->resetCache();
     }
+    notifyChanged();
 }
 
 const BaseEntity::MembersList BaseEntity::getMembersNames() const
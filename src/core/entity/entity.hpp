@@ -15,7 +15,10 @@
 #include <memory>
 #include <mutex>
 #include <optional>
+#include <set>
+#include <shared_mutex>
 #include <string>
+#include <unordered_map>
 #include <variant>
 #include <vector>
 
@@ -44,6 +47,119 @@ class EntityException : public core::exceptions::ObmcAppException
 
 } // namespace exceptions
 
+/**
+ * @class InstancesSnapshot
+ * @brief Copy-on-write holder of an immutable data version.
+ *        Readers acquire a refcounted view of the current version without
+ *        taking any lock, so the view stays valid even if a writer publishes
+ *        a new version at the same time. Writers are serialized, modify a
+ *        private copy of the data and publish it atomically.
+ *
+ * @tparam TData - the type of the stored data
+ */
+template <typename TData>
+class InstancesSnapshot final
+{
+  public:
+    using DataPtr = std::shared_ptr<const TData>;
+
+    InstancesSnapshot(const InstancesSnapshot&) = delete;
+    InstancesSnapshot& operator=(const InstancesSnapshot&) = delete;
+    InstancesSnapshot(InstancesSnapshot&&) = delete;
+    InstancesSnapshot& operator=(InstancesSnapshot&&) = delete;
+
+    explicit InstancesSnapshot() :
+        data(std::make_shared<const TData>()), version(0)
+    {}
+    ~InstancesSnapshot() = default;
+
+    /**
+     * @brief Get the current version of the data.
+     *
+     * @return DataPtr - immutable view that is never changed by writers
+     */
+    const DataPtr get() const noexcept
+    {
+        return std::atomic_load_explicit(&data, std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Get the number of published data versions.
+     *
+     * @return std::size_t - the version number
+     */
+    std::size_t getVersion() const noexcept
+    {
+        return version.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Modify a private copy of the current data version and publish it
+     *        if the modifier reports any changes.
+     *
+     * @param modifier - callable `bool(TData&)`, returns true to publish
+     *                   the modified copy
+     */
+    template <typename TModifier>
+    void update(TModifier&& modifier)
+    {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        auto modified = std::make_shared<TData>(*get());
+        if (std::invoke(std::forward<TModifier>(modifier), *modified))
+        {
+            publish(std::move(modified));
+        }
+    }
+
+    /**
+     * @brief Inspect the current data version and copy it to modify only if
+     *        the inspector requests that. The changes that don't require a
+     *        new version are applied by the inspector without copying the
+     *        data.
+     *
+     * @param inspector - callable `bool(const TData&)`, returns true if the
+     *                    data has to be modified
+     * @param modifier  - callable `bool(TData&)`, returns true to publish
+     *                    the modified copy
+     */
+    template <typename TInspector, typename TModifier>
+    void update(TInspector&& inspector, TModifier&& modifier)
+    {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        const auto current = get();
+        if (!std::invoke(std::forward<TInspector>(inspector), *current))
+        {
+            return;
+        }
+        auto modified = std::make_shared<TData>(*current);
+        if (std::invoke(std::forward<TModifier>(modifier), *modified))
+        {
+            publish(std::move(modified));
+        }
+    }
+
+    /**
+     * @brief Publish an empty data version
+     */
+    void reset()
+    {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        publish(std::make_shared<TData>());
+    }
+
+  private:
+    inline void publish(std::shared_ptr<TData>&& modified) noexcept
+    {
+        std::atomic_store_explicit(&data, DataPtr(std::move(modified)),
+                                   std::memory_order_release);
+        version.fetch_add(1, std::memory_order_acq_rel);
+    }
+
+    DataPtr data;
+    std::atomic<std::size_t> version;
+    std::mutex writeMutex;
+};
+
 class BaseEntity : virtual public IEntity
 {
 #define ENTITY_DECL_QUERY(...)                                                 \
@@ -91,15 +207,16 @@ class BaseEntity : virtual public IEntity
     }
 #define ENTITY_DECL_FIELD_DEF(type, name, defval)                              \
     static constexpr const char* field##name = #name;                          \
+    static inline const app::entity::FieldSlot slot##name =                    \
+        app::entity::fieldSlot(#name);                                         \
     static type getField##name(const InstancePtr instance)                     \
     {                                                                          \
-        const auto fieldPtr = instance->getField(field##name);                 \
-        if (fieldPtr->isNull())                                                \
+        const auto value = instance->getFieldValue(slot##name);                \
+        if (!value || std::holds_alternative<std::nullptr_t>(*value))          \
         {                                                                      \
             return defval;                                                     \
         }                                                                      \
-        const auto& value = fieldPtr->getValue();                              \
-        return std::get<type>(value);                                          \
+        return std::get<type>(*value);                                         \
     }                                                                          \
     static void setField##name(const InstancePtr instance, const type& value)  \
     {                                                                          \
@@ -113,19 +230,20 @@ class BaseEntity : virtual public IEntity
 
 #define ENTITY_DECL_FIELD_ENUM(type, name, defval)                             \
     static constexpr const char* field##name = #name;                          \
+    static inline const app::entity::FieldSlot slot##name =                    \
+        app::entity::fieldSlot(#name);                                         \
     static type getField##name(const InstancePtr instance)                     \
     {                                                                          \
-        const auto fieldPtr = instance->getField(field##name);                 \
-        if (fieldPtr->isNull())                                                \
+        const auto value = instance->getFieldValue(slot##name);                \
+        if (!value || std::holds_alternative<std::nullptr_t>(*value))          \
         {                                                                      \
             return type::defval;                                               \
         }                                                                      \
-        const auto& value = fieldPtr->getValue();                              \
         if constexpr (!std::is_enum_v<type>)                                   \
         {                                                                      \
             throw std::logic_error("The defined entity field is not enum");    \
         }                                                                      \
-        return static_cast<type>(std::get<int>(value));                        \
+        return static_cast<type>(std::get<int>(*value));                       \
     }                                                                          \
     static void setField##name(const InstancePtr instance, const type& value)  \
     {                                                                          \
@@ -139,7 +257,7 @@ class BaseEntity : virtual public IEntity
 
     using InstancesHashmap = std::map<InstanceHash, InstancePtr>;
     MemberMap members;
-    InstancesHashmap instances;
+    InstancesSnapshot<InstancesHashmap> instances;
 
   protected:
     using ProviderRule = std::pair<EntitySupplementProviderPtr,
@@ -308,6 +426,15 @@ class BaseEntity : virtual public IEntity
 
         void addRule(const MemberName&, CustomCompareCallback) override;
         bool check(const IEntity::IInstance&) const override;
+        const std::vector<EqualityRule> getEqualityRules() const override;
+
+        /**
+         * @brief Check whether the comparer is a plain equality comparer
+         *        (ICondition::Equal) of one of the primitive field types.
+         *
+         * @return true if the rule with such comparer is an equality rule.
+         */
+        static bool isEqualComparer(const CompareCallback&);
 
         template <typename TRightValue>
         static const ConditionPtr buildEqual(const std::string& fieldName,
@@ -332,8 +459,16 @@ class BaseEntity : virtual public IEntity
         {
             if constexpr (std::is_enum_v<TRightValue>)
             {
-                return std::make_shared<Condition>(
+                auto condition = std::make_shared<Condition>(
                     fieldName, static_cast<int>(value), TComparer());
+                if constexpr (std::is_same_v<TComparer, Equal<TRightValue>>)
+                {
+                    // The comparer of enum can't be recognized by the
+                    // `addRule` since enum types are unknown there.
+                    condition->equalityRules.emplace_back(
+                        fieldName, static_cast<int>(value));
+                }
+                return condition;
             }
             else
             {
@@ -341,6 +476,15 @@ class BaseEntity : virtual public IEntity
                                                    TComparer());
             }
         }
+
+      private:
+        template <typename... TValues>
+        static bool holdsEqualComparer(const CompareCallback& comparer)
+        {
+            return ((comparer.target<Equal<TValues>>() != nullptr) || ...);
+        }
+
+        std::vector<EqualityRule> equalityRules;
     };
 
     class Relation : public IRelation
@@ -371,6 +515,8 @@ class BaseEntity : virtual public IEntity
         const std::vector<ConditionPtr>
             getConditions(const InstancePtr) const override;
         LinkWay getLinkWay() const override;
+        const std::vector<std::pair<MemberName, MemberName>>
+            getLinkMembers() const override;
 
       public:
         static const RelationPtr build(const EntityPtr source,
@@ -402,17 +548,24 @@ class BaseEntity : virtual public IEntity
 
         explicit StaticInstance(const std::string& identityFieldValue) noexcept
             :
-            identity(identityFieldValue)
+            identity(identityFieldValue),
+            generation(0)
         {}
 
         virtual ~StaticInstance() = default;
 
-        const IEntity::IEntityMember::InstancePtr&
+        const IEntity::IEntityMember::InstancePtr
             getField(const IEntity::EntityMemberPtr&) const override;
 
-        const IEntity::IEntityMember::InstancePtr&
+        const IEntity::IEntityMember::InstancePtr
             getField(const MemberName&) const override;
 
+        const IEntity::IEntityMember::InstancePtr
+            getField(FieldSlot) const override;
+
+        std::optional<IEntity::IEntityMember::IInstance::FieldType>
+            getFieldValue(FieldSlot) const override;
+
         const std::vector<MemberName> getMemberNames() const override;
 
         void supplement(
@@ -433,18 +586,162 @@ class BaseEntity : virtual public IEntity
 
         const std::map<std::size_t, InstancePtr> getComplex() const override;
         bool isComplex() const override;
-        void initDefaultFieldsValue() override;
+        void initDefaultFieldsValue(const std::set<MemberName>&) override;
         /**
          * @brief Get the Hash of Entity Instance
          *
          * @return std::size_t hash value
          */
         std::size_t getHash() const override;
+        std::size_t getGeneration() const override;
+
+        void addFieldObserver(const FieldObserverWeak&) override;
 
       protected:
         virtual const IEntity::IEntityMember::InstancePtr&
             instanceNotFound() const;
-        MemberInstancesMap memberInstances;
+        void notifyFieldChanged(
+            const MemberName&,
+            const IEntity::IEntityMember::IInstance::FieldType&) const;
+        void notifyComplexChanged() const;
+
+      private:
+        struct FieldEntry
+        {
+            FieldSlot slot;
+            /** @brief The member name owned by the field slots registry */
+            const MemberName* name;
+            IEntity::IEntityMember::IInstance::FieldType value;
+        };
+        using FieldEntries = std::vector<FieldEntry>;
+
+        FieldEntries::const_iterator findField(FieldSlot) const;
+
+        /**
+         * @brief The field values of instance ordered by the slot. The values
+         *        are stored inline and never referenced from the outside,
+         *        the readers obtain the copies under the lock, so the storage
+         *        might be reallocated by supplementing a new field.
+         */
+        FieldEntries memberInstances;
+        mutable std::shared_mutex fieldsMutex;
+
+        using FieldObservers = std::vector<FieldObserverWeak>;
+        /**
+         * @brief The observers of fields modification. The list is replaced
+         *        atomically on subscribing, so notifying doesn't require
+         *        any lock.
+         */
+        std::shared_ptr<const FieldObservers> fieldObservers;
+        /** @brief Bumped on each notification of the observers. */
+        mutable std::atomic<std::size_t> generation;
+    };
+
+    /**
+     * @class InstancesIndex
+     * @brief The secondary indexes of the entity instances by the field
+     *        values. The index of a member is built on the first lookup by
+     *        an equality condition and then kept up to date via observing
+     *        the instances fields modification.
+     * @note  The index only narrows the set of instances to check, each found
+     *        instance is still verified by the original conditions. The
+     *        members which are supplemented by providers or computed on
+     *        demand are never indexed.
+     */
+    class InstancesIndex final :
+        public IInstance::IFieldObserver,
+        public std::enable_shared_from_this<InstancesIndex>
+    {
+        using ValueHash = std::size_t;
+        using Owner = std::pair<const IInstance*, std::weak_ptr<IInstance>>;
+        struct MemberIndex
+        {
+            std::unordered_multimap<ValueHash, InstanceHash> byValue;
+            std::unordered_map<InstanceHash, ValueHash> byInstance;
+        };
+
+        std::set<MemberName> indexableMembers;
+        std::unordered_map<InstanceHash, Owner> owners;
+        std::unordered_map<MemberName, MemberIndex> indexes;
+        /**
+         * @brief The complex (child) instances aren't indexed, the entity
+         *        which has such instances always uses the full scan.
+         */
+        bool hasComplexInstances;
+        /**
+         * @brief The counter of the attached instances fields modifications.
+         */
+        std::atomic<std::size_t> fieldsGeneration;
+        /**
+         * @brief The counters of the modifications per member.
+         */
+        std::unordered_map<MemberName, std::size_t> membersGeneration;
+        mutable std::shared_mutex mutex;
+
+      public:
+        InstancesIndex(const InstancesIndex&) = delete;
+        InstancesIndex& operator=(const InstancesIndex&) = delete;
+        InstancesIndex(InstancesIndex&&) = delete;
+        InstancesIndex& operator=(InstancesIndex&&) = delete;
+
+        explicit InstancesIndex() noexcept :
+            hasComplexInstances(false), fieldsGeneration(0)
+        {}
+        ~InstancesIndex() override = default;
+
+        /**
+         * @brief Set the members which values are allowed to be indexed.
+         */
+        void setIndexableMembers(std::set<MemberName>&&);
+        /**
+         * @brief Start observing the instance and add its fields to the
+         *        indexes built so far.
+         */
+        void attach(const InstancePtr&);
+        /**
+         * @brief Remove the instance from indexes.
+         */
+        void detach(InstanceHash);
+        /**
+         * @brief Remove all instances and indexes.
+         */
+        void clear();
+        /**
+         * @brief Find the instances which might satisfy the conditions.
+         *
+         * @return std::nullopt if conditions can't be resolved via indexes,
+         *         otherwise the sorted list of candidate instances hashes.
+         */
+        const std::optional<std::vector<InstanceHash>>
+            lookup(const ConditionsList&);
+
+        void onFieldChanged(
+            const IInstance&, const MemberName&,
+            const IEntity::IEntityMember::IInstance::FieldType&) override;
+        void onComplexChanged(const IInstance&) override;
+
+        /**
+         * @brief Get the count of fields modifications of the attached
+         *        instances.
+         */
+        std::size_t getFieldsGeneration() const;
+        /**
+         * @brief Get the count of modifications of the member of the
+         *        attached instances.
+         *
+         * @return std::nullopt if the member isn't owned by the entity
+         *         queries and its modifications can't be tracked.
+         */
+        std::optional<std::size_t>
+            getMemberGeneration(const MemberName&) const;
+
+        static ValueHash
+            hashValue(const IEntity::IEntityMember::IInstance::FieldType&);
+
+      private:
+        void buildIndex(const MemberName&);
+        static void updateIndex(MemberIndex&, InstanceHash, ValueHash);
+        static void removeFromIndex(MemberIndex&, InstanceHash);
     };
 
     BaseEntity(const BaseEntity&) = delete;
@@ -452,10 +749,33 @@ class BaseEntity : virtual public IEntity
     BaseEntity(BaseEntity&&) = delete;
     BaseEntity& operator=(BaseEntity&&) = delete;
 
+    /**
+     * @class IChangeObserver
+     * @brief The observer of the entity data modification.
+     */
+    class IChangeObserver
+    {
+      public:
+        virtual ~IChangeObserver() = default;
+        /**
+         * @brief The instances of the entity are added or removed or any
+         *        field of the instances is modified.
+         */
+        virtual void onEntityChanged() = 0;
+    };
+    using ChangeObserverWeak = std::weak_ptr<IChangeObserver>;
+
     explicit BaseEntity() noexcept;
 
     ~BaseEntity() override = default;
 
+    /**
+     * @brief Subscribe the observer to the entity data modification.
+     *
+     * @param ChangeObserverWeak - The observer
+     */
+    void addChangeObserver(const ChangeObserverWeak&);
+
     bool addMember(const EntityMemberPtr&) override;
     bool createMember(const MemberName& member) override;
 
@@ -478,6 +798,9 @@ class BaseEntity : virtual public IEntity
     void setInstances(std::vector<InstancePtr>) override;
     InstancePtr mergeInstance(InstancePtr) override;
     void removeInstance(InstanceHash) override;
+    std::size_t getInstancesVersion() const override;
+    std::size_t getGeneration() const override;
+    std::size_t getMemberGeneration(const MemberName&) const override;
     const Relations& getRelations() const override;
     const RelationPtr getRelation(const EntityName&) const override;
     static const EntityManager& getEntityManager();
@@ -503,13 +826,100 @@ class BaseEntity : virtual public IEntity
     inline void initMembers();
     inline void initRelations();
     inline void initProviders();
+    inline void initIndexes();
 
   protected:
     static void defaultLinkProvider(const IEntity::InstancePtr& supplement,
                                     const IEntity::InstancePtr& target);
 
   private:
-    mutable std::mutex mutex;
+    /**
+     * @class DataObserver
+     * @brief Observes the entity instances and providers to keep the
+     *        contributions of providers up to date and to notify the
+     *        entities which use the current one as a provider.
+     */
+    class DataObserver final :
+        public IInstance::IFieldObserver,
+        public IChangeObserver
+    {
+        const BaseEntity& entity;
+
+      public:
+        DataObserver(const DataObserver&) = delete;
+        DataObserver& operator=(const DataObserver&) = delete;
+        DataObserver(DataObserver&&) = delete;
+        DataObserver& operator=(DataObserver&&) = delete;
+
+        explicit DataObserver(const BaseEntity& entity) noexcept :
+            entity(entity)
+        {}
+        ~DataObserver() override = default;
+
+        void onFieldChanged(
+            const IInstance&, const MemberName&,
+            const IEntity::IEntityMember::IInstance::FieldType&) override;
+        void onComplexChanged(const IInstance&) override;
+        void onEntityChanged() override;
+    };
+
+    using ProvidedMembers = std::shared_ptr<const std::set<MemberName>>;
+    /**
+     * @brief The members of the instance which are supplemented by
+     *        providers.
+     */
+    struct ProvidersSupplement
+    {
+        std::weak_ptr<IInstance> owner;
+        ProvidedMembers members;
+    };
+    static constexpr std::size_t minSupplementsPruneThreshold = 64;
+
+    /**
+     * @brief Supplement the instance and its complex instances by the
+     *        entity providers. The link rules are invoked over a draft
+     *        that contains the instance fields except the supplemented and
+     *        computed on read ones, and the collected contribution is
+     *        applied to the instance at once. The members which aren't
+     *        supplied anymore are reset.
+     */
+    void supplementByProviders(const InstancePtr&) const;
+    /**
+     * @brief Supplement all instances of the entity by providers.
+     */
+    void supplementByProviders() const;
+    void supplementInstanceByProviders(const InstancePtr&) const;
+    const ProvidedMembers getProvidedMembers(const InstancePtr&) const;
+    const InstancePtr findInstance(const IInstance&) const;
+    void notifyChanged() const;
+
+    std::shared_ptr<InstancesIndex> instancesIndex;
+    std::shared_ptr<DataObserver> dataObserver;
+    /**
+     * @brief The members which are populated by the entity own queries.
+     */
+    std::set<MemberName> ownMembers;
+    /**
+     * @brief The members which values are set by the default getters
+     *        while the instances are read.
+     */
+    std::set<MemberName> computedMembers;
+    mutable std::unordered_map<const IInstance*, ProvidersSupplement>
+        supplements;
+    mutable std::size_t supplementsPruneThreshold;
+    mutable std::mutex supplementsMutex;
+    /**
+     * @brief Serializes the supplementation by providers. The link rules
+     *        read providers which might notify about their changes, hence
+     *        the lock is reentrant.
+     */
+    mutable std::recursive_mutex supplementByProvidersMutex;
+    /**
+     * @brief The instance which fields are being applied by providers.
+     */
+    mutable const IInstance* supplementedInstance;
+    std::vector<ChangeObserverWeak> changeObservers;
+    mutable std::mutex changeObserversMutex;
 };
 
 template <typename TEntity>
@@ -6,10 +6,14 @@
 #include <core/exceptions.hpp>
 #include <phosphor-logging/log.hpp>
 
+#include <cstdint>
 #include <functional>
 #include <map>
 #include <memory>
+#include <optional>
+#include <set>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 
@@ -49,6 +53,36 @@ using EntityWeak = std::weak_ptr<IEntity>;
 using EntityName = std::string;
 using MemberName = std::string;
 
+/**
+ * @brief The identifier of an entity member field. The slots are the dense
+ *        indexes assigned to the member names on the first use, so the same
+ *        name always gives the same slot and distinct names never share one.
+ */
+enum class FieldSlot : uint32_t
+{
+};
+
+/**
+ * @brief Get the FieldSlot of the member name. The slot is assigned on the
+ *        first request of the name, the entity members obtain their slots on
+ *        creation and the well-known fields on the program start.
+ *
+ * @param memberName - the name of entity member
+ *
+ * @return FieldSlot - the field slot identifier
+ */
+FieldSlot fieldSlot(std::string_view memberName);
+
+/**
+ * @brief Get the member name of the field slot. The name is never moved or
+ *        removed, so the reference stays valid.
+ *
+ * @param slot - the field slot identifier
+ *
+ * @return const MemberName& - the member name
+ */
+const MemberName& fieldSlotName(FieldSlot slot);
+
 template <class T, typename... Args>
 class ISingleton
 {
@@ -136,8 +170,34 @@ class IEntity
     class IInstance
     {
       public:
-        using MemberInstancesMap =
-            std::map<entity::MemberName, IEntity::IEntityMember::InstancePtr>;
+        /**
+         * @class IFieldObserver
+         * @brief The observer of IInstance fields modification. It is used to
+         *        keep the secondary indexes of IEntity up to date.
+         */
+        class IFieldObserver
+        {
+          public:
+            virtual ~IFieldObserver() = default;
+            /**
+             * @brief Called when the field of the instance obtains new value.
+             *
+             * @param IInstance     - The modified instance
+             * @param MemberName    - The name of modified field
+             * @param FieldType     - The new value of the field
+             */
+            virtual void onFieldChanged(
+                const IInstance&, const MemberName&,
+                const IEntityMember::IInstance::FieldType&) = 0;
+            /**
+             * @brief Called when the set of complex (child) instances is
+             *        changed.
+             *
+             * @param IInstance     - The modified instance
+             */
+            virtual void onComplexChanged(const IInstance&) = 0;
+        };
+        using FieldObserverWeak = std::weak_ptr<IFieldObserver>;
 
         virtual ~IInstance() = default;
         /**
@@ -145,15 +205,36 @@ class IEntity
          *
          * @param entityMemberName - name of an Entity Member to seach the Field
          *
-         * @return const Entity::IEntityMember::InstancePtr& The Field Instance
-         * of specified Entity Member
+         * @return const Entity::IEntityMember::InstancePtr The copy of Field
+         * Instance of specified Entity Member
          *
          */
-        virtual const IEntity::IEntityMember::InstancePtr&
+        virtual const IEntity::IEntityMember::InstancePtr
             getField(const IEntity::EntityMemberPtr&) const = 0;
 
-        virtual const IEntity::IEntityMember::InstancePtr&
+        virtual const IEntity::IEntityMember::InstancePtr
             getField(const MemberName&) const = 0;
+        /**
+         * @brief Get the Field of Entity Instance by the slot identifier.
+         *
+         * @param FieldSlot - the slot of an Entity Member
+         *
+         * @return const Entity::IEntityMember::InstancePtr The copy of Field
+         *                                                  Instance
+         */
+        virtual const IEntity::IEntityMember::InstancePtr
+            getField(FieldSlot) const = 0;
+        /**
+         * @brief Get the copy of the field value by the slot identifier.
+         *        That is the fastest way to get field of well-known member.
+         *
+         * @param FieldSlot - the slot of an Entity Member
+         *
+         * @return std::optional<FieldType> - the field value or std::nullopt
+         *                                     if the instance has no field
+         */
+        virtual std::optional<IEntityMember::IInstance::FieldType>
+            getFieldValue(FieldSlot) const = 0;
 
         virtual const std::vector<MemberName> getMemberNames() const = 0;
 
@@ -179,19 +260,45 @@ class IEntity
         virtual const std::map<std::size_t, InstancePtr> getComplex() const = 0;
         virtual bool isComplex() const = 0;
 
-        virtual void initDefaultFieldsValue() = 0;
+        /**
+         * @brief Set the fields which values are computed on read.
+         *
+         * @param providedMembers - the members supplemented by providers,
+         *                          which take precedence over the default
+         *                          values
+         */
+        virtual void initDefaultFieldsValue(
+            const std::set<MemberName>& providedMembers) = 0;
         /**
          * @brief Get the Hash of Entity Instance
          *
          * @return std::size_t hash value
          */
         virtual std::size_t getHash() const = 0;
+        /**
+         * @brief Get the generation of the instance data. The generation is
+         *        increased each time when any field of the instance or the
+         *        set of its complex instances is changed.
+         *
+         * @return std::size_t - the generation of the instance data
+         */
+        virtual std::size_t getGeneration() const = 0;
 
         virtual void verifyState()
         {}
 
         virtual void setUninitialized()
         {}
+
+        /**
+         * @brief Subscribe the observer to the fields modification.
+         *
+         * @param FieldObserverWeak - The observer
+         */
+        virtual void addFieldObserver(const FieldObserverWeak&)
+        {
+            // default: skip
+        }
     };
 
     /**
@@ -282,6 +389,20 @@ class IEntity
         virtual void addRule(const MemberName&, CustomCompareCallback) = 0;
         virtual bool check(const IEntity::IInstance&) const = 0;
 
+        using EqualityRule =
+            std::pair<MemberName, IEntityMember::IInstance::FieldType>;
+        /**
+         * @brief Get the rules which is satisfied only by field value equal
+         *        to the specified one. The rules might be resolved via
+         *        secondary indexes instead of checking each IInstance.
+         *
+         * @return const std::vector<EqualityRule> - the equality rules
+         */
+        virtual const std::vector<EqualityRule> getEqualityRules() const
+        {
+            return {};
+        }
+
         virtual ~ICondition() = default;
     };
 
@@ -308,6 +429,16 @@ class IEntity
         virtual const std::vector<ConditionPtr>
             getConditions(const InstancePtr) const = 0;
         virtual LinkWay getLinkWay() const = 0;
+        /**
+         * @brief Get the pairs of the source and destination members which
+         *        values define the related instances. The source member
+         *        is the `dummyField` if the destination member is compared
+         *        with a literal.
+         *
+         * @return the source and destination members of the linking rules
+         */
+        virtual const std::vector<std::pair<MemberName, MemberName>>
+            getLinkMembers() const = 0;
 
         static const RelationRulesList& directLinkingRule()
         {
@@ -356,6 +487,31 @@ class IEntity
     virtual void setInstances(std::vector<InstancePtr>) = 0;
     virtual InstancePtr mergeInstance(InstancePtr) = 0;
     virtual void removeInstance(InstanceHash) = 0;
+    /**
+     * @brief Get the version of the instances collection. The version is
+     *        changed each time when instances are added or removed.
+     *
+     * @return std::size_t - the version of the instances collection
+     */
+    virtual std::size_t getInstancesVersion() const = 0;
+    /**
+     * @brief Get the generation of the entity data. The generation is
+     *        changed each time when instances are added or removed or any
+     *        field of an instance is modified.
+     *
+     * @return std::size_t - the generation of the entity data
+     */
+    virtual std::size_t getGeneration() const = 0;
+    /**
+     * @brief Get the generation of the member values. The generation is
+     *        changed each time when the member value of any instance might
+     *        be changed. The members which are supplemented by providers or
+     *        computed while instances are read follow the generation of the
+     *        data they are derived from.
+     *
+     * @return std::size_t - the generation of the member values
+     */
+    virtual std::size_t getMemberGeneration(const MemberName&) const = 0;
 
     virtual const Relations& getRelations() const = 0;
     virtual const RelationPtr getRelation(const EntityName&) const = 0;
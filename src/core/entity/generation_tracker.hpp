@@ -0,0 +1,84 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2022 YADRO
+
+#pragma once
+
+#include <core/entity/entity_interface.hpp>
+
+#include <map>
+#include <string>
+
+namespace app
+{
+namespace entity
+{
+
+/**
+ * @class GenerationTracker
+ * @brief Records the generations of the entities read by the current thread
+ *        while the tracker is alive. The generation is taken on the first
+ *        access, so the recorded one is never newer than the data that have
+ *        been read. The trackers might be nested, each active one records
+ *        the access.
+ */
+class GenerationTracker final
+{
+  public:
+    using Generations = std::map<EntityName, std::size_t>;
+
+    GenerationTracker(const GenerationTracker&) = delete;
+    GenerationTracker& operator=(const GenerationTracker&) = delete;
+    GenerationTracker(GenerationTracker&&) = delete;
+    GenerationTracker& operator=(GenerationTracker&&) = delete;
+
+    explicit GenerationTracker() : previous(current())
+    {
+        current() = this;
+    }
+
+    ~GenerationTracker()
+    {
+        current() = previous;
+    }
+
+    /**
+     * @brief Record the access to the entity by the current thread
+     *
+     * @param entity - the accessed entity
+     */
+    static void touch(const IEntity& entity)
+    {
+        for (auto tracker = current(); tracker; tracker = tracker->previous)
+        {
+            const auto entityName = entity.getName();
+            if (tracker->generations.count(entityName) == 0)
+            {
+                tracker->generations.emplace(entityName,
+                                             entity.getGeneration());
+            }
+        }
+    }
+
+    /**
+     * @brief Get the generations of the accessed entities
+     *
+     * @return const Generations& - the generations by entity name
+     */
+    const Generations& getGenerations() const
+    {
+        return generations;
+    }
+
+  private:
+    static GenerationTracker*& current()
+    {
+        thread_local GenerationTracker* tracker = nullptr;
+        return tracker;
+    }
+
+    GenerationTracker* previous;
+    Generations generations;
+};
+
+} // namespace entity
+} // namespace app
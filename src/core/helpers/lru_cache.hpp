@@ -0,0 +1,117 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2022 YADRO
+
+#pragma once
+
+#include <functional>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+namespace app
+{
+namespace helpers
+{
+
+/**
+ * @class LruCache
+ * @brief The thread-safe cache of the limited capacity which evicts the least
+ *        recently used entry to insert a new one.
+ *
+ * @tparam TKey   - the type of keys
+ * @tparam TValue - the type of values, copied out on the lookup
+ * @tparam THash  - the hash function of keys
+ */
+template <typename TKey, typename TValue, typename THash = std::hash<TKey>>
+class LruCache final
+{
+    using Entry = std::pair<TKey, TValue>;
+    using EntryList = std::list<Entry>;
+
+  public:
+    LruCache(const LruCache&) = delete;
+    LruCache& operator=(const LruCache&) = delete;
+    LruCache(LruCache&&) = delete;
+    LruCache& operator=(LruCache&&) = delete;
+
+    explicit LruCache(std::size_t capacity) : capacity(capacity)
+    {}
+    ~LruCache() = default;
+
+    /**
+     * @brief Find the value and mark it as the most recently used
+     */
+    std::optional<TValue> find(const TKey& key)
+    {
+        std::lock_guard lock(mutex);
+        auto findIt = index.find(key);
+        if (findIt == index.end())
+        {
+            return std::nullopt;
+        }
+        entries.splice(entries.begin(), entries, findIt->second);
+        return findIt->second->second;
+    }
+
+    /**
+     * @brief Insert or replace the value
+     */
+    void insert(const TKey& key, TValue value)
+    {
+        std::lock_guard lock(mutex);
+        if (capacity == 0)
+        {
+            return;
+        }
+        auto findIt = index.find(key);
+        if (findIt != index.end())
+        {
+            findIt->second->second = std::move(value);
+            entries.splice(entries.begin(), entries, findIt->second);
+            return;
+        }
+        if (entries.size() >= capacity)
+        {
+            index.erase(entries.back().first);
+            entries.pop_back();
+        }
+        entries.emplace_front(key, std::move(value));
+        index.emplace(key, entries.begin());
+    }
+
+    /**
+     * @brief Remove the value if present
+     */
+    void erase(const TKey& key)
+    {
+        std::lock_guard lock(mutex);
+        auto findIt = index.find(key);
+        if (findIt == index.end())
+        {
+            return;
+        }
+        entries.erase(findIt->second);
+        index.erase(findIt);
+    }
+
+    /**
+     * @brief Remove all values
+     */
+    void clear()
+    {
+        std::lock_guard lock(mutex);
+        index.clear();
+        entries.clear();
+    }
+
+  private:
+    std::size_t capacity;
+    EntryList entries;
+    std::unordered_map<TKey, typename EntryList::iterator, THash> index;
+    std::mutex mutex;
+};
+
+} // namespace helpers
+} // namespace app
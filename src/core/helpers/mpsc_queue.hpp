@@ -0,0 +1,94 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2022 YADRO
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+namespace app
+{
+namespace helpers
+{
+
+/**
+ * @class MpscQueue
+ * @brief The lock-free multi-producer single-consumer queue.
+ *        Producers push items to the intrusive stack via CAS, the consumer
+ *        takes the whole stack at once and reverses it to keep the order
+ *        of pushing.
+ *
+ * @tparam TItem - the type of queued items
+ */
+template <typename TItem>
+class MpscQueue final
+{
+    struct Node
+    {
+        TItem item;
+        Node* next;
+    };
+    std::atomic<Node*> head;
+
+  public:
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+    MpscQueue(MpscQueue&&) = delete;
+    MpscQueue& operator=(MpscQueue&&) = delete;
+
+    explicit MpscQueue() noexcept : head(nullptr)
+    {}
+    ~MpscQueue()
+    {
+        for (auto node = head.exchange(nullptr); node;)
+        {
+            auto next = node->next;
+            delete node;
+            node = next;
+        }
+    }
+
+    /**
+     * @brief Push the item to the queue
+     *
+     * @return true  - the queue was empty and the consumer should be
+     *                 notified
+     * @return false - the queue already has pending items
+     */
+    bool push(TItem&& item)
+    {
+        auto node = new Node{std::move(item), nullptr};
+        // The node might be popped and released by the consumer right after
+        // publishing, so the previous head is checked via the local copy.
+        auto expected = head.load(std::memory_order_relaxed);
+        do
+        {
+            node->next = expected;
+        } while (!head.compare_exchange_weak(expected, node,
+                                             std::memory_order_release,
+                                             std::memory_order_relaxed));
+        return expected == nullptr;
+    }
+
+    /**
+     * @brief Take all pending items in the order of pushing
+     */
+    std::vector<TItem> popAll()
+    {
+        std::vector<TItem> items;
+        auto node = head.exchange(nullptr, std::memory_order_acquire);
+        for (; node;)
+        {
+            auto next = node->next;
+            items.emplace_back(std::move(node->item));
+            delete node;
+            node = next;
+        }
+        std::reverse(items.begin(), items.end());
+        return items;
+    }
+};
+
+} // namespace helpers
+} // namespace app
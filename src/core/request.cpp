@@ -68,6 +68,18 @@ bool Request::isBrowserRequest() const
     return false;
 }
 
+const std::string Request::getAcceptEncoding() const
+{
+    static constexpr const char* acceptEncoding = "HTTP_ACCEPT_ENCODING";
+    const auto& others = environment().others;
+    const auto headerIt = others.find(acceptEncoding);
+    if (headerIt == others.end())
+    {
+        return "";
+    }
+    return headerIt->second;
+}
+
 const std::string Request::getUriPath() const
 {
     constexpr const char* delimiter = "/";
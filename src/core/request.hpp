@@ -38,6 +38,12 @@ class IRequest
     virtual const service::session::UserSessionPtr& getSession() const = 0;
     virtual bool isSessionEmpty() const = 0;
     virtual bool isBrowserRequest() const = 0;
+    /**
+     * @brief Get the content codings acceptable by the client
+     *
+     * @return const std::string - the 'Accept-Encoding' header value
+     */
+    virtual const std::string getAcceptEncoding() const = 0;
 };
 
 /**
@@ -74,6 +80,7 @@ class Request : public IRequest
     const service::session::UserSessionPtr& getSession() const override;
     bool isSessionEmpty() const override;
     bool isBrowserRequest() const override;
+    const std::string getAcceptEncoding() const override;
 };
 
 using RequestUni = std::unique_ptr<IRequest>;
@@ -6,6 +6,8 @@
 #include <core/response.hpp>
 #include <http/headers.hpp>
 
+#include <iomanip>
+
 namespace app
 {
 namespace core
@@ -26,6 +28,11 @@ void Response::setContentType(const std::string& contentType)
     this->contentType = contentType;
 }
 
+const std::string& Response::getContentType() const
+{
+    return contentType;
+}
+
 void Response::setStatus(const statuses::Code& status)
 {
     this->status = status;
@@ -55,9 +62,50 @@ void Response::push(const std::string& buffer)
     internalBuffer += buffer;
 }
 
+void Response::setBodyWriter(BodyWriter&& writer)
+{
+    bodyWriter = std::move(writer);
+}
+
+Response::BodyWriter Response::releaseBody()
+{
+    BodyWriter writer = [buffer = std::move(internalBuffer),
+                         tail = std::move(bodyWriter)](std::ostream& os) {
+        os << buffer;
+        if (tail)
+        {
+            tail(os);
+        }
+    };
+    clear();
+    return writer;
+}
+
+void Response::pushJson(nlohmann::json&& json, int indent)
+{
+    setBodyWriter([json = std::move(json), indent](std::ostream& os) {
+        os << std::setw(indent) << json;
+    });
+}
+
 void Response::clear()
 {
     internalBuffer.clear();
+    bodyWriter = nullptr;
+}
+
+bool Response::isStreamed() const
+{
+    return static_cast<bool>(bodyWriter);
+}
+
+void Response::writeBody(std::ostream& os) const
+{
+    os << internalBuffer;
+    if (bodyWriter)
+    {
+        bodyWriter(os);
+    }
 }
 
 } // namespace core
@@ -7,6 +7,7 @@
 #include <http/headers.hpp>
 #include <nlohmann/json.hpp>
 
+#include <functional>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -60,6 +61,12 @@ class IResponse
      * @param contentType - the type of content contains at the response
      */
     virtual void setContentType(const std::string&) = 0;
+    /**
+     * @brief Get the Content Type of response
+     *
+     * @return const std::string& - the type of content
+     */
+    virtual const std::string& getContentType() const = 0;
     /**
      * @brief Set the HTTP Header
      *
@@ -91,6 +98,19 @@ class IResponse
      * @brief clear the internal output buffer
      */
     virtual void clear() = 0;
+    /**
+     * @brief Check whether the body is produced straight into the output
+     *        stream, so the body size is unknown until it is written.
+     *
+     * @return true - the body is streamed
+     */
+    virtual bool isStreamed() const = 0;
+    /**
+     * @brief Write the body to the output stream
+     *
+     * @param os out stream
+     */
+    virtual void writeBody(std::ostream& os) const = 0;
 
     /**
      * @brief Pipe of HTTP-payload stream
@@ -102,7 +122,7 @@ class IResponse
     friend std::ostream& operator<<(std::ostream& os, const IResponse& response)
     {
         os << response.getHead();
-        os << response.getBody();
+        response.writeBody(os);
         return os;
     }
 };
@@ -112,6 +132,12 @@ class Response : public IResponse
     static constexpr const char* endHeaderLine = "\r\n";
 
   public:
+    /**
+     * @brief The producer of the body which writes the payload to the output
+     *        stream when the response is sent.
+     */
+    using BodyWriter = std::function<void(std::ostream&)>;
+
     explicit Response() :
         status(statuses::Code::NotFound),
         contentType(content_types::textPlain){};
@@ -129,18 +155,45 @@ class Response : public IResponse
 
     const statuses::Code& getStatus() override;
     void setContentType(const std::string&) override;
+    const std::string& getContentType() const override;
     void setStatus(const statuses::Code&) override;
 
     void setHeader(const std::string&, const std::string&) override;
     const std::string getHead() const override;
 
     void push(const std::string&) override;
+    /**
+     * @brief Set the producer of the body tail to stream it to the output
+     *        just after the buffered body, instead of buffering it.
+     *
+     * @param writer - the body producer
+     */
+    void setBodyWriter(BodyWriter&& writer);
+    /**
+     * @brief Take the whole body away from the response, e.g. to encode it
+     *        while it is streamed to the output.
+     *
+     * @return BodyWriter - the producer of the body taken
+     */
+    BodyWriter releaseBody();
+    /**
+     * @brief Stream the JSON payload to the output without the intermediate
+     *        serialization buffer.
+     *
+     * @param json   - the payload
+     * @param indent - the indentation of the pretty output
+     */
+    void pushJson(nlohmann::json&& json, int indent = 2);
 
     void clear() override;
 
+    bool isStreamed() const override;
+    void writeBody(std::ostream& os) const override;
+
   private:
     std::string headerBuffer;
     std::string internalBuffer;
+    BodyWriter bodyWriter;
     statuses::Code status;
     std::string contentType;
 };
@@ -8,8 +8,17 @@
 #include <http/headers.hpp>
 #include <nlohmann/json.hpp>
 
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <cmath>
 #include <functional>
+#include <iterator>
+#include <string_view>
+#include <tuple>
 #include <type_traits>
+#include <utility>
 
 namespace app
 {
@@ -27,52 +36,100 @@ using namespace facebook::graphql::ast;
 
 using namespace phosphor::logging;
 
-GqlObjectBuild::GqlObjectBuild(const std::string& objectName,
-                               const entity::IEntity::RelationPtr inputRelation,
-                               GqlBuildPtr parentBuilder) :
-    name(objectName),
-    relation(inputRelation), parent(parentBuilder), fragment(json::object({}))
+namespace
 {
-    const auto targetEntity = getEntity();
-    if (!relation)
-    {
-        log<level::DEBUG>("Attempt to create builder without Entity object");
-        return;
-    }
 
-    for (auto instance : targetEntity->getInstances())
-    {
-        // init each one json object for each specified entity instance
-        fragment[std::to_string(instance->getHash())] = json::object({});
-    }
+using FieldType = entity::IEntity::IEntityMember::IInstance::FieldType;
+
+/**
+ * @brief Compare the field values. The numbers are compared by value
+ *        regardless of their types, other values are equal only if they have
+ *        the same type.
+ */
+bool isEqualValue(const FieldType& left, const FieldType& right)
+{
+    auto compare = [](const auto& lhs, const auto& rhs) -> bool {
+        using TLeft = std::decay_t<decltype(lhs)>;
+        using TRight = std::decay_t<decltype(rhs)>;
+        constexpr bool isLeftNumber =
+            std::is_arithmetic_v<TLeft> && !std::is_same_v<TLeft, bool>;
+        constexpr bool isRightNumber =
+            std::is_arithmetic_v<TRight> && !std::is_same_v<TRight, bool>;
+        if constexpr (isLeftNumber && isRightNumber)
+        {
+            if constexpr (std::is_integral_v<TLeft> &&
+                          std::is_integral_v<TRight>)
+            {
+                return std::cmp_equal(lhs, rhs);
+            }
+            else
+            {
+                return static_cast<double>(lhs) == static_cast<double>(rhs);
+            }
+        }
+        else if constexpr (std::is_same_v<TLeft, TRight>)
+        {
+            return lhs == rhs;
+        }
+        return false;
+    };
+    return std::visit(std::move(compare), left, right);
 }
 
-GqlObjectBuild::GqlObjectBuild(const std::string& objectName,
-                               const entity::EntityPtr inputEntity,
-                               GqlBuildPtr parentBuilder) :
-    name(objectName),
-    entityObject(inputEntity), parent(parentBuilder), fragment(json::object({}))
+/**
+ * @brief Get the field value of the GraphQL literal
+ *
+ * @param argumentName - the name of the argument to report the error
+ * @param value        - the GraphQL value
+ *
+ * @return FieldType - the value to compare with the fields
+ */
+FieldType getFieldValue(const std::string& argumentName, const Value& value)
 {
-    if (!entityObject)
+    try
     {
-        log<level::DEBUG>("Attempt to create builder without Entity object");
-        return;
+        if (const auto stringValue = dynamic_cast<const StringValue*>(&value))
+        {
+            return std::string(stringValue->getValue());
+        }
+        if (const auto enumValue = dynamic_cast<const EnumValue*>(&value))
+        {
+            return std::string(enumValue->getValue());
+        }
+        if (const auto intValue = dynamic_cast<const IntValue*>(&value))
+        {
+            return static_cast<int64_t>(std::stoll(intValue->getValue()));
+        }
+        if (const auto floatValue = dynamic_cast<const FloatValue*>(&value))
+        {
+            return std::stod(floatValue->getValue());
+        }
+        if (const auto boolValue = dynamic_cast<const BooleanValue*>(&value))
+        {
+            return boolValue->getValue();
+        }
+        if (dynamic_cast<const NullValue*>(&value))
+        {
+            return nullptr;
+        }
     }
-
-    for (auto instance : entityObject->getInstances())
+    catch (std::logic_error& ex)
     {
-        // init each one json object for each specified entity instance
-        fragment[std::to_string(instance->getHash())] = json::object({});
+        throw exceptions::GqlInvalidArgument(argumentName, ex.what());
     }
+    throw exceptions::GqlInvalidArgument(argumentName,
+                                         "The value type is not supported");
 }
 
+} // namespace
+
 bool ObmcGqlVisitor::visitOperationDefinition(
     const OperationDefinition& operationDefinition)
 {
-    result.push_back({operationDefinition.getOperation(), json::object({})});
+    plan.push_back({operationDefinition.getOperation(), {}});
 
     decltype(auto) visitor = VisitorFactory::build(
-        operationDefinition.getOperation(), result.back());
+        operationDefinition.getOperation(), plan.back());
 
     if (!visitor)
     {
@@ -80,16 +137,17 @@ bool ObmcGqlVisitor::visitOperationDefinition(
     }
 
     operationDefinition.accept(visitor.get());
-    return true;
+    // The operation is entirely compiled by the dedicated visitor
+    return false;
 }
 
 void ObmcGqlVisitor::endVisitOperationDefinition(
     const OperationDefinition& operationDefinition)
 {}
 
-const nlohmann::json& ObmcGqlVisitor::getResult() const
+const GqlPlan& ObmcGqlVisitor::getPlan() const
 {
-    return result;
+    return plan;
 }
 
 // QUERY VISITOR
@@ -101,89 +159,179 @@ bool GqlQueryVisitor::visitVariableDefinition(const VariableDefinition&)
 
 bool GqlQueryVisitor::visitArgument(const Argument& argument)
 {
-    return true;
-}
+    const std::string argumentName = argument.getName().getValue();
+    if (objects.empty() || isScalarField)
+    {
+        throw exceptions::GqlInvalidArgument(
+            argumentName, "Only the object fields accept arguments");
+    }
+    auto& step = objects.back();
+    step.conditions.emplace_back(
+        buildCondition(step.entity, argumentName, argument.getValue()));
 
-void GqlQueryVisitor::endVisitArgument(const Argument& argument)
-{}
+    // The argument value is entirely compiled
+    return false;
+}
 
-bool GqlQueryVisitor::visitStringValue(const StringValue& stringValue)
+entity::IEntity::ConditionPtr
+    GqlQueryVisitor::buildCondition(const entity::EntityPtr& entity,
+                                    const std::string& argumentName,
+                                    const Value& argumentValue)
 {
-    return true;
-}
+    using namespace app::entity;
+    using Condition = BaseEntity::Condition;
 
-void GqlQueryVisitor::endVisitStringValue(const StringValue& stringValue)
-{}
+    static constexpr std::string_view suffixNot = "_not";
+    static constexpr std::string_view suffixIn = "_in";
+    static constexpr std::string_view suffixStartsWith = "_starts_with";
 
-bool GqlQueryVisitor::visitField(const Field& field)
-{
-    const std::string fieldName = field.getName().getValue();
-    auto fieldAlias =
-        field.getAlias()
-            ? std::optional<std::string>(field.getAlias()->getValue())
-            : std::nullopt;
+    auto getMemberName = [&entity, &argumentName](std::string_view suffix) {
+        if (suffix.empty() || !argumentName.ends_with(suffix))
+        {
+            return std::optional<MemberName>();
+        }
+        MemberName memberName =
+            argumentName.substr(0, argumentName.size() - suffix.size());
+        return entity->hasMember(memberName) ? std::optional(memberName)
+                                             : std::nullopt;
+    };
 
-    if (field.getSelectionSet())
+    if (entity->hasMember(argumentName))
     {
-        if (!fragmentBuilder)
+        const auto value = getFieldValue(argumentName, argumentValue);
+        if (std::holds_alternative<std::string>(value))
         {
-            throw exceptions::GqlInternalError("The builder was not found");
+            // The plain equality condition might be resolved via the indexes
+            return Condition::buildEqual(argumentName,
+                                        std::get<std::string>(value));
         }
-
-        try
+        return std::make_shared<Condition>(
+            argumentName,
+            [value](const IEntity::IEntityMember::InstancePtr& field) {
+                return field && isEqualValue(field->getValue(), value);
+            });
+    }
+    if (auto memberName = getMemberName(suffixNot))
+    {
+        const auto value = getFieldValue(argumentName, argumentValue);
+        return std::make_shared<Condition>(
+            *memberName,
+            [value](const IEntity::IEntityMember::InstancePtr& field) {
+                return field && !isEqualValue(field->getValue(), value);
+            });
+    }
+    if (auto memberName = getMemberName(suffixIn))
+    {
+        const auto listValue = dynamic_cast<const ListValue*>(&argumentValue);
+        if (!listValue)
         {
-            GqlBuildPtr childObjectBuilder;
-            entity::EntityPtr entity = this->fragmentBuilder->getEntity();
-            if (!entity)
-            {
-                entity = application.getEntityManager().getEntity(fieldName);
-                childObjectBuilder = std::make_shared<GqlObjectBuild>(
-                    fieldName, entity, fragmentBuilder);
-            }
-            else
-            {
-                auto relation = entity->getRelation(fieldName);
-                if (!relation)
+            throw exceptions::GqlInvalidArgument(argumentName,
+                                                 "The list value expected");
+        }
+        std::vector<FieldType> values;
+        for (const auto& itemValue : listValue->getValues())
+        {
+            values.emplace_back(getFieldValue(argumentName, *itemValue));
+        }
+        return std::make_shared<Condition>(
+            *memberName,
+            [values](const IEntity::IEntityMember::InstancePtr& field) {
+                return field &&
+                       std::any_of(values.begin(), values.end(),
+                                   [&field](const auto& value) {
+                                       return isEqualValue(field->getValue(),
+                                                           value);
+                                   });
+            });
+    }
+    if (auto memberName = getMemberName(suffixStartsWith))
+    {
+        const auto value = getFieldValue(argumentName, argumentValue);
+        if (!std::holds_alternative<std::string>(value))
+        {
+            throw exceptions::GqlInvalidArgument(argumentName,
+                                                 "The string value expected");
+        }
+        return std::make_shared<Condition>(
+            *memberName,
+            [prefix = std::get<std::string>(value)](
+                const IEntity::IEntityMember::InstancePtr& field) {
+                if (!field)
                 {
-                    throw exceptions::GqlInvalidArgument(
-                        fieldName,
-                        "Relation to the " + fieldName + " was not found");
+                    return false;
                 }
-                childObjectBuilder = std::make_shared<GqlObjectBuild>(
-                    fieldName, relation, fragmentBuilder);
-
-                auto entityOfChild = childObjectBuilder->getEntity();
-            }
+                const auto& fieldValue = field->getValue();
+                return std::holds_alternative<std::string>(fieldValue) &&
+                       std::get<std::string>(fieldValue).starts_with(prefix);
+            });
+    }
+    throw exceptions::GqlInvalidArgument(
+        argumentName, "The argument doesn't match any entity member");
+}
 
-            if (fieldAlias.has_value())
-            {
-                childObjectBuilder->setAlias(*fieldAlias);
-            }
+bool GqlQueryVisitor::visitField(const Field& field)
+{
+    GqlPlanNode node{};
+    node.fieldName = field.getName().getValue();
+    if (field.getAlias())
+    {
+        node.alias = field.getAlias()->getValue();
+    }
 
-            fragmentBuilder = std::move(childObjectBuilder);
+    isScalarField = !field.getSelectionSet();
+    if (isScalarField)
+    {
+        if (objects.empty())
+        {
+            log<level::ERR>("GQL Invalid Structure");
+            throw exceptions::GqlAstError("Invalid Structure");
         }
-        catch (entity::exceptions::EntityException& ex)
+        try
         {
-            throw exceptions::GqlAstError(ex.what());
+            node.action = GqlPlanNode::Action::projectMember;
+            node.member = objects.back().entity->getMember(node.fieldName);
         }
-        catch (nlohmann::detail::type_error& ex)
+        catch (entity::exceptions::EntityException& ex)
         {
-            throw exceptions::GqlAstError(
-                "Internal GQL implementation error or requested AST structure "
-                "is not supported");
+            log<level::DEBUG>("GQL Invalid Argument.",
+                              entry("ERROR=%s", ex.what()));
+            throw exceptions::GqlInvalidArgument(node.fieldName,
+                                                 "Field not found");
         }
+        objects.back().selections.push_back(std::move(node));
+        return true;
     }
-    else
+
+    try
     {
-        // Scalar field
-        if (!fragmentBuilder)
+        if (objects.empty())
         {
-            throw exceptions::GqlInternalError("Not builder found");
+            node.action = GqlPlanNode::Action::scanEntity;
+            node.entity =
+                application.getEntityManager().getEntity(node.fieldName);
         }
-
-        fragmentBuilder->supplement(fieldAlias.has_value() ? *fieldAlias
-                                                           : fieldName);
+        else
+        {
+            node.action = GqlPlanNode::Action::joinRelation;
+            node.relation = objects.back().entity->getRelation(node.fieldName);
+            if (!node.relation)
+            {
+                throw exceptions::GqlInvalidArgument(
+                    node.fieldName,
+                    "Relation to the " + node.fieldName + " was not found");
+            }
+            node.entity = node.relation->getDestinationTarget();
+        }
+        if (!node.entity)
+        {
+            throw exceptions::GqlAstError("Invalid Structure");
+        }
+    }
+    catch (entity::exceptions::EntityException& ex)
+    {
+        throw exceptions::GqlAstError(ex.what());
     }
+    objects.push_back(std::move(node));
 
     return true;
 }
@@ -193,34 +341,123 @@ void GqlQueryVisitor::endVisitField(const Field& field)
     if (field.getSelectionSet())
     {
         // this is object
-        fragmentBuilder->pushFragmentToParent();
-        if (fragmentBuilder->getParent())
-        {
-            fragmentBuilder = std::move(fragmentBuilder->getParent());
-        }
+        auto node = std::move(objects.back());
+        objects.pop_back();
+        auto& selections =
+            objects.empty() ? plan.selections : objects.back().selections;
+        selections.push_back(std::move(node));
     }
 }
 
-GqlQueryVisitor::~GqlQueryVisitor()
+// ROUTER
+helpers::LruCache<std::string, GqlDocumentPtr>
+    GraphqlRouter::documents(maxCachedDocuments);
+
+std::string GraphqlRouter::normalizeQuery(const std::string& text)
 {
-    this->document = fragmentBuilder->getFragment();
+    static constexpr const char* blockQuote = R"(""")";
+    std::string normalized;
+    normalized.reserve(text.size());
+    bool isString = false;
+    bool isComment = false;
+    bool isSeparator = false;
+    for (auto charIt = text.begin(); charIt != text.end(); ++charIt)
+    {
+        const char character = *charIt;
+        if (isComment)
+        {
+            isComment = character != '\n' && character != '\r';
+            continue;
+        }
+        if (isString)
+        {
+            normalized.push_back(character);
+            if (character == '\\' && std::next(charIt) != text.end())
+            {
+                normalized.push_back(*(++charIt));
+            }
+            else if (character == '"')
+            {
+                isString = false;
+            }
+            continue;
+        }
+        // The commas are insignificant in GraphQL as well as the whitespaces
+        if (std::isspace(static_cast<unsigned char>(character)) ||
+            character == ',')
+        {
+            isSeparator = true;
+            continue;
+        }
+        if (character == '#')
+        {
+            isComment = true;
+            isSeparator = true;
+            continue;
+        }
+        if (isSeparator && !normalized.empty())
+        {
+            normalized.push_back(' ');
+        }
+        isSeparator = false;
+        if (text.compare(charIt - text.begin(), 3, blockQuote) == 0)
+        {
+            // The block string is copied as is up to the closing quote
+            const auto begin = static_cast<std::size_t>(charIt - text.begin());
+            auto end = text.find(blockQuote, begin + 3);
+            while (end != std::string::npos && text[end - 1] == '\\')
+            {
+                end = text.find(blockQuote, end + 1);
+            }
+            end = end == std::string::npos ? text.size() : end + 3;
+            normalized.append(text, begin, end - begin);
+            charIt = std::next(text.begin(), end - 1);
+            continue;
+        }
+        isString = character == '"';
+        normalized.push_back(character);
+    }
+    return normalized;
 }
 
-const GqlBuildPtr GqlQueryVisitor::getBuilder() const
+GqlDocumentPtr GraphqlRouter::getDocument(const std::string& text)
 {
-    return this->fragmentBuilder;
+    auto cachedDocument = documents.find(text);
+    if (cachedDocument)
+    {
+        return *cachedDocument;
+    }
+
+    // The libgraphqlparser scanner and parser are reentrant, each call
+    // allocates its own state. Hence, the documents are parsed concurrently.
+    const char* error = nullptr;
+    GqlAstPtr ast(facebook::graphql::parseString(text.c_str(), &error));
+    if (!ast)
+    {
+        log<level::DEBUG>("Error parsing GQL document.",
+                          entry("ERROR=%s", error ? error : ""));
+        free(const_cast<char*>(error));
+        return nullptr;
+    }
+
+    GqlPlanPtr plan;
+    try
+    {
+        plan = compile(*ast);
+    }
+    catch (exceptions::GqlException& gqlException)
+    {
+        log<level::DEBUG>("Error compiling GQL document.",
+                          entry("ERROR=%s", gqlException.what()));
+    }
+    auto document = std::make_shared<const GqlDocument>(
+        GqlDocument{std::move(ast), std::move(plan)});
+    documents.insert(text, document);
+    return document;
 }
 
-// ROUTER
 bool GraphqlRouter::preHandlers(const RequestPtr& request)
 {
-    // Hmm, here something bad is happening without a critical section...
-    // I have assume the GraphQL AST parser is not thread-safe
-    static std::mutex parseLockMutex;
-    std::lock_guard<std::mutex> lock(parseLockMutex);
-
-    const char* error;
-
     const auto postBuffer = request->environment().postBuffer();
 
     if (postBuffer.empty())
@@ -240,12 +477,12 @@ bool GraphqlRouter::preHandlers(const RequestPtr& request)
 
     try
     {
-        auto astData = jsonData["query"].get<const std::string>();
-        gqlNode = facebook::graphql::parseString(astData.c_str(), &error);
-
-        if (!gqlNode)
+        auto astData =
+            normalizeQuery(jsonData["query"].get<const std::string>());
+        document = getDocument(astData);
+        if (document)
         {
-            free(const_cast<char*>(error));
+            query = std::move(astData);
         }
     }
     catch (std::exception& ex)
@@ -256,200 +493,501 @@ bool GraphqlRouter::preHandlers(const RequestPtr& request)
     return true;
 }
 
-const ResponsePtr GraphqlRouter::run(const RequestPtr& request)
+std::optional<std::string>
+    GraphqlRouter::getRepresentation(const RequestPtr& request) const
+{
+    if (!document)
+    {
+        return std::nullopt;
+    }
+    // Only the query operations are supported, so the representation is
+    // identified by the query sent via POST. The router answers its matched
+    // ETag by 412 instead of 304 since the method isn't GET.
+    const auto& session = request->getSession();
+    return path + ' ' + (session ? session->username : std::string()) +
+           (isPrettyRequested(request) ? " pretty " : " compact ") + query;
+}
+
+GqlPlanPtr GraphqlRouter::compile(const ast::Node& ast)
 {
     ObmcGqlVisitor visitor;
-    json result = json::object({});
+    ast.accept(&visitor);
+    return std::make_shared<const GqlPlan>(visitor.getPlan());
+}
+
+bool GraphqlRouter::isPrettyRequested(const RequestPtr& request)
+{
+    const auto& parameters = request->environment().gets;
+    const auto parameter = parameters.find(prettyParameter);
+    return parameter != parameters.end() && parameter->second != "false" &&
+           parameter->second != "0";
+}
+
+const ResponsePtr GraphqlRouter::run(const RequestPtr& request)
+{
+    const int indent = isPrettyRequested(request) ? prettyIndent : 0;
+    auto response = std::make_shared<Response>();
+    response->setStatus(statuses::Code::OK);
+    response->setContentType(http::content_types::applicationJson);
 
     try
     {
-        if (!gqlNode)
+        if (!document)
         {
             throw exceptions::GqlAstError(
                 "Invalid Grapqh AST. Can't parse comming request");
         }
-        gqlNode->accept(&visitor);
-        graphql_ast_to_json(
-            reinterpret_cast<const struct GraphQLAstNode*>(gqlNode.get()));
-
-        result.push_back({fields::respFieldData, visitor.getResult()});
+        const auto plan = document->plan ? document->plan
+                                         : compile(*document->ast);
+        // The instances are resolved under the generation tracker of the
+        // router, then the result is streamed straight to the output.
+        auto executors = std::make_shared<GqlPlanExecutors>();
+        executors->reserve(plan->size());
+        for (const auto& operationPlan : *plan)
+        {
+            executors->push_back(
+                std::make_unique<GqlPlanExecutor>(operationPlan));
+        }
+        response->setBodyWriter([plan, executors, indent](std::ostream& os) {
+            writeData(os, *plan, *executors, indent);
+        });
     }
     catch (exceptions::GqlException& gqlException)
     {
         log<level::DEBUG>("Error handle GQL request.",
                           entry("ERROR=%s", gqlException.what()));
+        json result = json::object({});
         result.push_back({fields::respFieldError, gqlException.whatJson()});
+        response->pushJson(std::move(result), indent);
     }
-    auto response = std::make_shared<Response>();
-    response->push(result.dump(2));
-    response->setStatus(statuses::Code::OK);
-    response->setContentType(http::content_types::applicationJson);
     return response;
 }
 
-// BUILDERS
-void GqlObjectBuild::supplement(const std::string& fieldName)
+void GraphqlRouter::writeData(std::ostream& os, const GqlPlan& plan,
+                              const GqlPlanExecutors& executors, int indent)
 {
-    auto targetEntity = getEntity();
-    if (!fragment.type_name() || fragment.is_null() || !targetEntity)
-    {
-        log<level::ERR>("GQL Invalid Structure");
-        throw exceptions::GqlAstError("Invalid Structure");
-    }
-
+    GqlJsonWriter writer(os, indent);
+    writer.beginObject();
+    writer.key(fields::respFieldData);
+    writer.beginObject();
+    const auto dataDepth = writer.depth();
+    std::optional<json> error;
     try
     {
-        auto member = targetEntity->getMember(fieldName);
-        const auto& instances = targetEntity->getInstances();
-        for (auto instance : instances)
+        for (std::size_t index = 0; index < plan.size(); ++index)
         {
-            auto& jsonObject = fragment[std::to_string(instance->getHash())];
-
-            auto valVisitor = [&jsonObject, fieldName](auto&& value) {
-                jsonObject.push_back({fieldName, value});
-            };
-            if (!instance->getField(member)->isNull())
-            {
-                std::visit(std::move(valVisitor),
-                           instance->getField(member)->getValue());
-                continue;
-            }
-            valVisitor(nullptr);
+            writer.key(plan[index].operation);
+            executors[index]->write(writer);
         }
     }
-    catch (entity::exceptions::EntityException& ex)
+    catch (exceptions::GqlException& gqlException)
     {
-        log<level::DEBUG>("GQL Invalid Argument.",
-                          entry("ERROR=%s", ex.what()));
-        throw exceptions::GqlInvalidArgument(fieldName, "Field not found");
+        log<level::ERR>("Fail to write GQL result.",
+                        entry("ERROR=%s", gqlException.what()));
+        writer.unwind(dataDepth);
+        error = gqlException.whatJson();
+    }
+    catch (std::exception& ex)
+    {
+        log<level::ERR>("Fail to write GQL result.",
+                        entry("ERROR=%s", ex.what()));
+        writer.unwind(dataDepth);
+        error = exceptions::GqlInternalError("Fail to write the result")
+                    .whatJson();
     }
-    catch (std::out_of_range& ex)
+    writer.endObject();
+    if (error)
     {
-        log<level::DEBUG>("Out of range", entry("ERROR=%s", ex.what()));
-        throw exceptions::GqlInternalError("Internal GQL logic error");
+        writer.key(fields::respFieldError);
+        writer.jsonValue(*error);
     }
+    writer.endObject();
+}
+
+// WRITER
+void GqlJsonWriter::beginObject()
+{
+    beginValue();
+    begin('{');
+}
+
+void GqlJsonWriter::endObject()
+{
+    end('}');
+}
+
+void GqlJsonWriter::beginArray()
+{
+    beginValue();
+    begin('[');
+}
+
+void GqlJsonWriter::endArray()
+{
+    end(']');
+}
+
+void GqlJsonWriter::key(const std::string& name)
+{
+    beginValue();
+    write(name);
+    output << (indent > 0 ? ": " : ":");
+    isKeyWritten = true;
 }
 
-void GqlObjectBuild::supplement(const std::string& fieldName, GqlBuildPtr child)
+void GqlJsonWriter::value(const FieldType& fieldValue)
 {
-    if (this->fragment.is_object())
+    beginValue();
+    std::visit([this](const auto& value) { write(value); }, fieldValue);
+}
+
+void GqlJsonWriter::jsonValue(const json& document)
+{
+    beginValue();
+    output << document.dump();
+}
+
+void GqlJsonWriter::unwind(std::size_t depth)
+{
+    if (isKeyWritten)
     {
-        for (const auto& [hashStr, item] : this->fragment.items())
-        {
-            std::optional<std::size_t> hash;
-            try
-            {
-                hash.emplace(std::stoull(hashStr));
-            }
-            catch (std::invalid_argument& ex)
-            {
-                // The root node might haven't the valid instance hash. Hence,
-                // suppress the raized exception
-                log<level::DEBUG>(
-                    "Can't cast instance hash string to numeric hash view",
-                    entry("ERROR=%s", ex.what()));
-            }
-            auto childJsonNode =
-                std::forward<const json>(child->getFragment(hash));
-            item.push_back({fieldName, childJsonNode});
-        }
+        value(nullptr);
     }
-    else
+    while (openBrackets.size() > depth)
+    {
+        end(openBrackets.back() == '{' ? '}' : ']');
+    }
+}
+
+void GqlJsonWriter::beginValue()
+{
+    if (isKeyWritten)
+    {
+        isKeyWritten = false;
+        return;
+    }
+    if (hasElements.empty())
+    {
+        return;
+    }
+    if (hasElements.back())
     {
-        log<level::DEBUG>("The internal JSON fragment type is not supproted.");
-        throw exceptions::GqlInternalError(
-            "A GQL parser implementation error.");
+        output << ',';
     }
+    hasElements.back() = true;
+    newLine();
 }
 
-const json GqlObjectBuild::getFragment(
-    std::optional<std::size_t> parentInstanceHash) const
+void GqlJsonWriter::begin(char bracket)
 {
-    json result(json::object({}));
+    output << bracket;
+    hasElements.push_back(false);
+    openBrackets.push_back(bracket);
+}
 
-    try
+void GqlJsonWriter::end(char bracket)
+{
+    const bool isEmpty = !hasElements.back();
+    hasElements.pop_back();
+    openBrackets.pop_back();
+    if (!isEmpty)
     {
-        auto entity = getEntity();
-        if (!entity)
-        {
-            return std::forward<const json>(fragment.back());
-        }
-        else
+        newLine();
+    }
+    output << bracket;
+}
+
+void GqlJsonWriter::newLine()
+{
+    if (indent > 0)
+    {
+        output << '\n' << std::string(indent * hasElements.size(), ' ');
+    }
+}
+
+void GqlJsonWriter::write(const std::string& text)
+{
+    static constexpr const char* hexDigits = "0123456789abcdef";
+    output << '"';
+    for (const char character : text)
+    {
+        switch (character)
         {
-            std::vector<entity::IEntity::ConditionPtr> conditions;
-            if (this->relation && parentInstanceHash.has_value())
-            {
-                conditions = std::move(
-                    this->relation->getConditions(*parentInstanceHash));
-            }
-            const auto& instances = entity->getInstances(conditions);
-            if (instances.size() == 1 &&
-                entity->getType() != entity::IEntity::Type::array)
-            {
-                result =
-                    fragment.at(std::to_string(instances.back()->getHash()));
-            }
-            else if (instances.size() > 1 ||
-                     entity->getType() == entity::IEntity::Type::array)
-            {
-                result = json::array({});
-                for (auto instance : instances)
+            case '"':
+                output << "\\\"";
+                break;
+            case '\\':
+                output << "\\\\";
+                break;
+            case '\b':
+                output << "\\b";
+                break;
+            case '\f':
+                output << "\\f";
+                break;
+            case '\n':
+                output << "\\n";
+                break;
+            case '\r':
+                output << "\\r";
+                break;
+            case '\t':
+                output << "\\t";
+                break;
+            default:
+                if (static_cast<unsigned char>(character) < 0x20)
                 {
-                    result.push_back(
-                        fragment.at(std::to_string(instance->getHash())));
+                    output << "\\u00"
+                           << hexDigits[(character >> 4) & 0x0f]
+                           << hexDigits[character & 0x0f];
+                    break;
                 }
-            }
+                output << character;
         }
     }
-    catch (std::out_of_range& ex)
+    output << '"';
+}
+
+void GqlJsonWriter::write(const Association& association)
+{
+    begin('[');
+    std::apply(
+        [this](const auto&... items) { ((beginValue(), write(items)), ...); },
+        association);
+    end(']');
+}
+
+void GqlJsonWriter::write(double number)
+{
+    if (!std::isfinite(number))
+    {
+        write(nullptr);
+        return;
+    }
+    std::array<char, 32> buffer{};
+    const auto [end, error] =
+        std::to_chars(buffer.data(), buffer.data() + buffer.size(), number);
+    const std::string_view text(buffer.data(), end - buffer.data());
+    output << text;
+    // Keep the number floating on the client side
+    if (text.find_first_of(".e") == std::string_view::npos)
     {
-        throw exceptions::GqlInternalError(
-            "Internal GQL logic error. Can't setup the Object data: " +
-            this->name);
+        output << ".0";
     }
-    return std::forward<json>(result);
 }
 
-void GqlObjectBuild::setAlias(const std::string& alias)
+void GqlJsonWriter::write(bool boolean)
 {
-    this->alias = alias;
+    output << (boolean ? "true" : "false");
 }
 
-GqlBuildPtr GqlObjectBuild::getParent() const
+void GqlJsonWriter::write(std::nullptr_t)
 {
-    return parent;
+    output << "null";
 }
 
-const std::string GqlObjectBuild::getFieldName() const
+// EXECUTOR
+GqlPlanExecutor::GqlPlanExecutor(const GqlOperationPlan& operationPlan) :
+    plan(operationPlan)
 {
-    return std::forward<const std::string>(alias.has_value() ? *alias : name);
+    try
+    {
+        for (const auto& node : plan.selections)
+        {
+            resolve(node, nullptr);
+        }
+    }
+    catch (entity::exceptions::EntityException& ex)
+    {
+        throw exceptions::GqlAstError(ex.what());
+    }
 }
 
-void GqlObjectBuild::pushFragmentToParent()
+void GqlPlanExecutor::write(GqlJsonWriter& writer) const
 {
-    if (!this->parent)
+    writer.beginObject();
+    for (const auto& node : plan.selections)
     {
-        log<level::DEBUG>("The parent builder not specified. Skip pushing the "
-                          "JSON framgent to the parent builder");
-        return;
+        writer.key(node.getResponseName());
+        writeField(writer, node, std::nullopt);
     }
-    this->parent->supplement(getFieldName(), shared_from_this());
+    writer.endObject();
 }
 
-const entity::IEntity::InstancePtr GqlObjectBuild::getCurrentInstance() const
+void GqlPlanExecutor::resolve(const GqlPlanNode& node,
+                              const InstanceCollection* parents)
 {
-    return this->currentInstance;
+    auto& field = resolvedFields[&node];
+    if (node.action == GqlPlanNode::Action::scanEntity)
+    {
+        // Actualize the entity data as the entity manager does
+        node.entity->populate();
+    }
+    field.instances = node.entity->getInstances(node.conditions);
+    if (node.relation && parents)
+    {
+        field.relatedInstances =
+            joinRelated(node.relation, *parents, field.instances);
+    }
+    for (const auto& child : node.selections)
+    {
+        if (child.action != GqlPlanNode::Action::projectMember)
+        {
+            resolve(child, &field.instances);
+        }
+    }
 }
 
-const entity::EntityPtr GqlObjectBuild::getEntity() const
+void GqlPlanExecutor::writeField(GqlJsonWriter& writer,
+                                 const GqlPlanNode& node,
+                                 std::optional<std::size_t> parentHash) const
 {
-    if (!entityObject &&
-        (!relation || (relation && !relation->getDestinationTarget())))
+    static const InstanceCollection noInstances;
+    const auto& field = resolvedFields.at(&node);
+    const InstanceCollection* selected = &field.instances;
+    if (node.relation && parentHash.has_value())
     {
-        log<level::DEBUG>("Attempt to access the empty Entity");
-        return nullptr;
+        auto relatedIt = field.relatedInstances.find(*parentHash);
+        selected = relatedIt != field.relatedInstances.end()
+                       ? &relatedIt->second
+                       : &noInstances;
+    }
+
+    const bool isArray = node.entity->getType() == entity::IEntity::Type::array;
+    if (selected->size() == 1 && !isArray)
+    {
+        writeInstance(writer, node, selected->back());
+    }
+    else if (selected->size() > 1 || isArray)
+    {
+        writer.beginArray();
+        for (const auto& instance : *selected)
+        {
+            writeInstance(writer, node, instance);
+        }
+        writer.endArray();
+    }
+    else
+    {
+        writer.beginObject();
+        writer.endObject();
+    }
+}
+
+void GqlPlanExecutor::writeInstance(
+    GqlJsonWriter& writer, const GqlPlanNode& node,
+    const entity::IEntity::InstancePtr& instance) const
+{
+    writer.beginObject();
+    for (const auto& child : node.selections)
+    {
+        writer.key(child.getResponseName());
+        if (child.action != GqlPlanNode::Action::projectMember)
+        {
+            writeField(writer, child, instance->getHash());
+            continue;
+        }
+        try
+        {
+            const auto& fieldInstance = instance->getField(child.member);
+            if (fieldInstance->isNull())
+            {
+                writer.value(nullptr);
+                continue;
+            }
+            writer.value(fieldInstance->getValue());
+        }
+        catch (entity::exceptions::EntityException& ex)
+        {
+            log<level::DEBUG>("GQL Invalid Argument.",
+                              entry("ERROR=%s", ex.what()));
+            throw exceptions::GqlInvalidArgument(child.fieldName,
+                                                 "Field not found");
+        }
+        catch (std::out_of_range& ex)
+        {
+            log<level::DEBUG>("Out of range", entry("ERROR=%s", ex.what()));
+            throw exceptions::GqlInternalError("Internal GQL logic error");
+        }
+    }
+    writer.endObject();
+}
+
+GqlPlanExecutor::RelatedInstances GqlPlanExecutor::joinRelated(
+    const entity::IEntity::RelationPtr& relation,
+    const InstanceCollection& parents, const InstanceCollection& targets)
+{
+    using namespace app::entity;
+    using Buckets = std::unordered_map<std::size_t, InstanceCollection>;
+
+    // The target instances grouped by the value of the member compared by an
+    // equality rule. The buckets are built once for all parent instances and
+    // narrow the instances to check the relation conditions.
+    std::map<MemberName, Buckets> joinIndexes;
+    auto getBuckets = [&targets, &joinIndexes](
+                          const MemberName& memberName) -> const Buckets& {
+        auto [indexIt, isNew] = joinIndexes.try_emplace(memberName);
+        if (!isNew)
+        {
+            return indexIt->second;
+        }
+        for (const auto& instance : targets)
+        {
+            try
+            {
+                const auto valueHash = BaseEntity::InstancesIndex::hashValue(
+                    instance->getField(memberName)->getValue());
+                indexIt->second[valueHash].push_back(instance);
+            }
+            catch (std::exception& ex)
+            {
+                // The instance without the member never satisfies the
+                // equality rule
+                log<level::DEBUG>("Skip the instance to join by the member",
+                                  entry("MEMBER=%s", memberName.c_str()),
+                                  entry("ERROR=%s", ex.what()));
+            }
+        }
+        return indexIt->second;
+    };
+
+    static const InstanceCollection noInstances;
+    RelatedInstances relatedInstances;
+    for (const auto& parent : parents)
+    {
+        const auto parentHash = parent->getHash();
+        const auto relationConditions = relation->getConditions(parentHash);
+        const InstanceCollection* candidates = &targets;
+        for (const auto& condition : relationConditions)
+        {
+            const auto rules = condition->getEqualityRules();
+            if (!rules.empty())
+            {
+                const auto& [memberName, value] = rules.front();
+                const auto& buckets = getBuckets(memberName);
+                auto bucketIt = buckets.find(
+                    BaseEntity::InstancesIndex::hashValue(value));
+                candidates = bucketIt != buckets.end() ? &bucketIt->second
+                                                       : &noInstances;
+                break;
+            }
+        }
+
+        auto& related = relatedInstances[parentHash];
+        for (const auto& candidate : *candidates)
+        {
+            const bool isRelated = std::all_of(
+                relationConditions.begin(), relationConditions.end(),
+                [&candidate](const auto& condition) {
+                    return candidate->checkCondition(condition);
+                });
+            if (isRelated)
+            {
+                related.push_back(candidate);
+            }
+        }
     }
-    return entityObject ? this->entityObject : relation->getDestinationTarget();
+    return relatedInstances;
 }
 
 // FACTORY
@@ -462,13 +1000,13 @@ void VisitorFactory::registerVisitor(const std::string& visitorName)
                   "This is not a GQL visitor");
 
     visitorBuildersDict.emplace(
-        visitorName, [visitorName](nlohmann::json& fragment) -> AstVisitorUni {
-            return std::make_unique<TVisitor>(fragment);
+        visitorName, [visitorName](GqlOperationPlan& plan) -> AstVisitorUni {
+            return std::make_unique<TVisitor>(plan);
         });
 }
 
 AstVisitorUni VisitorFactory::build(const std::string visitorName,
-                                    nlohmann::json& fragment)
+                                    GqlOperationPlan& plan)
 {
     auto builder = visitorBuildersDict.find(visitorName);
     if (builder == visitorBuildersDict.end())
@@ -476,7 +1014,7 @@ AstVisitorUni VisitorFactory::build(const std::string visitorName,
         return AstVisitorUni();
     }
 
-    return builder->second(fragment);
+    return builder->second(plan);
 }
 
 void VisitorFactory::registerGqlVisitors() noexcept
@@ -6,16 +6,20 @@
 #include <graphqlparser/AstNode.h>
 #include <graphqlparser/AstVisitor.h>
 #include <graphqlparser/GraphQLParser.h>
-#include <graphqlparser/c/GraphQLAstToJSON.h>
 
 #include <core/entity/entity.hpp>
 #include <core/exceptions.hpp>
+#include <core/helpers/lru_cache.hpp>
 #include <core/router.hpp>
 #include <nlohmann/json.hpp>
 
 #include <exception>
 #include <map>
+#include <memory>
 #include <optional>
+#include <ostream>
+#include <type_traits>
+#include <unordered_map>
 #include <variant>
 
 namespace app
@@ -41,71 +45,218 @@ using namespace facebook::graphql;
 using namespace facebook::graphql::ast;
 
 using AstVisitorUni = std::unique_ptr<visitor::AstVisitor>;
+using GqlAstPtr = std::shared_ptr<const ast::Node>;
+
+/**
+ * @struct GqlPlanNode
+ * @brief The field of the compiled GraphQL operation. The entities, relations
+ *        and members are resolved by the compiler, hence the execution doesn't
+ *        look up them by name.
+ */
+struct GqlPlanNode
+{
+    enum class Action
+    {
+        scanEntity,
+        joinRelation,
+        projectMember,
+    };
 
-class IGqlBuild;
-using GqlBuildPtr = std::shared_ptr<IGqlBuild>;
+    Action action;
+    std::string fieldName;
+    std::optional<std::string> alias;
+    /** @brief The entity of the instances the object field is built of */
+    entity::EntityPtr entity;
+    entity::IEntity::RelationPtr relation;
+    entity::IEntity::EntityMemberPtr member;
+    /** @brief The filter of the object field built of its arguments */
+    entity::IEntity::ConditionsList conditions;
+    /** @brief The selections of the object field in the query order */
+    std::vector<GqlPlanNode> selections;
 
-class IGqlBuild
+    const std::string& getResponseName() const
+    {
+        return alias.has_value() ? *alias : fieldName;
+    }
+};
+
+/**
+ * @struct GqlOperationPlan
+ * @brief The tree of fields to build the result of a GraphQL operation
+ */
+struct GqlOperationPlan
 {
-  public:
-    virtual ~IGqlBuild() = default;
-
-    virtual void setAlias(const std::string&) = 0;
-    virtual void supplement(const std::string&) = 0;
-    virtual void supplement(const std::string&, GqlBuildPtr) = 0;
-
-    virtual void pushFragmentToParent() = 0;
-    virtual const json
-        getFragment(std::optional<std::size_t> = std::nullopt) const = 0;
-    virtual GqlBuildPtr getParent() const = 0;
-    virtual const std::string getFieldName() const = 0;
-    virtual const entity::IEntity::InstancePtr getCurrentInstance() const = 0;
-    virtual const entity::EntityPtr getEntity() const = 0;
+    std::string operation;
+    std::vector<GqlPlanNode> selections;
 };
 
-class GqlObjectBuild :
-    public IGqlBuild,
-    public std::enable_shared_from_this<GqlObjectBuild>
+using GqlPlan = std::vector<GqlOperationPlan>;
+using GqlPlanPtr = std::shared_ptr<const GqlPlan>;
+
+/**
+ * @struct GqlDocument
+ * @brief The parsed GraphQL document and its execution plan. The plan is
+ *        absent if the document refers to the unknown entities or members,
+ *        the error is reported by compiling the document again.
+ */
+struct GqlDocument
 {
-    const std::string name;
-    const entity::EntityPtr entityObject;
-    entity::IEntity::RelationPtr relation;
+    GqlAstPtr ast;
+    GqlPlanPtr plan;
+};
 
-    GqlBuildPtr parent;
-    json fragment;
-    std::optional<std::string> alias;
-    entity::IEntity::InstancePtr currentInstance;
+using GqlDocumentPtr = std::shared_ptr<const GqlDocument>;
 
+/**
+ * @class GqlJsonWriter
+ * @brief Writes the JSON document to the stream as the values are produced,
+ *        without building the intermediate DOM. The output is compact unless
+ *        the indentation is specified.
+ */
+class GqlJsonWriter final
+{
   public:
-    GqlObjectBuild(const std::string& objectName) :
-        name(objectName), entityObject(), parent(GqlBuildPtr()),
-        fragment(json::object({{objectName, json::object({})}}))
+    using FieldType = entity::IEntity::IEntityMember::IInstance::FieldType;
+    using Association =
+        entity::IEntity::IEntityMember::IInstance::Association;
+
+    explicit GqlJsonWriter(std::ostream& stream, int indentation = 0) :
+        output(stream), indent(indentation)
     {}
 
-    GqlObjectBuild(const std::string&, const entity::EntityPtr, GqlBuildPtr);
-    GqlObjectBuild(const std::string&, const entity::IEntity::RelationPtr,
-                   GqlBuildPtr);
+    GqlJsonWriter(const GqlJsonWriter&) = delete;
+    GqlJsonWriter(const GqlJsonWriter&&) = delete;
+
+    GqlJsonWriter& operator=(const GqlJsonWriter&) = delete;
+    GqlJsonWriter& operator=(const GqlJsonWriter&&) = delete;
+
+    ~GqlJsonWriter() = default;
+
+    void beginObject();
+    void endObject();
+    void beginArray();
+    void endArray();
+    void key(const std::string& name);
+    void value(const FieldType& fieldValue);
+    /**
+     * @brief Write the JSON value composed in advance, e.g. the error
+     */
+    void jsonValue(const json& document);
+
+    /**
+     * @brief Get the count of the open containers
+     */
+    std::size_t depth() const
+    {
+        return openBrackets.size();
+    }
+    /**
+     * @brief Close the containers opened above the specified depth, so the
+     *        document stays valid if writing of the value is interrupted.
+     *        The key that has no value yet gets null.
+     *
+     * @param depth - the count of the containers to keep open
+     */
+    void unwind(std::size_t depth);
+
+  private:
+    void beginValue();
+    void begin(char bracket);
+    void end(char bracket);
+    void newLine();
+
+    void write(const std::string& text);
+    void write(const Association& association);
+    void write(double number);
+    void write(bool boolean);
+    void write(std::nullptr_t);
+
+    template <typename TValue>
+        requires std::is_integral_v<TValue>
+    void write(TValue number)
+    {
+        // The unary plus prints the one-byte integers as numbers
+        output << +number;
+    }
+
+    template <typename TItem>
+    void write(const std::vector<TItem>& items)
+    {
+        begin('[');
+        for (const auto& item : items)
+        {
+            beginValue();
+            write(item);
+        }
+        end(']');
+    }
 
-    GqlObjectBuild(const GqlObjectBuild&) = delete;
-    GqlObjectBuild(const GqlObjectBuild&&) = delete;
+    std::ostream& output;
+    const int indent;
+    /** @brief Whether each open container has an element already */
+    std::vector<bool> hasElements;
+    /** @brief The opening brackets of the open containers */
+    std::string openBrackets;
+    bool isKeyWritten = false;
+};
 
-    GqlObjectBuild& operator=(const GqlObjectBuild&) = delete;
-    GqlObjectBuild& operator=(const GqlObjectBuild&&) = delete;
+/**
+ * @class GqlPlanExecutor
+ * @brief Executes the compiled GraphQL operation. The instances of each
+ *        object field are resolved level by level at first, the relation is
+ *        resolved for all the parent instances at once. Then the result is
+ *        written in the query order.
+ */
+class GqlPlanExecutor final
+{
+    using InstanceCollection = entity::IEntity::InstanceCollection;
+    using RelatedInstances =
+        std::unordered_map<std::size_t, InstanceCollection>;
 
-    ~GqlObjectBuild() override = default;
+    struct ResolvedField
+    {
+        /** @brief The snapshot of the instances the field is built of */
+        InstanceCollection instances;
+        /** @brief The instances related to each parent instance */
+        RelatedInstances relatedInstances;
+    };
 
-    void setAlias(const std::string&) override;
+  public:
+    explicit GqlPlanExecutor(const GqlOperationPlan& operationPlan);
+
+    GqlPlanExecutor(const GqlPlanExecutor&) = delete;
+    GqlPlanExecutor(const GqlPlanExecutor&&) = delete;
+
+    GqlPlanExecutor& operator=(const GqlPlanExecutor&) = delete;
+    GqlPlanExecutor& operator=(const GqlPlanExecutor&&) = delete;
 
-    void supplement(const std::string&) override;
-    void supplement(const std::string&, GqlBuildPtr) override;
+    ~GqlPlanExecutor() = default;
 
-    const json
-        getFragment(std::optional<std::size_t> = std::nullopt) const override;
-    GqlBuildPtr getParent() const override;
-    const std::string getFieldName() const override;
-    void pushFragmentToParent() override;
-    const entity::IEntity::InstancePtr getCurrentInstance() const;
-    const entity::EntityPtr getEntity() const override;
+    /**
+     * @brief Write the operation result
+     *
+     * @param writer - the JSON writer
+     */
+    void write(GqlJsonWriter& writer) const;
+
+  private:
+    void resolve(const GqlPlanNode& node, const InstanceCollection* parents);
+    void writeField(GqlJsonWriter& writer, const GqlPlanNode& node,
+                    std::optional<std::size_t> parentHash) const;
+    void writeInstance(GqlJsonWriter& writer, const GqlPlanNode& node,
+                       const entity::IEntity::InstancePtr& instance) const;
+
+    /**
+     * @brief Resolve the relation for all the parent instances in a single
+     *        pass over the target instances.
+     */
+    static RelatedInstances
+        joinRelated(const entity::IEntity::RelationPtr& relation,
+                    const InstanceCollection& parents,
+                    const InstanceCollection& targets);
+
+    const GqlOperationPlan& plan;
+    std::unordered_map<const GqlPlanNode*, ResolvedField> resolvedFields;
 };
 
 namespace exceptions
@@ -198,6 +349,10 @@ class GqlAstError : public GqlException
 } // namespace exceptions
 class GraphqlRouter : public IRouteHandler
 {
+    static constexpr std::size_t maxCachedDocuments = 128;
+    static constexpr const char* prettyParameter = "pretty";
+    static constexpr int prettyIndent = 2;
+
   public:
     explicit GraphqlRouter(const std::string& iPath) : path(iPath)
     {}
@@ -211,23 +366,83 @@ class GraphqlRouter : public IRouteHandler
 
     const ResponsePtr run(const RequestPtr& request) override;
     bool preHandlers(const RequestPtr& request) override;
+    std::optional<std::string>
+        getRepresentation(const RequestPtr& request) const override;
     // const std::string& getUriPath() const override;
     virtual ~GraphqlRouter() = default;
 
+    /**
+     * @brief Normalize the GraphQL document text to share the parsed
+     *        document between the queries that differ in the insignificant
+     *        whitespaces and comments only.
+     *
+     * @param text - the GraphQL document text
+     *
+     * @return std::string - the normalized text
+     */
+    static std::string normalizeQuery(const std::string& text);
+
+    /**
+     * @brief Compile the GraphQL document to the execution plan
+     *
+     * @param ast - the parsed GraphQL document
+     *
+     * @return GqlPlanPtr - the execution plan
+     *
+     * @throw exceptions::GqlException - the document is not supported or
+     *                                   refers to the unknown entities
+     */
+    static GqlPlanPtr compile(const ast::Node& ast);
+
+    /**
+     * @brief Check whether the pretty output is requested by the query
+     *        parameter. The output is compact by default.
+     */
+    static bool isPrettyRequested(const RequestPtr& request);
+
+    using GqlPlanExecutors = std::vector<std::unique_ptr<GqlPlanExecutor>>;
+    /**
+     * @brief Write the result of the executed operations. The response head
+     *        is sent already, so the error of writing completes the result
+     *        written so far to the valid document and is reported next to
+     *        the data.
+     *
+     * @param os        - the output stream
+     * @param plan      - the execution plan
+     * @param executors - the executors of each operation of the plan
+     * @param indent    - the indentation of the pretty output
+     */
+    static void writeData(std::ostream& os, const GqlPlan& plan,
+                          const GqlPlanExecutors& executors, int indent);
+
   private:
+    /**
+     * @brief Get the parsed document from the cache or parse it
+     *
+     * @param text - the normalized GraphQL document text
+     *
+     * @return GqlDocumentPtr - the parsed document or nullptr if the text is
+     *                          malformed
+     */
+    static GqlDocumentPtr getDocument(const std::string& text);
+
     std::string path;
+    /** @brief The normalized text of the parsed GraphQL document */
+    std::string query;
 
-    std::unique_ptr<ast::Node> gqlNode;
+    GqlDocumentPtr document;
+
+    /** @brief The parsed documents by the normalized text */
+    static helpers::LruCache<std::string, GqlDocumentPtr> documents;
 };
 
 // VISITORS
 class ObmcGqlVisitor : public visitor::AstVisitor
 {
-    nlohmann::json result;
+    GqlPlan plan;
 
   public:
-    ObmcGqlVisitor() : result(json::object())
-    {}
+    ObmcGqlVisitor() = default;
     ~ObmcGqlVisitor() override = default;
 
     bool visitOperationDefinition(
@@ -235,20 +450,17 @@ class ObmcGqlVisitor : public visitor::AstVisitor
     void endVisitOperationDefinition(
         const OperationDefinition& operationDefinition) override;
 
-    const nlohmann::json& getResult() const;
+    const GqlPlan& getPlan() const;
 };
 
 class GqlQueryVisitor : public visitor::AstVisitor
 {
-    GqlBuildPtr fragmentBuilder;
-
   public:
     static constexpr std::string_view visitorName = "query";
 
-    GqlQueryVisitor(nlohmann::json& fragment) : document(fragment)
-    {
-        fragmentBuilder = std::make_shared<GqlObjectBuild>(visitorName.data());
-    }
+    explicit GqlQueryVisitor(GqlOperationPlan& operationPlan) :
+        plan(operationPlan)
+    {}
 
     GqlQueryVisitor(const GqlQueryVisitor&) = delete;
     GqlQueryVisitor(const GqlQueryVisitor&&) = delete;
@@ -258,27 +470,50 @@ class GqlQueryVisitor : public visitor::AstVisitor
 
     bool visitVariableDefinition(const VariableDefinition&) override;
 
+    /**
+     * @brief Compile the argument of the object field to the condition to
+     *        filter the instances.
+     */
     bool visitArgument(const Argument&) override;
-    void endVisitArgument(const Argument&) override;
 
-    bool visitStringValue(const StringValue&) override;
-    void endVisitStringValue(const StringValue&) override;
+    /**
+     * @brief Build the condition of the argument to filter the entity
+     *        instances. The argument named after the entity member requires
+     *        the equal value, the suffixes of the argument name specify
+     *        another comparison:
+     *          - `<Member>_not`         - the value is not equal;
+     *          - `<Member>_in`          - the value is one of the list;
+     *          - `<Member>_starts_with` - the string value starts with.
+     *
+     * @param entity        - the entity of the filtered instances
+     * @param argumentName  - the name of the argument
+     * @param argumentValue - the GraphQL value of the argument
+     *
+     * @return entity::IEntity::ConditionPtr - the condition of the argument
+     * @throw GqlInvalidArgument - the argument doesn't match any member or
+     *                             its value doesn't fit the comparison
+     */
+    static entity::IEntity::ConditionPtr
+        buildCondition(const entity::EntityPtr& entity,
+                       const std::string& argumentName,
+                       const Value& argumentValue);
 
     bool visitField(const Field& field) override;
     void endVisitField(const Field& field) override;
 
-    ~GqlQueryVisitor() override;
-
-    const GqlBuildPtr getBuilder() const;
+    ~GqlQueryVisitor() override = default;
 
   private:
-    nlohmann::json& document;
+    GqlOperationPlan& plan;
+    /** @brief The object fields being visited, the innermost is the last */
+    std::vector<GqlPlanNode> objects;
+    bool isScalarField = false;
 };
 
 class VisitorFactory final
 {
     using VisitorPurpose = std::string;
-    using VisitorBuilderFn = std::function<AstVisitorUni(nlohmann::json&)>;
+    using VisitorBuilderFn = std::function<AstVisitorUni(GqlOperationPlan&)>;
     using VisitorDict = std::map<VisitorPurpose, VisitorBuilderFn>;
     static VisitorDict visitorBuildersDict;
 
@@ -294,7 +529,7 @@ class VisitorFactory final
     static void registerGqlVisitors() noexcept;
 
     static AstVisitorUni build(const std::string visitorName,
-                               nlohmann::json& fragment);
+                               GqlOperationPlan& plan);
 
   private:
     template <class TVisitor>
@@ -11,6 +11,7 @@
 #include <phosphor-logging/log.hpp>
 
 #include <type_traits>
+#include <unordered_map>
 #include <vector>
 
 namespace app
@@ -182,47 +183,9 @@ class Node : public INode
     {}
     ~Node() override = default;
 
-    template <typename TChild, typename... TNextChilds,
-              typename = std::enable_if_t<sizeof...(TNextChilds) != 0>>
-    static std::shared_ptr<INode> nextChildResolver(const RedfishContextPtr ctx,
-                                                    size_t depth)
-    {
-        if (TChild::validateSegment(ctx, depth))
-        {
-            if (TChild::matchEntirePattern(ctx, depth))
-            {
-                return std::make_shared<TChild>(ctx);
-            }
-            else
-            {
-                return TChild::uriResolver(ctx, depth);
-            }
-        }
-        return nextChildResolver<TNextChilds...>(ctx, depth);
-    }
-
-    template <typename TChild>
-    static std::shared_ptr<INode> nextChildResolver(const RedfishContextPtr ctx,
-                                                    size_t depth)
-    {
-        if (TChild::validateSegment(ctx, depth))
-        {
-            if (TChild::matchEntirePattern(ctx, depth))
-            {
-                return std::make_shared<TChild>(ctx);
-            }
-            else
-            {
-                return TChild::uriResolver(ctx, depth);
-            }
-        }
-        return std::make_shared<NodeNotFound>(ctx);
-    }
-
     static std::shared_ptr<INode> uriResolver(const RedfishContextPtr ctx,
                                               size_t depth = 0)
     {
-        constexpr std::size_t childsCount = sizeof...(TChilds);
         if (validateSegment(ctx, depth))
         {
             if (matchEntirePattern(ctx, depth))
@@ -230,9 +193,33 @@ class Node : public INode
                 return std::make_shared<TSelf>(ctx);
             }
         }
-        if constexpr (childsCount > 0)
+        if constexpr (sizeof...(TChilds) > 0)
         {
-            return nextChildResolver<TChilds...>(ctx, depth + 1);
+            const auto& pathInfo = ctx->getRequest()->environment().pathInfo;
+            const size_t childDepth = depth + 1;
+            if (pathInfo.size() > childDepth)
+            {
+                const auto& dispatch = getChildDispatch();
+                auto staticChilds =
+                    dispatch.staticChilds.find(pathInfo[childDepth]);
+                if (staticChilds != dispatch.staticChilds.end())
+                {
+                    for (const auto resolver : staticChilds->second)
+                    {
+                        if (auto node = resolver(ctx, childDepth))
+                        {
+                            return node;
+                        }
+                    }
+                }
+                for (const auto resolver : dispatch.parameterizedChilds)
+                {
+                    if (auto node = resolver(ctx, childDepth))
+                    {
+                        return node;
+                    }
+                }
+            }
         }
         return std::make_shared<NodeNotFound>(ctx);
     }
@@ -318,6 +305,68 @@ class Node : public INode
         return segments;
     }
 
+  private:
+    using ChildResolverFn =
+        std::shared_ptr<INode> (*)(const RedfishContextPtr, size_t);
+
+    /**
+     * @brief The dispatch table of the child nodes. The children that start
+     *        with a static segment are indexed by that segment, so resolving
+     *        the next segment costs a single lookup instead of validating each
+     *        child in turn. The parameterized children are tried in the
+     *        declaration order if no static child claims the segment.
+     */
+    struct ChildDispatch
+    {
+        std::unordered_map<std::string, std::vector<ChildResolverFn>>
+            staticChilds;
+        std::vector<ChildResolverFn> parameterizedChilds;
+    };
+
+    template <typename TChild>
+    static std::shared_ptr<INode> resolveChild(const RedfishContextPtr ctx,
+                                               size_t depth)
+    {
+        if (!TChild::validateSegment(ctx, depth))
+        {
+            return nullptr;
+        }
+        if (TChild::matchEntirePattern(ctx, depth))
+        {
+            return std::make_shared<TChild>(ctx);
+        }
+        return TChild::uriResolver(ctx, depth);
+    }
+
+    template <typename TChild>
+    static void addChild(ChildDispatch& dispatch)
+    {
+        if constexpr (std::is_base_of_v<IStaticSegments, TChild>)
+        {
+            dispatch.staticChilds[TChild::uriPrefix.front()].push_back(
+                &resolveChild<TChild>);
+        }
+        else if constexpr (std::is_base_of_v<IParameterizedNode, TChild>)
+        {
+            dispatch.parameterizedChilds.push_back(&resolveChild<TChild>);
+        }
+        else
+        {
+            dispatch.staticChilds[TChild::segment].push_back(
+                &resolveChild<TChild>);
+        }
+    }
+
+    static const ChildDispatch& getChildDispatch()
+    {
+        static const ChildDispatch dispatch = [] {
+            ChildDispatch dispatch;
+            (addChild<TChilds>(dispatch), ...);
+            return dispatch;
+        }();
+        return dispatch;
+    }
+
   protected:
     const std::string getOdataId() const
     {
@@ -6,6 +6,7 @@
 #include <phosphor-logging/log.hpp>
 
 #include <algorithm>
+#include <iomanip>
 
 namespace app
 {
@@ -109,7 +110,10 @@ void RedfishResponse::flash()
         prettyPrintRedfish();
         return;
     }
-    push(payload.dump(2));
+    // The payload is serialized straight into the output stream when the
+    // response is sent.
+    setBodyWriter(
+        [this](std::ostream& os) { os << std::setw(2) << this->payload; });
 }
 
 inline void dump(std::string& out, const nlohmann::json& val);
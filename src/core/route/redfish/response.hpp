@@ -70,9 +70,13 @@ class RedfishResponse : public Response
      */
     const nlohmann::json getJson() const;
     /**
-     * @brief Flash all buffered REDFISH payload to the base response buffer to
-     * obtain by next-depending consumers.
+     * @brief Flash the REDFISH payload to the base response.
      *
+     * @note  The payload is serialized straight into the output stream when
+     *        the response is sent, so the body is streamed without the
+     *        Content-Length. The payload itself is still composed as the
+     *        whole JSON document by the resource nodes, only the serialized
+     *        copy of it is not buffered. The pretty HTML output is buffered.
      */
     void flash();
 
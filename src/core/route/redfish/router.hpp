@@ -62,6 +62,28 @@ class RedfishRouter : public IRouteHandler, public IDynamicRouteHandler
     {
         return true;
     }
+    std::optional<std::string>
+        getRepresentation(const RequestPtr& request) const override
+    {
+        using namespace Fastcgipp::Http;
+        if (request->environment().requestMethod != RequestMethod::GET)
+        {
+            return std::nullopt;
+        }
+        // The URI is normalized the same way as the route lookup does, the
+        // query is kept since it might change the representation.
+        const auto& requestUri = request->environment().requestUri;
+        const auto queryPos = requestUri.find('?');
+        const auto query = queryPos == std::string::npos
+                               ? std::string()
+                               : requestUri.substr(queryPos);
+        // Each user has own cached representation, so the privileges of
+        // the user are always respected.
+        const auto& session = request->getSession();
+        return helpers::utils::toLower(request->getUriPath()) + query +
+               (request->isBrowserRequest() ? " html " : " json ") +
+               (session ? session->username : std::string());
+    }
     const ResponsePtr run(const RequestPtr& request) override
     {
         using namespace Fastcgipp::Http;
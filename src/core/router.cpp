@@ -2,6 +2,11 @@
 // SPDX-License-Identifier: Apache-2.0
 // Copyright (C) 2021 YADRO
 
+#include <config.h>
+
+#include <core/application.hpp>
+#include <core/compression.hpp>
+#include <core/entity/generation_tracker.hpp>
 #include <core/router.hpp>
 #include <nlohmann/json.hpp>
 #include <phosphor-logging/log.hpp>
@@ -17,20 +22,80 @@ namespace core
 
 using namespace phosphor::logging;
 
+namespace
+{
+
+constexpr std::size_t maxValidators = 256;
+
+std::size_t combineHash(std::size_t seed, std::size_t hash)
+{
+    return seed ^ (hash + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+}
+
+std::string formatETag(unsigned etag)
+{
+    return '"' + std::to_string(etag) + '"';
+}
+
+} // namespace
+
 Router::RouteMap Router::routerHandlers;
 Router::DynamicRouteMap Router::dynamicRouterHandlers;
+Router::Validators Router::validators(maxValidators);
+Router::ResponseCache Router::responseCache(RESPONSE_CACHE_ENTRIES);
 
 Router::Router(const RequestPtr& request) : requestObject(request)
 {}
 
-const ResponsePtr Router::process()
+unsigned Router::makeETag(const std::string& representation,
+                          const Generations& generations)
 {
+    auto digest = std::hash<std::string>{}(representation);
+    for (const auto& [entityName, generation] : generations)
+    {
+        digest = combineHash(digest, std::hash<std::string>{}(entityName));
+        digest = combineHash(digest, generation);
+    }
+    // The fastcgi++ provides the 'If-None-Match' value as the number parsed
+    // from the digits of the tag. Hence, the tag is the positive integer that
+    // survives such parsing, and zero is reserved for the absent header.
+    static constexpr std::size_t etagMask = 0x7fffffff;
+    const auto etag = static_cast<unsigned>(digest & etagMask);
+    return etag == 0 ? 1 : etag;
+}
+
+http::statuses::Code
+    Router::getUnchangedStatus(Fastcgipp::Http::RequestMethod method)
+{
+    using Fastcgipp::Http::RequestMethod;
+
+    if (method == RequestMethod::GET || method == RequestMethod::HEAD)
+    {
+        return http::statuses::Code::NotModified;
+    }
+    return http::statuses::Code::PreconditionFailed;
+}
+
+const ResponsePtr Router::process(const std::function<void()>& resume)
+{
+    using AuthStatus = app::service::authorization::AuthStatus;
+
     // Current session sharing architecture between BMCWEB and WEBAPP processes,
-    // in fact, works via filesystem synchronization. Hence, we need to re-read
-    // the config file for each new connection.
-    service::session::ConfigFile::getConfig().readData();
+    // in fact, works via filesystem synchronization. Hence, we need to reload
+    // the config files which bmcweb has changed since the last request.
+    service::session::ConfigFile::getConfig().reloadChangedData();
     const auto authResponse = std::make_shared<app::core::Response>();
-    if (!app::service::authorization::authenticate(getRequest(), authResponse))
+    const auto authStatus = app::service::authorization::authenticate(
+        getRequest(), authResponse, basicAuthVerification, resume);
+    if (authStatus == AuthStatus::pending)
+    {
+        return nullptr;
+    }
+    if (authStatus == AuthStatus::unavailable)
+    {
+        return authResponse;
+    }
+    if (authStatus != AuthStatus::authorized)
     {
         log<level::INFO>(
             "Unauthorized access registried",
@@ -45,12 +110,160 @@ const ResponsePtr Router::process()
         return authResponse;
     }
 
-    auto response = handler->run(getRequest());
+    const auto representation = handler->getRepresentation(getRequest());
+    ResponsePtr response;
+    if (representation)
+    {
+        response = runValidated(*representation);
+    }
+    else
+    {
+        response = handler->run(getRequest());
+        ResponseCompressor::getInstance().compress(getRequest(), response);
+    }
     setGeneralHeaders(response);
     log<level::DEBUG>(response->getHead().c_str());
     return response;
 }
 
+const ResponsePtr Router::runValidated(const std::string& representation)
+{
+    using namespace app::http;
+
+    auto& compressor = ResponseCompressor::getInstance();
+
+    // The content codings are different representations of the resource.
+    const auto validatedRepresentation =
+        representation + ' ' +
+        std::to_string(static_cast<int>(ResponseCompressor::negotiate(
+            getRequest()->getAcceptEncoding())));
+    const unsigned requestedETag = getRequest()->environment().etag;
+
+    const auto unchangedStatus =
+        getUnchangedStatus(getRequest()->environment().requestMethod);
+    auto notModified = [unchangedStatus](unsigned etag) {
+        auto response = std::make_shared<Response>();
+        response->setStatus(unchangedStatus);
+        response->setHeader(headers::etag, formatETag(etag));
+        ResponseCompressor::setVaryHeader(response);
+        return response;
+    };
+
+    auto validator = [&validatedRepresentation](unsigned etag) {
+        return validatedRepresentation + ' ' + std::to_string(etag);
+    };
+
+    const auto actualETag = getActualETag(validatedRepresentation);
+    if (actualETag)
+    {
+        if (*actualETag == requestedETag)
+        {
+            log<level::DEBUG>("The representation is not modified",
+                              entry("ETAG=%u", requestedETag));
+            return notModified(requestedETag);
+        }
+        // The compressed body of the actual representation is served
+        // without rendering.
+        auto response = compressor.find(getRequest(), validator(*actualETag));
+        if (response)
+        {
+            response->setHeader(headers::etag, formatETag(*actualETag));
+            return response;
+        }
+    }
+
+    if (RESPONSE_CACHE_ENTRIES > 0)
+    {
+        const auto cached = responseCache.find(validatedRepresentation);
+        if (cached && isActual(cached->generations))
+        {
+            if (cached->etag == requestedETag)
+            {
+                return notModified(cached->etag);
+            }
+            auto response = std::make_shared<Response>();
+            response->setStatus(statuses::Code::OK);
+            response->setContentType(cached->contentType);
+            response->push(*cached->body);
+            compressor.compress(getRequest(), response,
+                                validator(cached->etag));
+            response->setHeader(headers::etag, formatETag(cached->etag));
+            return response;
+        }
+    }
+
+    entity::GenerationTracker tracker;
+    auto response = handler->run(getRequest());
+
+    const auto& generations = tracker.getGenerations();
+    if (generations.empty() || response->getStatus() != statuses::Code::OK)
+    {
+        compressor.compress(getRequest(), response);
+        return response;
+    }
+    const auto etag = makeETag(validatedRepresentation, generations);
+    validators.insert(validatedRepresentation,
+                      RepresentationValidator{generations, etag});
+    if (etag == requestedETag)
+    {
+        return notModified(etag);
+    }
+
+    if (RESPONSE_CACHE_ENTRIES > 0)
+    {
+        // The cached body must outlive the response, so the streamed one is
+        // materialized once here.
+        std::ostringstream body;
+        response->writeBody(body);
+        auto cachedBody = std::make_shared<const std::string>(body.str());
+        response->clear();
+        response->push(*cachedBody);
+        responseCache.insert(
+            validatedRepresentation,
+            CachedResponse{generations, etag, response->getContentType(),
+                           std::move(cachedBody)});
+    }
+    compressor.compress(getRequest(), response, validator(etag));
+    response->setHeader(headers::etag, formatETag(etag));
+    return response;
+}
+
+std::optional<unsigned>
+    Router::getActualETag(const std::string& representation) const
+{
+    const auto validator = validators.find(representation);
+    if (!validator || !isActual(validator->generations))
+    {
+        return std::nullopt;
+    }
+    return validator->etag;
+}
+
+bool Router::isActual(const Generations& generations)
+{
+    try
+    {
+        for (const auto& [entityName, generation] : generations)
+        {
+            // Acquiring the entity actualizes its data the same way as the
+            // rendering does.
+            const auto entity =
+                application.getEntityManager().getEntity(entityName);
+            if (entity->getGeneration() != generation)
+            {
+                return false;
+            }
+        }
+    }
+    catch (const std::exception& ex)
+    {
+        log<level::DEBUG>("Fail to validate the representation",
+                          entry("ERROR=%s", ex.what()));
+        return false;
+    }
+    return true;
+}
+
 bool Router::preHandler()
 {
     if (this->handler)
@@ -93,8 +306,13 @@ void Router::setGeneralHeaders(const ResponsePtr response)
 {
     using namespace app::http;
     constexpr const char* headerDateFormat = "%a, %d %b %Y %H:%M:%S GMT";
-    response->setHeader(headers::contentLength,
-                        std::to_string(response->totalSize()));
+    // The size of the streamed body is unknown until it is written, so the
+    // web server frames such response by itself.
+    if (!response->isStreamed())
+    {
+        response->setHeader(headers::contentLength,
+                            std::to_string(response->totalSize()));
+    }
     response->setHeader(
         headers::date,
         app::helpers::utils::getFormattedCurrentDate(headerDateFormat));
@@ -3,16 +3,28 @@
 
 #pragma once
 
+#include <core/helpers/lru_cache.hpp>
 #include <core/helpers/utils.hpp>
 #include <core/request.hpp>
 #include <core/response.hpp>
 #include <phosphor-logging/log.hpp>
 
+#include <functional>
+#include <map>
 #include <memory>
+#include <optional>
 #include <string>
 
 namespace app
 {
+namespace service
+{
+namespace authorization
+{
+struct BasicAuthVerification;
+} // namespace authorization
+} // namespace service
+
 namespace core
 {
 
@@ -30,6 +42,17 @@ class IRouteHandler
   public:
     virtual const ResponsePtr run(const RequestPtr& request) = 0;
     virtual bool preHandlers(const RequestPtr& request) = 0;
+    /**
+     * @brief Get the identity of the representation which is produced from
+     *        the entities data only. Such representation is validated by the
+     *        generations of the entities it has read.
+     *
+     * @return std::optional<std::string> - the representation identity or
+     *                                      std::nullopt if the response
+     *                                      can't be validated that way
+     */
+    virtual std::optional<std::string>
+        getRepresentation(const RequestPtr& request) const = 0;
     virtual ~IRouteHandler() = default;
 };
 
@@ -63,9 +86,43 @@ class Router
 
     virtual ~Router() = default;
 
-    const ResponsePtr process();
+    /**
+     * @brief Authenticate the request and run the route handler
+     *
+     * @param resume - the callback to resume the suspended request
+     *
+     * @return const ResponsePtr - the response or nullptr if the request is
+     *                             suspended until the authentication is done
+     */
+    const ResponsePtr process(const std::function<void()>& resume);
     bool preHandler();
 
+    using Generations = std::map<std::string, std::size_t>;
+    /**
+     * @brief Derive the ETag of the representation from the generations of
+     *        the entities it has been rendered from.
+     *
+     * @param representation - the identity of the representation
+     * @param generations    - the generations of the read entities
+     *
+     * @return unsigned - the nonzero ETag value
+     */
+    static unsigned makeETag(const std::string& representation,
+                             const Generations& generations);
+    /**
+     * @brief Get the status of the response to the request which
+     *        'If-None-Match' matches the actual representation.
+     *
+     * @note  Only GET and HEAD are answered by 304, the other methods, e.g.
+     *        the GraphQL queries sent by POST, get 412 (RFC 9110, 13.1.2).
+     *
+     * @param method - the request method
+     *
+     * @return http::statuses::Code - the status of the empty response
+     */
+    static http::statuses::Code
+        getUnchangedStatus(Fastcgipp::Http::RequestMethod method);
+
     template <class THandler, typename... TArg>
     static void registerUri(const std::string pattern, TArg... args)
     {
@@ -114,15 +171,70 @@ class Router
         return requestObject;
     }
 
-    void setGeneralHeaders(const ResponsePtr);
+    /**
+     * @brief Set the headers which are common for all responses: the date
+     *        and the size of the body unless the body is streamed.
+     *
+     * @param response - the response to set the headers
+     */
+    static void setGeneralHeaders(const ResponsePtr);
 
   private:
+    /**
+     * @brief The generations of the entities which the last rendering of a
+     *        representation has read, and the ETag derived from them.
+     */
+    struct RepresentationValidator
+    {
+        Generations generations;
+        unsigned etag;
+    };
+    using Validators = helpers::LruCache<std::string, RepresentationValidator>;
+    /**
+     * @brief The rendered representation served to the other clients while
+     *        the entities it has been rendered from are not changed.
+     */
+    struct CachedResponse
+    {
+        Generations generations;
+        unsigned etag;
+        std::string contentType;
+        std::shared_ptr<const std::string> body;
+    };
+    using ResponseCache = helpers::LruCache<std::string, CachedResponse>;
+
+    /**
+     * @brief Run the handler to produce the representation validated by the
+     *        entities generations. The rendering is skipped if the client
+     *        has the actual representation already.
+     */
+    const ResponsePtr runValidated(const std::string& representation);
+    /**
+     * @brief Check whether the entities the last rendering of the
+     *        representation has read are not changed since then.
+     *
+     * @return std::optional<unsigned> - the actual ETag of the
+     *                                   representation or std::nullopt if
+     *                                   it should be rendered again
+     */
+    std::optional<unsigned>
+        getActualETag(const std::string& representation) const;
+    /**
+     * @brief Check whether the entities are not changed since the specified
+     *        generations were recorded.
+     */
+    static bool isActual(const Generations& generations);
+
     RequestPtr requestObject;
 
     static RouteMap routerHandlers;
     static DynamicRouteMap dynamicRouterHandlers;
+    static Validators validators;
+    static ResponseCache responseCache;
 
     RouteHandlerPtr handler;
+    std::shared_ptr<service::authorization::BasicAuthVerification>
+        basicAuthVerification;
 };
 
 } // namespace core
@@ -0,0 +1,301 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2022 YADRO
+
+#include "timer_wheel.hpp"
+
+#include <phosphor-logging/log.hpp>
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+
+namespace app
+{
+namespace core
+{
+
+using namespace phosphor::logging;
+
+namespace
+{
+
+constexpr std::uint64_t noEventTick = std::numeric_limits<std::uint64_t>::max();
+
+} // namespace
+
+TimerWheel::TimerWheel() noexcept :
+    epoch(Clock::now()), currentTick(0), lastTimerId(0), alive(false)
+{}
+
+TimerWheel::~TimerWheel()
+{
+    terminate();
+}
+
+void TimerWheel::run()
+{
+    std::lock_guard lock(mutex);
+    if (thread)
+    {
+        return;
+    }
+    alive = true;
+    thread = std::make_unique<std::thread>(&TimerWheel::process, this);
+}
+
+void TimerWheel::terminate() noexcept
+{
+    {
+        std::lock_guard lock(mutex);
+        alive = false;
+    }
+    wakeup.notify_all();
+    if (thread && thread->joinable())
+    {
+        thread->join();
+    }
+    thread.reset();
+
+    std::lock_guard lock(mutex);
+    for (auto& level : levels)
+    {
+        for (auto& slot : level)
+        {
+            slot.clear();
+        }
+    }
+    timers.clear();
+    debounced.clear();
+}
+
+TimerWheel::TimerId TimerWheel::schedule(Clock::duration delay,
+                                         Callback&& callback)
+{
+    TimerId timerId;
+    {
+        std::lock_guard lock(mutex);
+        timerId = ++lastTimerId;
+        place(Timer{timerId, toTick(Clock::now() + delay), std::nullopt,
+                    std::move(callback)});
+    }
+    wakeup.notify_one();
+    return timerId;
+}
+
+bool TimerWheel::cancel(TimerId timerId)
+{
+    std::lock_guard lock(mutex);
+    auto findIt = timers.find(timerId);
+    if (findIt == timers.end())
+    {
+        return false;
+    }
+    auto [slot, position] = findIt->second;
+    if (position->debounceKey)
+    {
+        debounced.erase(*position->debounceKey);
+    }
+    slot->erase(position);
+    timers.erase(findIt);
+    return true;
+}
+
+bool TimerWheel::debounce(DebounceKey key, Clock::duration window,
+                          Callback&& callback)
+{
+    {
+        std::lock_guard lock(mutex);
+        if (debounced.count(key) > 0)
+        {
+            return false;
+        }
+        auto timerId = ++lastTimerId;
+        std::optional<DebounceKey> debounceKey(key);
+        if (debounced.size() >= maxPendingDebounced)
+        {
+            log<level::WARNING>("Debounced tasks limit is reached, "
+                                "perform the task without debouncing",
+                                entry("LIMIT=%ld", maxPendingDebounced));
+            window = Clock::duration::zero();
+            debounceKey.reset();
+        }
+        else
+        {
+            debounced.emplace(key, timerId);
+        }
+        place(Timer{timerId, toTick(Clock::now() + window), debounceKey,
+                    std::move(callback)});
+    }
+    wakeup.notify_one();
+    return true;
+}
+
+std::size_t TimerWheel::DebounceKeyHash::operator()(
+    const DebounceKey& key) const noexcept
+{
+    const auto seed = key.scope.hash_code();
+    return seed ^
+           (key.value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+}
+
+void TimerWheel::process()
+{
+    std::unique_lock lock(mutex);
+    while (alive)
+    {
+        std::vector<Callback> expired;
+        advance(elapsedTicks(), expired);
+        if (!expired.empty())
+        {
+            lock.unlock();
+            for (auto& callback : expired)
+            {
+                try
+                {
+                    callback();
+                }
+                catch (const std::exception& ex)
+                {
+                    log<level::ERR>("Fail to perform the timer task",
+                                    entry("ERROR=%s", ex.what()));
+                }
+            }
+            lock.lock();
+            continue;
+        }
+
+        auto nextTick = nextEventTick();
+        if (nextTick == noEventTick)
+        {
+            wakeup.wait(lock);
+        }
+        else
+        {
+            wakeup.wait_until(lock, toTimePoint(nextTick));
+        }
+    }
+}
+
+void TimerWheel::place(Timer&& timer)
+{
+    // The overdue timers are performed on the nearest tick.
+    const auto expiryTick = std::max(timer.expiryTick, currentTick + 1);
+    auto delta = expiryTick - currentTick;
+
+    std::size_t level = 0;
+    while (level + 1 < levelsCount &&
+           delta >= (1ULL << (slotBits * (level + 1))))
+    {
+        ++level;
+    }
+    // Timers beyond the wheel range are parked at the farthest slot and
+    // re-placed when the wheel turns to it.
+    const auto maxDelta = (1ULL << (slotBits * levelsCount)) - 1;
+    const auto placeTick =
+        delta > maxDelta ? currentTick + maxDelta : expiryTick;
+
+    auto& slot = levels[level][(placeTick >> (slotBits * level)) & slotsMask];
+    const auto timerId = timer.id;
+    slot.push_back(std::move(timer));
+    timers.insert_or_assign(timerId,
+                            TimerLocation{&slot, std::prev(slot.end())});
+}
+
+void TimerWheel::advance(std::uint64_t targetTick,
+                         std::vector<Callback>& expired)
+{
+    while (currentTick < targetTick)
+    {
+        // Skip the ticks that have nothing to do.
+        currentTick = std::min(nextEventTick(), targetTick);
+
+        // Move timers down from the highest level first, so the timers
+        // cascaded from the upper level are able to reach the lowest one at
+        // the same tick.
+        for (auto level = levelsCount - 1; level > 0; --level)
+        {
+            const auto shift = slotBits * level;
+            if ((currentTick & ((1ULL << shift) - 1)) != 0)
+            {
+                continue;
+            }
+            auto& slot = levels[level][(currentTick >> shift) & slotsMask];
+            Slot cascaded;
+            cascaded.splice(cascaded.end(), slot);
+            for (auto& timer : cascaded)
+            {
+                place(std::move(timer));
+            }
+        }
+
+        auto& slot = levels[0][currentTick & slotsMask];
+        for (auto& timer : slot)
+        {
+            timers.erase(timer.id);
+            if (timer.debounceKey)
+            {
+                debounced.erase(*timer.debounceKey);
+            }
+            expired.emplace_back(std::move(timer.callback));
+        }
+        slot.clear();
+    }
+}
+
+std::uint64_t TimerWheel::nextEventTick() const
+{
+    auto nextTick = noEventTick;
+    for (std::uint64_t tick = currentTick + 1;
+         tick <= currentTick + slotsCount; ++tick)
+    {
+        if (!levels[0][tick & slotsMask].empty())
+        {
+            nextTick = tick;
+            break;
+        }
+    }
+    for (std::size_t level = 1; level < levelsCount; ++level)
+    {
+        const auto shift = slotBits * level;
+        for (std::uint64_t index = (currentTick >> shift) + 1;
+             index <= (currentTick >> shift) + slotsCount; ++index)
+        {
+            const auto boundaryTick = index << shift;
+            if (boundaryTick >= nextTick)
+            {
+                break;
+            }
+            if (!levels[level][index & slotsMask].empty())
+            {
+                nextTick = boundaryTick;
+                break;
+            }
+        }
+    }
+    return nextTick;
+}
+
+std::uint64_t TimerWheel::toTick(Clock::time_point timePoint) const
+{
+    if (timePoint <= epoch)
+    {
+        return 0;
+    }
+    // Round up to never perform a timer before its deadline.
+    return static_cast<std::uint64_t>(
+        (timePoint - epoch + tickDuration - Clock::duration(1)) /
+        tickDuration);
+}
+
+std::uint64_t TimerWheel::elapsedTicks() const
+{
+    return static_cast<std::uint64_t>((Clock::now() - epoch) / tickDuration);
+}
+
+TimerWheel::Clock::time_point TimerWheel::toTimePoint(std::uint64_t tick) const
+{
+    return epoch + tick * tickDuration;
+}
+
+} // namespace core
+} // namespace app
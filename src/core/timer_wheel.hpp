@@ -0,0 +1,177 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2022 YADRO
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+namespace app
+{
+namespace core
+{
+
+/**
+ * @class TimerWheel
+ * @brief The hierarchical timer wheel to perform deferred tasks at the exact
+ *        deadlines. Each level consists of the fixed count of slots, the
+ *        slot of a level covers the whole lower level. Timers are moved to
+ *        the lower level when the wheel turns to its slot, so scheduling and
+ *        expiring cost O(1) regardless of the count of pending timers.
+ *        The callbacks are performed by the single worker thread in the
+ *        order of deadlines.
+ */
+class TimerWheel final
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+    using Callback = std::function<void()>;
+    using TimerId = std::uint64_t;
+    /**
+     * @brief The key of the debounced task. The scope (usually the type of
+     *        the requester) isolates the keys of different requesters, so
+     *        e.g. a hash of a DBus signal never collides with a constant key.
+     */
+    struct DebounceKey
+    {
+        std::type_index scope;
+        std::size_t value;
+
+        bool operator==(const DebounceKey&) const = default;
+    };
+
+    /** @brief The resolution of timers */
+    static constexpr std::chrono::milliseconds tickDuration{10};
+    /**
+     * @brief The maximal count of pending debounced tasks. The tasks above
+     *        the limit are performed on the next tick without waiting the
+     *        debounce window, so the backlog doesn't grow with the window.
+     */
+    static constexpr std::size_t maxPendingDebounced = 1024;
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+    TimerWheel(TimerWheel&&) = delete;
+    TimerWheel& operator=(TimerWheel&&) = delete;
+
+    explicit TimerWheel() noexcept;
+    ~TimerWheel();
+
+    /**
+     * @brief Start the worker thread to perform expired timers
+     */
+    void run();
+    /**
+     * @brief Stop the worker thread. The pending timers are discarded.
+     */
+    void terminate() noexcept;
+
+    /**
+     * @brief Perform the callback after the specified delay
+     *
+     * @param delay     - the delay before the callback is performed
+     * @param callback  - the task to perform
+     *
+     * @return TimerId  - the identifier to cancel the timer
+     */
+    TimerId schedule(Clock::duration delay, Callback&& callback);
+    /**
+     * @brief Cancel the pending timer
+     *
+     * @return true  - the timer is cancelled
+     * @return false - the timer is already performed or never existed
+     */
+    bool cancel(TimerId timerId);
+    /**
+     * @brief Perform the callback after the debounce window unless a task
+     *        with the same key is already pending. The repeated requests
+     *        within the window are coalesced to the first one.
+     *
+     * @param key       - the key of the debounced task
+     * @param window    - the debounce window
+     * @param callback  - the task to perform
+     *
+     * @return true  - the task is scheduled
+     * @return false - the task with the same key is already pending
+     */
+    bool debounce(DebounceKey key, Clock::duration window,
+                  Callback&& callback);
+
+  private:
+    static constexpr std::size_t slotBits = 6;
+    static constexpr std::size_t slotsCount = 1U << slotBits;
+    static constexpr std::size_t slotsMask = slotsCount - 1;
+    static constexpr std::size_t levelsCount = 4;
+
+    struct Timer
+    {
+        TimerId id;
+        std::uint64_t expiryTick;
+        std::optional<DebounceKey> debounceKey;
+        Callback callback;
+    };
+    struct DebounceKeyHash
+    {
+        std::size_t operator()(const DebounceKey& key) const noexcept;
+    };
+    using Slot = std::list<Timer>;
+    using Level = std::array<Slot, slotsCount>;
+    struct TimerLocation
+    {
+        Slot* slot;
+        Slot::iterator position;
+    };
+
+    /**
+     * @brief Main process of the worker thread
+     */
+    void process();
+    /**
+     * @brief Put the timer to the slot of its deadline
+     */
+    void place(Timer&& timer);
+    /**
+     * @brief Turn the wheel up to the specified tick and take the expired
+     *        timers callbacks.
+     */
+    void advance(std::uint64_t targetTick, std::vector<Callback>& expired);
+    /**
+     * @brief Get the nearest tick when the wheel has something to do
+     */
+    std::uint64_t nextEventTick() const;
+    /**
+     * @brief Get the tick of the deadline rounded up to never perform a
+     *        timer before its deadline
+     */
+    std::uint64_t toTick(Clock::time_point timePoint) const;
+    /**
+     * @brief Get the count of the whole ticks passed since the wheel creation
+     */
+    std::uint64_t elapsedTicks() const;
+    Clock::time_point toTimePoint(std::uint64_t tick) const;
+
+    std::array<Level, levelsCount> levels;
+    std::unordered_map<TimerId, TimerLocation> timers;
+    std::unordered_map<DebounceKey, TimerId, DebounceKeyHash> debounced;
+    const Clock::time_point epoch;
+    std::uint64_t currentTick;
+    TimerId lastTimerId;
+    bool alive;
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    std::unique_ptr<std::thread> thread;
+};
+
+} // namespace core
+} // namespace app
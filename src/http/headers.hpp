@@ -20,6 +20,10 @@ constexpr const char* contentLength = "Content-Length";
 constexpr const char* date = "Date";
 constexpr const char* location = "Location";
 constexpr const char* wwwAuthenticate = "WWW-Authenticate";
+constexpr const char* retryAfter = "Retry-After";
+constexpr const char* contentEncoding = "Content-Encoding";
+constexpr const char* vary = "Vary";
+constexpr const char* etag = "ETag";
 } // namespace headers
 
 namespace statuses
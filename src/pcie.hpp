@@ -430,22 +430,11 @@ class PCIeDevice final :
 
     static const IEntity::IRelation::RelationRulesList& realtionToFunctions()
     {
-        using namespace std::placeholders;
         static const IEntity::IRelation::RelationRulesList relations{
             {
                 PCIeProvider::fieldSBD,
                 PCIeProvider::fieldSBD,
-                [](const IEntity::IEntityMember::InstancePtr& instance,
-                   const IEntity::IEntityMember::IInstance::FieldType& value)
-                    -> bool {
-                    const auto& destSBD = std::get<std::string>(value);
-                    log<level::DEBUG>(
-                        "Linking 'PCIDevice' and 'PCIFunction' entities",
-                        entry("FIELD=%s", PCIeProvider::fieldSBD),
-                        entry("PCIEDEV=%s", instance->getStringValue().c_str()),
-                        entry("PCIEFUN=%s", destSBD.c_str()));
-                    return instance->getStringValue() == destSBD;
-                },
+                ICondition::Equal<std::string>(),
             },
         };
         return relations;
@@ -422,29 +422,7 @@ class Sensors :
             {
                 fieldId,
                 Sensors::fieldAssociatedInventoryId,
-                [](const IEntityMember::InstancePtr& instance,
-                   const IEntityMember::IInstance::FieldType& value) -> bool {
-                    try
-                    {
-                        if (std::holds_alternative<std::string>(value) &&
-                            std::holds_alternative<std::string>(
-                                instance->getValue()))
-                        {
-                            const auto fanName = instance->getStringValue();
-                            const auto sensorInventory =
-                                std::get<std::string>(value);
-                            return fanName == sensorInventory;
-                        }
-                    }
-                    catch (std::exception& ex)
-                    {
-                        log<level::ERR>("Fail to configure relation Inventory "
-                                        "to Reading sensor",
-                                        entry("ERROR=%s", ex.what()));
-                    }
-
-                    return false;
-                },
+                ICondition::Equal<std::string>(),
             },
         };
         return relations;
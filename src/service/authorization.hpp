@@ -6,9 +6,15 @@
 #include <core/exceptions.hpp>
 #include <core/helpers/utils.hpp>
 #include <phosphor-logging/log.hpp>
+#include <service/basic_auth_cache.hpp>
 #include <service/pam_authenticate.hpp>
 #include <service/session.hpp>
 
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <optional>
+
 namespace app
 {
 namespace service
@@ -112,8 +118,31 @@ static session::UserSessionPtr
     return session;
 }
 
-static session::UserSessionPtr
-    performBasicAuth(const app::core::RequestPtr& request)
+/**
+ * @brief The state of the Basic-auth credentials verification performed by
+ *        the PAM workers. Survives between the calls of authenticate() for
+ *        the suspended request.
+ */
+struct BasicAuthVerification
+{
+    std::optional<int> pamStatus;
+    std::atomic<bool> completed{false};
+};
+
+using BasicAuthVerificationPtr = std::shared_ptr<BasicAuthVerification>;
+using ResumeCallback = std::function<void()>;
+
+enum class AuthStatus
+{
+    authorized,
+    unauthorized,
+    pending,
+    unavailable,
+};
+
+static AuthStatus performBasicAuth(const app::core::RequestPtr& request,
+                                   BasicAuthVerificationPtr& verification,
+                                   const ResumeCallback& resume)
 {
     log<level::DEBUG>("[AuthMiddleware] Basic authentication");
 
@@ -126,43 +155,101 @@ static session::UserSessionPtr
     }
     catch (...)
     {
-        return nullptr;
+        return AuthStatus::unauthorized;
     }
     std::size_t separator = authData.find(':');
     if (separator == std::string::npos)
     {
-        return nullptr;
+        return AuthStatus::unauthorized;
     }
 
     std::string user = authData.substr(0, separator);
     separator += 1;
     if (separator > authData.size())
     {
-        return nullptr;
+        return AuthStatus::unauthorized;
     }
     std::string pass = authData.substr(separator);
 
-    log<level::DEBUG>("[AuthMiddleware] Authenticating...",
-                      entry("USER=%s", user.c_str()),
-                      entry("DEST_IP=%s", request->getClientIp().c_str()));
+    auto& basicAuthCache = BasicAuthCache::getInstance();
+    if (!verification)
+    {
+        if (auto session = basicAuthCache.find(user, pass))
+        {
+            log<level::DEBUG>(
+                "[AuthMiddleware] Credentials are already verified",
+                entry("USER=%s", user.c_str()));
+            request->setSession(session);
+            return AuthStatus::authorized;
+        }
+
+        log<level::DEBUG>("[AuthMiddleware] Authenticating...",
+                          entry("USER=%s", user.c_str()),
+                          entry("DEST_IP=%s", request->getClientIp().c_str()));
+
+        // The PAM conversation might take a while, so the request is
+        // suspended until the PAM worker completes it.
+        verification = std::make_shared<BasicAuthVerification>();
+        auto completion = [verification, resume](std::optional<int> pamStatus) {
+            verification->pamStatus = pamStatus;
+            verification->completed.store(true, std::memory_order_release);
+            resume();
+        };
+        if (!basicAuthCache.await(user, pass, std::move(completion)))
+        {
+            // The same credentials are already being verified.
+            return AuthStatus::pending;
+        }
+        auto verified = [user, pass](std::optional<int> pamStatus) {
+            BasicAuthCache::getInstance().complete(user, pass, pamStatus);
+        };
+        if (!PamWorkerPool::getInstance().submit(user, pass,
+                                                 std::move(verified)))
+        {
+            // The waiters are resumed to report the unavailability.
+            basicAuthCache.complete(user, pass, std::nullopt);
+        }
+        return AuthStatus::pending;
+    }
+
+    if (!verification->completed.load(std::memory_order_acquire))
+    {
+        return AuthStatus::pending;
+    }
+    const auto pamStatus = verification->pamStatus;
+    verification.reset();
+    if (!pamStatus)
+    {
+        return AuthStatus::unavailable;
+    }
 
-    int pamrc = pamAuthenticateUser(user, pass);
+    int pamrc = *pamStatus;
     bool isConfigureSelfOnly = pamrc == PAM_NEW_AUTHTOK_REQD;
     if ((pamrc != PAM_SUCCESS) && !isConfigureSelfOnly)
     {
-        return nullptr;
+        return AuthStatus::unauthorized;
     }
 
-    // TODO(ed) generateUserSession is a little expensive for basic
-    // auth, as it generates some random identifiers that will never be
-    // used.  This should have a "fast" path for when user tokens aren't
-    // needed.
-    // This whole flow needs to be revisited anyway, as we can't be
-    // calling directly into pam for every request
-    auto session = session::SessionStore::getInstance().newBasicAuthSession(
-        user, isConfigureSelfOnly, request->getClientIp());
+    // The concurrent requests share the verification, so the session might
+    // be already created by another one.
+    auto session = basicAuthCache.find(user, pass);
+    if (session == nullptr)
+    {
+        // TODO(ed) generateUserSession is a little expensive for basic
+        // auth, as it generates some random identifiers that will never be
+        // used.  This should have a "fast" path for when user tokens aren't
+        // needed.
+        session = session::SessionStore::getInstance().newBasicAuthSession(
+            user, isConfigureSelfOnly, request->getClientIp());
+        if (session == nullptr)
+        {
+            return AuthStatus::unauthorized;
+        }
+        basicAuthCache.store(user, pass, session);
+    }
+    request->setSession(session);
 
-    return session;
+    return AuthStatus::authorized;
 }
 
 // checks if request can be forwarded without authentication
@@ -198,12 +285,29 @@ inline bool isOnWhitelist(const app::core::RequestPtr& req)
     return isOnWhitelist;
 }
 
-static bool authenticate(const app::core::RequestPtr& request,
-                         const app::core::ResponsePtr& response)
+/**
+ * @brief Authenticate the request by any of the configured methods
+ *
+ * @param request       - the request to authenticate
+ * @param response      - the response to fill in if authentication fails
+ * @param verification  - the state of the pending Basic-auth verification
+ * @param resume        - the callback to resume the suspended request
+ *
+ * @return AuthStatus - the authentication result. The 'pending' status means
+ *                      that the request should be suspended until the resume
+ *                      callback is called, and authenticated again then.
+ */
+static AuthStatus authenticate(const app::core::RequestPtr& request,
+                               const app::core::ResponsePtr& response,
+                               BasicAuthVerificationPtr& verification,
+                               const ResumeCallback& resume)
 {
+    using Code = app::http::statuses::Code;
+    using namespace app::http::headers;
+
     if (isOnWhitelist(request))
     {
-        return true;
+        return AuthStatus::authorized;
     }
 
     const session::AuthConfigMethods& authMethodsConfig =
@@ -231,16 +335,28 @@ static bool authenticate(const app::core::RequestPtr& request,
             else if (authHeader.starts_with(authBasic) &&
                      authMethodsConfig.basic)
             {
-                request->setSession(performBasicAuth(request));
+                const auto status =
+                    performBasicAuth(request, verification, resume);
+                if (status == AuthStatus::pending)
+                {
+                    return status;
+                }
+                if (status == AuthStatus::unavailable)
+                {
+                    static constexpr const char* retryAfterSeconds = "1";
+
+                    log<level::WARNING>(
+                        "[AuthMiddleware] authentication is unavailable");
+                    response->setStatus(Code::ServiceUnavailable);
+                    response->setHeader(retryAfter, retryAfterSeconds);
+                    return status;
+                }
             }
         }
     }
 
     if (request->isSessionEmpty())
     {
-        using Code = app::http::statuses::Code;
-        using namespace app::http::headers;
-
         log<level::WARNING>("[AuthMiddleware] authorization failed");
 
         if (request->isBrowserRequest())
@@ -253,7 +369,7 @@ static bool authenticate(const app::core::RequestPtr& request,
             response->setHeader(location, loginPathNext +
                                               urlEncode(request->getUriPath()));
 
-            return false;
+            return AuthStatus::unauthorized;
         }
 
         response->setStatus(Code::Unauthorized);
@@ -264,14 +380,10 @@ static bool authenticate(const app::core::RequestPtr& request,
             response->setHeader(wwwAuthenticate, authBasic);
         }
 
-        return false;
+        return AuthStatus::unauthorized;
     }
 
-    if (!request->isSessionEmpty())
-    {
-        session::ConfigFile::getConfig().commit();
-    }
-    return !request->isSessionEmpty();
+    return AuthStatus::authorized;
 }
 
 } // namespace authorization
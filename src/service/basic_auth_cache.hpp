@@ -0,0 +1,352 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2022 YADRO
+
+#pragma once
+
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/rand.h>
+#include <security/pam_appl.h>
+
+#include <accounts.hpp>
+#include <phosphor-logging/log.hpp>
+#include <service/session.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+namespace app
+{
+namespace service
+{
+namespace authorization
+{
+
+using namespace phosphor::logging;
+
+/**
+ * @class BasicAuthCache
+ * @brief The cache of the successful Basic-auth credentials verifications to
+ *        avoid the PAM conversation for each request. The entries are keyed by
+ *        HMAC of the credentials with the random per-process key, so the
+ *        plain passwords are never stored. Each principal reuses the single
+ *        session while its entry is alive. The whole cache is dropped when
+ *        the Accounts entity or the shadow file is changed, and the entries
+ *        of the principal are dropped when PAM rejects its credentials.
+ *        The concurrent misses of the same credentials share the single PAM
+ *        conversation.
+ */
+class BasicAuthCache final
+{
+    static constexpr std::chrono::seconds entryLifetime{10};
+    static constexpr std::size_t keySize = 32;
+    static constexpr const char* shadowFilePath = "/etc/shadow";
+
+    struct Entry
+    {
+        std::string username;
+        session::UserSessionPtr session;
+        std::chrono::steady_clock::time_point expiresAt;
+    };
+
+  public:
+    static constexpr std::size_t maxEntries = 64;
+
+    /** @brief The getter of the Accounts entity generation */
+    using AccountsGeneration = std::function<std::size_t()>;
+    /** @brief The handler of the PAM verification result */
+    using Completion = std::function<void(std::optional<int>)>;
+
+    /**
+     * @brief Create the cache
+     *
+     * @param lifetime              - the lifetime of the verified credentials
+     * @param shadowFile            - the file of the passwords hashes
+     * @param accountsGeneration    - the getter of the Accounts generation
+     */
+    explicit BasicAuthCache(std::chrono::steady_clock::duration lifetime,
+                            const std::string& shadowFile,
+                            AccountsGeneration&& accountsGeneration) :
+        lifetime(lifetime),
+        shadowFile(shadowFile),
+        accountsGeneration(std::move(accountsGeneration)), enabled(true),
+        lastAccountsGeneration(0)
+    {
+        if (RAND_bytes(key.data(), key.size()) != 1)
+        {
+            log<level::ERR>("Fail to generate the key of Basic-auth cache, "
+                            "the cache is disabled");
+            enabled = false;
+        }
+    }
+
+    BasicAuthCache(const BasicAuthCache&) = delete;
+    BasicAuthCache& operator=(const BasicAuthCache&) = delete;
+    BasicAuthCache(BasicAuthCache&&) = delete;
+    BasicAuthCache& operator=(BasicAuthCache&&) = delete;
+
+    ~BasicAuthCache() = default;
+
+    /**
+     * @brief Find the session of the verified credentials
+     *
+     * @return session::UserSessionPtr - the session or nullptr if the
+     *                                   credentials should be verified by PAM
+     */
+    session::UserSessionPtr find(const std::string& username,
+                                 const std::string& password)
+    {
+        std::lock_guard lock(mutex);
+        if (!enabled)
+        {
+            return nullptr;
+        }
+        invalidateOnChanged();
+
+        auto entryIt = entries.find(getDigest(username, password));
+        if (entryIt == entries.end())
+        {
+            return nullptr;
+        }
+        const auto now = std::chrono::steady_clock::now();
+        if (entryIt->second.expiresAt <= now)
+        {
+            release(entryIt->second);
+            entries.erase(entryIt);
+            return nullptr;
+        }
+        entryIt->second.session->lastUpdated = now;
+        return entryIt->second.session;
+    }
+
+    /**
+     * @brief Remember the credentials verified by PAM and the session created
+     *        for them.
+     */
+    void store(const std::string& username, const std::string& password,
+               const session::UserSessionPtr& session)
+    {
+        std::lock_guard lock(mutex);
+        if (!enabled)
+        {
+            return;
+        }
+        // The entry must not be dropped by the changes made before it.
+        invalidateOnChanged();
+
+        // Keep the single session per principal.
+        forgetUnsafe(username);
+        if (entries.size() >= maxEntries)
+        {
+            auto oldestIt = std::min_element(
+                entries.begin(), entries.end(),
+                [](const auto& left, const auto& right) {
+                    return left.second.expiresAt < right.second.expiresAt;
+                });
+            release(oldestIt->second);
+            entries.erase(oldestIt);
+        }
+
+        entries.insert_or_assign(
+            getDigest(username, password),
+            Entry{username, session,
+                  std::chrono::steady_clock::now() + lifetime});
+    }
+
+    /**
+     * @brief Wait for the PAM verification of the credentials. The first
+     *        miss of the credentials has to verify them and report the
+     *        result by `complete()`, the concurrent misses are completed
+     *        with the same result.
+     *
+     * @return true  - the caller has to verify the credentials
+     * @return false - the credentials are already being verified
+     */
+    bool await(const std::string& username, const std::string& password,
+               Completion&& completion)
+    {
+        std::lock_guard lock(mutex);
+        auto& completions = verifications[getDigest(username, password)];
+        completions.emplace_back(std::move(completion));
+        return completions.size() == 1;
+    }
+
+    /**
+     * @brief Complete all waiters of the credentials verification. The
+     *        entries of the principal are dropped if PAM rejects the
+     *        credentials.
+     *
+     * @param pamStatus - the PAM result code, or std::nullopt if the
+     *                    credentials aren't verified
+     */
+    void complete(const std::string& username, const std::string& password,
+                  std::optional<int> pamStatus)
+    {
+        std::vector<Completion> completions;
+        {
+            std::lock_guard lock(mutex);
+            auto verificationIt =
+                verifications.find(getDigest(username, password));
+            if (verificationIt != verifications.end())
+            {
+                completions = std::move(verificationIt->second);
+                verifications.erase(verificationIt);
+            }
+            if (pamStatus && *pamStatus != PAM_SUCCESS &&
+                *pamStatus != PAM_NEW_AUTHTOK_REQD)
+            {
+                forgetUnsafe(username);
+            }
+        }
+        for (const auto& completion : completions)
+        {
+            completion(pamStatus);
+        }
+    }
+
+    /**
+     * @brief Drop all verified credentials
+     */
+    void invalidate()
+    {
+        std::lock_guard lock(mutex);
+        invalidateUnsafe();
+    }
+
+    static BasicAuthCache& getInstance()
+    {
+        static BasicAuthCache basicAuthCache(
+            entryLifetime, shadowFilePath,
+            [accounts = app::entity::EntityPtr()]() mutable {
+                if (!accounts)
+                {
+                    accounts = app::obmc::entity::Accounts::getEntity();
+                }
+                return accounts->getGeneration();
+            });
+        return basicAuthCache;
+    }
+
+  private:
+    std::string getDigest(const std::string& username,
+                          const std::string& password) const
+    {
+        // The username length prefix keeps the credentials unambiguous
+        // whatever characters the username and the password contain.
+        const std::string credentials =
+            std::to_string(username.size()) + ':' + username + password;
+        std::array<unsigned char, EVP_MAX_MD_SIZE> digest;
+        unsigned int digestSize = 0;
+        HMAC(EVP_sha256(), key.data(), static_cast<int>(key.size()),
+             reinterpret_cast<const unsigned char*>(credentials.data()),
+             credentials.size(), digest.data(), &digestSize);
+        return std::string(reinterpret_cast<const char*>(digest.data()),
+                           digestSize);
+    }
+
+    void invalidateOnChanged()
+    {
+        invalidateOnAccountsChanged();
+        invalidateOnShadowChanged();
+    }
+
+    void invalidateOnAccountsChanged()
+    {
+        try
+        {
+            const auto generation = accountsGeneration();
+            if (generation != lastAccountsGeneration)
+            {
+                log<level::DEBUG>("Accounts are changed, drop the "
+                                  "Basic-auth cache");
+                lastAccountsGeneration = generation;
+                invalidateUnsafe();
+            }
+        }
+        catch (const std::exception& ex)
+        {
+            // Can't track the accounts changes, so never trust the cache.
+            log<level::DEBUG>("Fail to check the accounts changes",
+                              entry("ERROR=%s", ex.what()));
+            invalidateUnsafe();
+        }
+    }
+
+    void invalidateOnShadowChanged()
+    {
+        // The password might be changed bypassing the Accounts, e.g. by
+        // passwd in the shell.
+        std::error_code error;
+        const auto modified =
+            std::filesystem::last_write_time(shadowFile, error);
+        if (error)
+        {
+            // Can't track the passwords changes, so never trust the cache.
+            invalidateUnsafe();
+            return;
+        }
+        if (shadowModified != modified)
+        {
+            log<level::DEBUG>("Shadow file is changed, drop the "
+                              "Basic-auth cache");
+            shadowModified = modified;
+            invalidateUnsafe();
+        }
+    }
+
+    void forgetUnsafe(const std::string& username)
+    {
+        for (auto entryIt = entries.begin(); entryIt != entries.end();)
+        {
+            if (entryIt->second.username == username)
+            {
+                release(entryIt->second);
+                entryIt = entries.erase(entryIt);
+                continue;
+            }
+            ++entryIt;
+        }
+    }
+
+    void invalidateUnsafe()
+    {
+        for (auto& [_, entry] : entries)
+        {
+            release(entry);
+        }
+        entries.clear();
+    }
+
+    static void release(const Entry& entry)
+    {
+        // The entries are released under the cache lock, so the file writing
+        // is deferred to not block the authorization of other requests.
+        session::SessionStore::getInstance().removeSessionDeferred(
+            entry.session);
+    }
+
+    const std::chrono::steady_clock::duration lifetime;
+    const std::string shadowFile;
+    AccountsGeneration accountsGeneration;
+    std::unordered_map<std::string, Entry> entries;
+    /** The waiters of the verifications in progress by the credentials */
+    std::unordered_map<std::string, std::vector<Completion>> verifications;
+    std::array<unsigned char, keySize> key;
+    bool enabled;
+    std::size_t lastAccountsGeneration;
+    std::optional<std::filesystem::file_time_type> shadowModified;
+    std::mutex mutex;
+};
+
+} // namespace authorization
+} // namespace service
+} // namespace app
@@ -5,8 +5,19 @@
 
 #include <security/pam_appl.h>
 
+#include <phosphor-logging/log.hpp>
+
+#include <chrono>
+#include <condition_variable>
 #include <cstring>
+#include <deque>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
 
 // function used to get user input
 inline int pamFunctionConversation(int numMsg, const struct pam_message** msg,
@@ -115,3 +126,158 @@ inline int pamUpdatePassword(const std::string& username,
 
     return pam_end(localAuthHandle, PAM_SUCCESS);
 }
+
+namespace app
+{
+namespace service
+{
+namespace authorization
+{
+
+/**
+ * @class PamWorkerPool
+ * @brief The fixed-size pool of threads to perform the PAM credentials
+ *        verification out of the FastCGI request threads. A slow PAM
+ *        conversation (e.g. LDAP-backed accounts) holds the pool worker only,
+ *        so the already authenticated clients are never blocked by the logins.
+ *        The queue is bounded, and the jobs waiting longer than the deadline
+ *        are rejected without calling PAM.
+ */
+class PamWorkerPool final
+{
+    static constexpr std::size_t workersCount = 2;
+    static constexpr std::size_t maxQueuedJobs = 16;
+    static constexpr std::chrono::seconds queueDeadline{10};
+
+  public:
+    /**
+     * @brief The verification completion handler. Called from the pool worker
+     *        with the PAM result code, or with std::nullopt if the job missed
+     *        its deadline.
+     */
+    using Completion = std::function<void(std::optional<int>)>;
+
+    PamWorkerPool(const PamWorkerPool&) = delete;
+    PamWorkerPool& operator=(const PamWorkerPool&) = delete;
+    PamWorkerPool(PamWorkerPool&&) = delete;
+    PamWorkerPool& operator=(PamWorkerPool&&) = delete;
+
+    ~PamWorkerPool()
+    {
+        {
+            std::lock_guard lock(mutex);
+            alive = false;
+        }
+        wakeup.notify_all();
+        for (auto& worker : workers)
+        {
+            if (worker.joinable())
+            {
+                worker.join();
+            }
+        }
+    }
+
+    /**
+     * @brief Queue the credentials verification
+     *
+     * @param username   - the account name
+     * @param password   - the account password
+     * @param completion - the handler of the verification result
+     *
+     * @return bool - false if the pool is saturated and the job is rejected
+     */
+    bool submit(std::string username, std::string password,
+                Completion&& completion)
+    {
+        using namespace phosphor::logging;
+        {
+            std::lock_guard lock(mutex);
+            if (jobs.size() >= maxQueuedJobs)
+            {
+                log<level::WARNING>("PAM workers are saturated, reject the "
+                                    "authentication",
+                                    entry("QUEUED=%ld", jobs.size()));
+                return false;
+            }
+            jobs.push_back(Job{std::move(username), std::move(password),
+                               std::chrono::steady_clock::now() +
+                                   queueDeadline,
+                               std::move(completion)});
+        }
+        wakeup.notify_one();
+        return true;
+    }
+
+    static PamWorkerPool& getInstance()
+    {
+        static PamWorkerPool pamWorkerPool;
+        return pamWorkerPool;
+    }
+
+  private:
+    struct Job
+    {
+        std::string username;
+        std::string password;
+        std::chrono::steady_clock::time_point deadline;
+        Completion completion;
+    };
+
+    PamWorkerPool() : alive(true)
+    {
+        workers.reserve(workersCount);
+        for (std::size_t index = 0; index < workersCount; ++index)
+        {
+            workers.emplace_back(&PamWorkerPool::process, this);
+        }
+    }
+
+    void process()
+    {
+        using namespace phosphor::logging;
+        std::unique_lock lock(mutex);
+        while (true)
+        {
+            wakeup.wait(lock, [this] { return !alive || !jobs.empty(); });
+            if (!alive)
+            {
+                break;
+            }
+            auto job = std::move(jobs.front());
+            jobs.pop_front();
+            lock.unlock();
+
+            std::optional<int> pamStatus;
+            if (std::chrono::steady_clock::now() < job.deadline)
+            {
+                pamStatus = pamAuthenticateUser(job.username, job.password);
+            }
+            else
+            {
+                log<level::WARNING>("PAM authentication deadline is missed",
+                                    entry("USER=%s", job.username.c_str()));
+            }
+            try
+            {
+                job.completion(pamStatus);
+            }
+            catch (const std::exception& ex)
+            {
+                log<level::ERR>("Fail to complete the PAM authentication",
+                                entry("ERROR=%s", ex.what()));
+            }
+            lock.lock();
+        }
+    }
+
+    std::deque<Job> jobs;
+    std::vector<std::thread> workers;
+    bool alive;
+    std::mutex mutex;
+    std::condition_variable wakeup;
+};
+
+} // namespace authorization
+} // namespace service
+} // namespace app
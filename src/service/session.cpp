@@ -1,8 +1,13 @@
 // SPDX-License-Identifier: Apache-2.0
 // Copyright (C) 2021 YADRO
 
+#include <fcntl.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <uuid/uuid.h>
 
+#include <core/application.hpp>
 #include <core/exceptions.hpp>
 #include <core/helpers/utils.hpp>
 #include <nlohmann/json.hpp>
@@ -10,9 +15,14 @@
 #include <service/session.hpp>
 #include <session_manager.hpp>
 
+#include <array>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <string_view>
 
 namespace app
@@ -22,9 +32,6 @@ namespace service
 namespace session
 {
 
-using ConfigFileStorage = std::pair<ConfigFilePath, ConfigFileName>;
-using ConfigDict = std::map<configFileStorageType, ConfigFileStorage>;
-
 const UserSessionPtr UserSession::fromJson(const nlohmann::json& j)
 {
     const auto userSession = std::make_shared<UserSession>();
@@ -165,18 +172,21 @@ const UserSessionPtr SessionStore::generateUserSession(
             return nullptr;
         }
     }
-    auto session = std::make_shared<UserSession>(
-        UserSession{uniqueId, sessionToken, std::string(username), csrfToken,
-                    std::string(clientId), std::string(clientIp),
-                    std::chrono::steady_clock::now(), persistence, false,
-                    isConfigureSelfOnly, storageType});
-    auto it = storeAuthToken(sessionToken, session);
-    return it->second;
-}
-
-SessionStore::AuthTokenDict::iterator
-    SessionStore::storeAuthToken(const std::string& token,
-                                 UserSessionPtr session)
+    auto session = std::make_shared<UserSession>();
+    session->uniqueId = uniqueId;
+    session->sessionToken = sessionToken;
+    session->username = std::string(username);
+    session->csrfToken = csrfToken;
+    session->clientId = std::string(clientId);
+    session->clientIp = std::string(clientIp);
+    session->lastUpdated = std::chrono::steady_clock::now();
+    session->persistence = persistence;
+    session->isConfigureSelfOnly = isConfigureSelfOnly;
+    session->storageType = storageType;
+    return storeAuthToken(session);
+}
+
+const UserSessionPtr SessionStore::storeAuthToken(UserSessionPtr session)
 {
     static const std::map<SessionManager::SessionType,
                           std::vector<configFileStorageType>>
@@ -195,7 +205,8 @@ SessionStore::AuthTokenDict::iterator
                 },
             },
         };
-    auto statusPair = authTokens.emplace(token, session);
+    const auto storedSession = insert(session);
+    const bool isInserted = storedSession == session;
     for (const auto& [sessionType, storeType] : sessTypeFromStorageType)
     {
         if (std::any_of(storeType.begin(), storeType.end(),
@@ -203,7 +214,7 @@ SessionStore::AuthTokenDict::iterator
                             return session->storageType == type;
                         }))
         {
-            if (statusPair.second)
+            if (isInserted)
             {
                 // if (SessionManager::create(
                 //         session->username, session->clientIp,
@@ -216,8 +227,12 @@ SessionStore::AuthTokenDict::iterator
             break;
         }
     }
-    ConfigFile::getConfig().commit();
-    return statusPair.first;
+    // The single-request sessions are never persisted.
+    if (session->persistence != PersistenceType::SINGLE_REQUEST)
+    {
+        ConfigFile::getConfig().commit();
+    }
+    return storedSession;
 }
 
 void SessionStore::removeSession(const UserSessionPtr& session)
@@ -227,10 +242,45 @@ void SessionStore::removeSession(const UserSessionPtr& session)
     //     BMCWEB_LOG_ERROR
     //         << "Can't close session that is managed by SessionManager";
     // }
-    authTokens.erase(session->sessionToken);
+    erase(session);
     ConfigFile::getConfig().commit();
 }
 
+void SessionStore::removeSessionDeferred(const UserSessionPtr& session)
+{
+    erase(session);
+    // The single-request sessions are never persisted.
+    if (session->persistence != PersistenceType::SINGLE_REQUEST)
+    {
+        ConfigFile::getConfig().scheduleCommit();
+    }
+}
+
+void SessionStore::retainSessions(const configFileStorageType storageType,
+                                  const std::set<std::string>& sessionTokens)
+{
+    std::vector<UserSessionPtr> closedSessions;
+    for (const auto& shard : shards)
+    {
+        std::shared_lock lock(shard.mutex);
+        for (const auto& [_, session] : shard.sessions)
+        {
+            if (session->persistence == PersistenceType::TIMEOUT &&
+                session->storageType == storageType &&
+                sessionTokens.count(session->sessionToken) == 0)
+            {
+                closedSessions.push_back(session);
+            }
+        }
+    }
+    for (const auto& session : closedSessions)
+    {
+        log<level::DEBUG>("Remove the session closed outside",
+                          entry("SESSION_ID=%s", session->uniqueId.c_str()));
+        erase(session);
+    }
+}
+
 const UserSessionPtr
     SessionStore::newBasicAuthSession(const std::string_view username,
                                       bool isConfigureSelfOnly,
@@ -262,13 +312,17 @@ const UserSessionPtr
         log<level::DEBUG>("Invalid token size");
         return nullptr;
     }
-    auto sessionIt = authTokens.find(std::string(token));
-    if (sessionIt == authTokens.end())
+    const std::string sessionToken(token);
+    const auto& shard = getShard(sessionToken);
+    std::shared_lock lock(shard.mutex);
+    auto sessionIt = shard.sessions.find(sessionToken);
+    if (sessionIt == shard.sessions.end())
     {
         log<level::DEBUG>("Token not found");
         return nullptr;
     }
     UserSessionPtr userSession = sessionIt->second;
+    // The expiry queue catches up the access time lazily.
     userSession->lastUpdated = std::chrono::steady_clock::now();
     return userSession;
 }
@@ -276,31 +330,28 @@ const UserSessionPtr
 const UserSessionPtr SessionStore::getSessionByUid(const std::string_view uid)
 {
     applySessionTimeouts();
-    // TODO(Ed) this is inefficient
-    auto sessionIt = authTokens.begin();
-    while (sessionIt != authTokens.end())
+    std::shared_lock lock(sessionsByUidMutex);
+    auto sessionIt = sessionsByUid.find(std::string(uid));
+    if (sessionIt == sessionsByUid.end())
     {
-        if (sessionIt->second->uniqueId == uid)
-        {
-            return sessionIt->second;
-        }
-        sessionIt++;
+        return nullptr;
     }
-    return nullptr;
+    return sessionIt->second;
 }
 
-std::vector<const std::string*>
+std::vector<std::string>
     SessionStore::getUniqueIds(bool getAll, const PersistenceType& type)
 {
     applySessionTimeouts();
 
-    std::vector<const std::string*> ret;
-    ret.reserve(authTokens.size());
-    for (auto& session : authTokens)
+    std::vector<std::string> ret;
+    std::shared_lock lock(sessionsByUidMutex);
+    ret.reserve(sessionsByUid.size());
+    for (const auto& [uniqueId, session] : sessionsByUid)
     {
-        if (getAll || type == session.second->persistence)
+        if (getAll || type == session->persistence)
         {
-            ret.push_back(&session.second->uniqueId);
+            ret.push_back(uniqueId);
         }
     }
     return ret;
@@ -321,6 +372,7 @@ void SessionStore::updateAuthMethodsConfig(const AuthConfigMethods& config)
 void SessionStore::updateSessionTimeout(
     std::chrono::seconds newTimeoutInSeconds)
 {
+    std::lock_guard lock(expiryMutex);
     timeoutInSeconds = newTimeoutInSeconds;
 }
 
@@ -331,6 +383,7 @@ AuthConfigMethods& SessionStore::getAuthMethodsConfig()
 
 int64_t SessionStore::getTimeoutInSeconds() const
 {
+    std::lock_guard lock(expiryMutex);
     return std::chrono::seconds(timeoutInSeconds).count();
 }
 
@@ -340,38 +393,124 @@ SessionStore& SessionStore::getInstance()
     return sessionStore;
 }
 
-const SessionStore::AuthTokenDict& SessionStore::getAuthTokenDict() const
+std::vector<UserSessionPtr> SessionStore::getSessions() const
 {
-    return authTokens;
+    std::vector<UserSessionPtr> sessions;
+    for (const auto& shard : shards)
+    {
+        std::shared_lock lock(shard.mutex);
+        for (const auto& [_, session] : shard.sessions)
+        {
+            sessions.push_back(session);
+        }
+    }
+    return sessions;
 }
 
 void SessionStore::restore(const UserSessionPtr& session)
 {
-    log<level::DEBUG>("Restored session",
-                      entry("SESSION_ID=%s", session->uniqueId.c_str()));
-    authTokens.emplace(session->sessionToken, session);
+    if (insert(session) == session)
+    {
+        log<level::DEBUG>("Restored session",
+                          entry("SESSION_ID=%s", session->uniqueId.c_str()));
+    }
 }
 
 void SessionStore::applySessionTimeouts()
 {
-    auto timeNow = std::chrono::steady_clock::now();
-    if (timeNow - lastTimeoutUpdate > std::chrono::seconds(1))
+    // Another request is already expiring the sessions, don't wait for it.
+    std::unique_lock lock(expiryMutex, std::try_to_lock);
+    if (!lock.owns_lock())
+    {
+        return;
+    }
+
+    const auto timeNow = std::chrono::steady_clock::now();
+    // The queue is ordered by the access time known at the insertion, the
+    // real one might be only later. So, if the top is not expired then
+    // nothing is, otherwise the top is re-queued with the real access time.
+    while (!expiryQueue.empty() &&
+           timeNow - expiryQueue.top().lastUpdated >= timeoutInSeconds)
     {
-        lastTimeoutUpdate = timeNow;
-        auto authTokensIt = authTokens.begin();
-        while (authTokensIt != authTokens.end())
+        const auto sessionToken = expiryQueue.top().sessionToken;
+        expiryQueue.pop();
+
+        UserSessionPtr session;
         {
-            if (timeNow - authTokensIt->second->lastUpdated >= timeoutInSeconds)
+            const auto& shard = getShard(sessionToken);
+            std::shared_lock shardLock(shard.mutex);
+            auto sessionIt = shard.sessions.find(sessionToken);
+            if (sessionIt == shard.sessions.end())
             {
-                authTokensIt = authTokens.erase(authTokensIt);
-            }
-            else
-            {
-                authTokensIt++;
+                // The session is already removed.
+                continue;
             }
+            session = sessionIt->second;
         }
+
+        const auto lastUpdated = session->lastUpdated.load();
+        if (timeNow - lastUpdated < timeoutInSeconds)
+        {
+            expiryQueue.push(ExpiryEntry{lastUpdated, sessionToken});
+            continue;
+        }
+        log<level::DEBUG>("Session is expired",
+                          entry("SESSION_ID=%s", session->uniqueId.c_str()));
+        erase(session);
     }
 }
+
+SessionStore::Shard& SessionStore::getShard(const std::string& token)
+{
+    return shards[std::hash<std::string>{}(token) % shardsCount];
+}
+
+const SessionStore::Shard&
+    SessionStore::getShard(const std::string& token) const
+{
+    return shards[std::hash<std::string>{}(token) % shardsCount];
+}
+
+const UserSessionPtr SessionStore::insert(const UserSessionPtr& session)
+{
+    {
+        auto& shard = getShard(session->sessionToken);
+        std::unique_lock lock(shard.mutex);
+        auto [sessionIt, isInserted] =
+            shard.sessions.emplace(session->sessionToken, session);
+        if (!isInserted)
+        {
+            return sessionIt->second;
+        }
+    }
+    {
+        std::unique_lock lock(sessionsByUidMutex);
+        sessionsByUid.insert_or_assign(session->uniqueId, session);
+    }
+    {
+        std::lock_guard lock(expiryMutex);
+        expiryQueue.push(
+            ExpiryEntry{session->lastUpdated.load(), session->sessionToken});
+    }
+    return session;
+}
+
+void SessionStore::erase(const UserSessionPtr& session)
+{
+    {
+        auto& shard = getShard(session->sessionToken);
+        std::unique_lock lock(shard.mutex);
+        shard.sessions.erase(session->sessionToken);
+    }
+    std::unique_lock lock(sessionsByUidMutex);
+    auto sessionIt = sessionsByUid.find(session->uniqueId);
+    if (sessionIt != sessionsByUid.end() && sessionIt->second == session)
+    {
+        sessionsByUid.erase(sessionIt);
+    }
+    // The expiry record is dropped lazily when it reaches the queue top.
+}
+
 /**
  * Configuration file storage metadata depending on storage type.
  * @note The file sorage names origins from bmcweb implementation to save logic
@@ -394,8 +533,12 @@ static const ConfigDict configFilePathDict{
        stored in a 'heap' */
 };
 
-ConfigFile::ConfigFile()
+ConfigFile::ConfigFile() : ConfigFile(configFilePathDict)
+{}
+
+ConfigFile::ConfigFile(const ConfigDict& storages) : storages(storages)
 {
+    initWatcher();
     readData();
 }
 
@@ -403,26 +546,132 @@ ConfigFile::~ConfigFile()
 {
     // Make sure we aren't writing stale sessions
     SessionStore::getInstance().applySessionTimeouts();
+    if (commitPending)
+    {
+        commit();
+    }
+    if (inotifyFd >= 0)
+    {
+        close(inotifyFd);
+    }
+}
+
+void ConfigFile::initWatcher()
+{
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd < 0)
+    {
+        log<level::ERR>("Fail to watch the configuration files, "
+                        "fallback to re-read them for each request",
+                        entry("ERROR=%s", std::strerror(errno)));
+        return;
+    }
+
+    for (const auto& [storageType, sotrageMetaData] : storages)
+    {
+        // Watch the directory to track the file replacing by rename too.
+        createConfigPath(sotrageMetaData.first);
+        auto watchDescriptor =
+            inotify_add_watch(inotifyFd, sotrageMetaData.first.c_str(),
+                              IN_CLOSE_WRITE | IN_MOVED_TO);
+        if (watchDescriptor < 0)
+        {
+            log<level::ERR>("Fail to watch the configuration path",
+                            entry("PATH=%s", sotrageMetaData.first.c_str()),
+                            entry("ERROR=%s", std::strerror(errno)));
+            close(inotifyFd);
+            inotifyFd = -1;
+            watchedStorages.clear();
+            return;
+        }
+        watchedStorages.emplace(watchDescriptor, storageType);
+    }
 }
 
 void ConfigFile::readData()
 {
-    static std::mutex m;
-    std::lock_guard<std::mutex> lock(m);
-    for (const auto& [storageType, sotrageMetaData] : configFilePathDict)
+    std::lock_guard<std::mutex> lock(readDataMutex);
+    for (const auto& [storageType, sotrageMetaData] : storages)
     {
         readData(storageType, sotrageMetaData.first, sotrageMetaData.second);
     }
 }
 
+void ConfigFile::reloadChangedData()
+{
+    if (inotifyFd < 0)
+    {
+        readData();
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(readDataMutex);
+    std::set<configFileStorageType> changedStorages;
+    alignas(inotify_event) std::array<char, 4096> buffer;
+    ssize_t length;
+    while ((length = read(inotifyFd, buffer.data(), buffer.size())) > 0)
+    {
+        for (auto position = buffer.data(); position < buffer.data() + length;)
+        {
+            const auto event = reinterpret_cast<const inotify_event*>(position);
+            position += sizeof(inotify_event) + event->len;
+            if ((event->mask & IN_Q_OVERFLOW) != 0)
+            {
+                // Some events are lost, reload all storages.
+                for (const auto& [_, storageType] : watchedStorages)
+                {
+                    changedStorages.insert(storageType);
+                }
+                continue;
+            }
+            auto watchedIt = watchedStorages.find(event->wd);
+            if (watchedIt == watchedStorages.end() || event->len == 0)
+            {
+                continue;
+            }
+            const auto& fileName =
+                storages.at(watchedIt->second).second;
+            if (fileName == event->name)
+            {
+                changedStorages.insert(watchedIt->second);
+            }
+        }
+    }
+
+    for (const auto storageType : changedStorages)
+    {
+        const auto& [configPath, configFileName] =
+            storages.at(storageType);
+        log<level::DEBUG>("Reload the changed configuration file",
+                          entry("FILENAME=%s", configFileName.c_str()));
+        readData(storageType, configPath, configFileName);
+    }
+}
+
 void ConfigFile::commit()
 {
-    for (const auto& [storageType, sotrageMetaData] : configFilePathDict)
+    std::lock_guard<std::mutex> lock(commitMutex);
+    commitPending = false;
+    for (const auto& [storageType, sotrageMetaData] : storages)
     {
         writeData(storageType, sotrageMetaData.first, sotrageMetaData.second);
     }
 }
 
+void ConfigFile::scheduleCommit()
+{
+    static const app::core::TimerWheel::DebounceKey commitKey{
+        typeid(ConfigFile), 0};
+    commitPending = true;
+    app::core::application.getTimerWheel().debounce(
+        commitKey, commitInterval, [this]() {
+            if (commitPending)
+            {
+                commit();
+            }
+        });
+}
+
 const std::string& ConfigFile::getSystemUUID()
 {
     return systemUuid;
@@ -432,6 +681,12 @@ void ConfigFile::readData(const session::configFileStorageType storageType,
                           const ConfigFilePath& configPath,
                           const ConfigFileName& configFileName)
 {
+    {
+        // The file might be changed by bmcweb, so the last written data no
+        // longer matches it and the next commit must not be skipped.
+        std::lock_guard<std::mutex> lock(commitMutex);
+        writtenDataHashes.erase(storageType);
+    }
     std::ifstream persistentFile(configPath + "/" + configFileName);
 
     if (persistentFile.is_open())
@@ -464,6 +719,7 @@ void ConfigFile::readData(const session::configFileStorageType storageType,
                 }
                 else if (item.key() == keySessions)
                 {
+                    std::set<std::string> sessionTokens;
                     for (const auto& elem : item.value())
                     {
                         const auto session =
@@ -476,8 +732,11 @@ void ConfigFile::readData(const session::configFileStorageType storageType,
                             continue;
                         }
                         session->storageType = storageType;
+                        sessionTokens.insert(session->sessionToken);
                         SessionStore::getInstance().restore(session);
                     }
+                    SessionStore::getInstance().retainSessions(storageType,
+                                                               sessionTokens);
                 }
                 else if (item.key() == keyTimeout)
                 {
@@ -526,11 +785,6 @@ void ConfigFile::writeData(const configFileStorageType storageType,
                            const ConfigFilePath& configPath,
                            const ConfigFileName& configFileName)
 {
-    createConfigPath(configPath);
-    const auto& persistenConfigFilename = configPath + "/" + configFileName;
-    std::ofstream persistentFile(persistenConfigFilename);
-
-    std::filesystem::permissions(persistenConfigFilename, configPermission);
     nlohmann::json data;
     const auto& handlersDict = configPopulatHandlersDict.at(storageType);
     for (auto& handler : handlersDict)
@@ -538,7 +792,60 @@ void ConfigFile::writeData(const configFileStorageType storageType,
         handler(std::ref(data));
     }
 
-    persistentFile << data;
+    const auto serializedData = data.dump();
+    const auto dataHash = std::hash<std::string>{}(serializedData);
+    auto writtenIt = writtenDataHashes.find(storageType);
+    if (writtenIt != writtenDataHashes.end() && writtenIt->second == dataHash)
+    {
+        return;
+    }
+
+    // Write the temporary file and replace the configuration file by rename
+    // to never leave the half-written file for bmcweb.
+    createConfigPath(configPath);
+    const auto& persistenConfigFilename = configPath + "/" + configFileName;
+    const auto tempFilename = persistenConfigFilename + ".tmp";
+    int fd = open(tempFilename.c_str(),
+                  O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                  S_IRUSR | S_IWUSR | S_IRGRP);
+    if (fd < 0)
+    {
+        log<level::ERR>("Fail to write the configuration file",
+                        entry("FILENAME=%s", tempFilename.c_str()),
+                        entry("ERROR=%s", std::strerror(errno)));
+        return;
+    }
+    // The permissions are applied via the descriptor, so no exception might
+    // leave it opened.
+    bool written = fchmod(fd, static_cast<mode_t>(configPermission)) == 0;
+    for (std::size_t offset = 0; written && offset < serializedData.size();)
+    {
+        auto length = write(fd, serializedData.data() + offset,
+                            serializedData.size() - offset);
+        if (length < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            written = false;
+            break;
+        }
+        offset += static_cast<std::size_t>(length);
+    }
+    written = written && fsync(fd) == 0;
+    close(fd);
+
+    if (!written ||
+        std::rename(tempFilename.c_str(), persistenConfigFilename.c_str()) != 0)
+    {
+        log<level::ERR>("Fail to write the configuration file",
+                        entry("FILENAME=%s", persistenConfigFilename.c_str()),
+                        entry("ERROR=%s", std::strerror(errno)));
+        std::remove(tempFilename.c_str());
+        return;
+    }
+    writtenDataHashes.insert_or_assign(storageType, dataHash);
 }
 
 inline void ConfigFile::createConfigPath(const ConfigFilePath& configPath)
@@ -586,17 +893,17 @@ void ConfigFile::populateSessions(nlohmann::json& config,
 {
     nlohmann::json& sessions = config[keySessions];
     sessions = nlohmann::json::array();
-    for (const auto& p : SessionStore::getInstance().getAuthTokenDict())
+    for (const auto& session : SessionStore::getInstance().getSessions())
     {
-        if (p.second->persistence != PersistenceType::SINGLE_REQUEST &&
-            p.second->storageType == storageType)
+        if (session->persistence != PersistenceType::SINGLE_REQUEST &&
+            session->storageType == storageType)
         {
             sessions.push_back({
-                {"unique_id", p.second->uniqueId},
-                {"session_token", p.second->sessionToken},
-                {"username", p.second->username},
-                {"csrf_token", p.second->csrfToken},
-                {"client_ip", p.second->clientIp},
+                {"unique_id", session->uniqueId},
+                {"session_token", session->sessionToken},
+                {"username", session->username},
+                {"csrf_token", session->csrfToken},
+                {"client_ip", session->clientIp},
             });
         }
     }
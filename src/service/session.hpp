@@ -9,8 +9,18 @@
 #include <phosphor-logging/log.hpp>
 #include <session_manager.hpp>
 
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <fstream>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <queue>
+#include <set>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
 
 namespace app
 {
@@ -57,7 +67,9 @@ struct UserSession
     std::string csrfToken;
     std::string clientId;
     std::string clientIp;
-    std::chrono::time_point<std::chrono::steady_clock> lastUpdated;
+    // Updated by the concurrent readers of the session store.
+    std::atomic<std::chrono::time_point<std::chrono::steady_clock>>
+        lastUpdated;
     PersistenceType persistence;
     bool cookieAuth = false;
     bool isConfigureSelfOnly = false;
@@ -98,8 +110,18 @@ struct AuthConfigMethods
     void fromJson(const nlohmann::json& j);
 };
 
+/**
+ * @class SessionStore
+ * @brief The sessions storage. The sessions are distributed by token among
+ *        the shards, so the token lookups of the concurrent requests take only
+ *        the reader lock of a single shard. The sessions are indexed by the
+ *        unique id too, and their idle timeouts are tracked by the min-heap
+ *        ordered by the last access time.
+ */
 class SessionStore
 {
+    static constexpr std::size_t shardsCount = 16;
+
     const UserSessionPtr generateUserSession(
         const std::string_view username,
         PersistenceType persistence = PersistenceType::TIMEOUT,
@@ -122,37 +144,95 @@ class SessionStore
                                 const std::string_view clientIp);
     const UserSessionPtr loginSessionByToken(const std::string_view token);
     const UserSessionPtr getSessionByUid(const std::string_view uid);
-    std::vector<const std::string*> getUniqueIds(
+    std::vector<std::string> getUniqueIds(
         bool getAll = true,
         const PersistenceType& type = PersistenceType::SINGLE_REQUEST);
     void updateAuthMethodsConfig(const AuthConfigMethods& config);
     void removeSession(const UserSessionPtr& session);
+    /**
+     * @brief Remove the session and write the configuration files behind,
+     *        so the caller isn't blocked by the file writing.
+     */
+    void removeSessionDeferred(const UserSessionPtr& session);
+    /**
+     * @brief Remove the timeout sessions of the storage which are absent in
+     *        the specified tokens set, e.g. the sessions closed by bmcweb.
+     */
+    void retainSessions(const configFileStorageType storageType,
+                        const std::set<std::string>& sessionTokens);
     void updateSessionTimeout(std::chrono::seconds newTimeoutInSeconds);
     AuthConfigMethods& getAuthMethodsConfig();
     int64_t getTimeoutInSeconds() const;
     static SessionStore& getInstance();
+    /**
+     * @brief Remove the sessions idle longer than the timeout. Costs
+     *        O(log n) per expired or touched since the last check session.
+     */
     void applySessionTimeouts();
-    const AuthTokenDict& getAuthTokenDict() const;
+    /**
+     * @brief Get the snapshot of all stored sessions
+     */
+    std::vector<UserSessionPtr> getSessions() const;
     void restore(const UserSessionPtr& session);
 
     SessionStore(const SessionStore&) = delete;
     SessionStore& operator=(const SessionStore&) = delete;
 
-    std::chrono::time_point<std::chrono::steady_clock> lastTimeoutUpdate;
-    std::chrono::seconds timeoutInSeconds;
     AuthConfigMethods authMethodsConfig;
 
-    AuthTokenDict::iterator storeAuthToken(const std::string& token,
-                                           const UserSessionPtr session);
+    const UserSessionPtr storeAuthToken(const UserSessionPtr session);
 
   private:
+    struct Shard
+    {
+        mutable std::shared_mutex mutex;
+        AuthTokenDict sessions;
+    };
+
+    /** The session idle timeout record, the top is the least recently used */
+    struct ExpiryEntry
+    {
+        std::chrono::time_point<std::chrono::steady_clock> lastUpdated;
+        std::string sessionToken;
+
+        bool operator>(const ExpiryEntry& other) const
+        {
+            return lastUpdated > other.lastUpdated;
+        }
+    };
+    using ExpiryQueue =
+        std::priority_queue<ExpiryEntry, std::vector<ExpiryEntry>,
+                            std::greater<ExpiryEntry>>;
+
     SessionStore() : timeoutInSeconds(3600)
     {}
-    AuthTokenDict authTokens;
+
+    Shard& getShard(const std::string& token);
+    const Shard& getShard(const std::string& token) const;
+    /**
+     * @brief Add the session to the store and its indexes
+     *
+     * @return UserSessionPtr - the stored session, that is the already present
+     *                          one if the token is used
+     */
+    const UserSessionPtr insert(const UserSessionPtr& session);
+    /**
+     * @brief Remove the session from the store and its indexes
+     */
+    void erase(const UserSessionPtr& session);
+
+    std::array<Shard, shardsCount> shards;
+    std::unordered_map<std::string, UserSessionPtr> sessionsByUid;
+    mutable std::shared_mutex sessionsByUidMutex;
+    ExpiryQueue expiryQueue;
+    std::chrono::seconds timeoutInSeconds;
+    mutable std::mutex expiryMutex;
 };
 
 using ConfigFilePath = std::string;
 using ConfigFileName = std::string;
+using ConfigFileStorage = std::pair<ConfigFilePath, ConfigFileName>;
+using ConfigDict = std::map<configFileStorageType, ConfigFileStorage>;
 
 class ConfigFile
 {
@@ -163,17 +243,40 @@ class ConfigFile
     static constexpr const char* keySystemUUID = "system_uuid";
     static constexpr const char* keyTimeout = "timeout";
     static constexpr const char* keySessions = "sessions";
+    /** The maximal delay of the write-behind commit */
+    static constexpr std::chrono::seconds commitInterval{5};
 
   public:
     ConfigFile();
+    /**
+     * @brief Use the specified files instead of the bmcweb ones
+     */
+    explicit ConfigFile(const ConfigDict& storages);
     ~ConfigFile();
     void readData();
+    /**
+     * @brief Reload only the configuration files which have been changed
+     *        since the last call. The changes are tracked via inotify, so the
+     *        call is cheap until bmcweb really changes the files.
+     */
+    void reloadChangedData();
+    /**
+     * @brief Write the changed configuration files immediately, e.g. on the
+     *        session creation or removal.
+     */
     void commit();
+    /**
+     * @brief Write the configuration files behind within the commit
+     *        interval. The changes arrived meanwhile are coalesced to the
+     *        single write.
+     */
+    void scheduleCommit();
     const std::string& getSystemUUID();
 
     static ConfigFile& getConfig();
 
   private:
+    void initWatcher();
     void readData(const session::configFileStorageType storageType,
                   const ConfigFilePath& configPath,
                   const ConfigFileName& configFileName);
@@ -218,8 +321,19 @@ class ConfigFile
             },
         };
 
+    /** The configuration files of each storage type */
+    const ConfigDict storages;
     std::string systemUuid{""};
     uint64_t jsonRevision = 1;
+    /** inotify descriptor to watch the configuration files changes */
+    int inotifyFd = -1;
+    /** inotify watch descriptor to the watched storage type */
+    std::map<int, configFileStorageType> watchedStorages;
+    std::mutex readDataMutex;
+    /** Hash of the last written data of each storage to skip the same */
+    std::map<configFileStorageType, std::size_t> writtenDataHashes;
+    std::atomic_bool commitPending = false;
+    std::mutex commitMutex;
     // set the permission of the file to 640
     std::filesystem::perms configPermission =
         std::filesystem::perms::owner_read |
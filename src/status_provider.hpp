@@ -6,10 +6,19 @@
 #include <common_fields.hpp>
 #include <core/entity/dbus_query.hpp>
 #include <core/entity/entity.hpp>
+#include <core/entity/generation_tracker.hpp>
 #include <core/exceptions.hpp>
 #include <core/helpers/utils.hpp>
 #include <formatters.hpp>
 
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
 namespace app
 {
 namespace obmc
@@ -76,6 +85,349 @@ class StatusProvider : public virtual IEntity
     };
 };
 
+/**
+ * @class StatusRollupCache
+ * @brief The computed status rollup of instances and the reverse dependency
+ *        graph of instances which are contributed to the rollup.
+ *        The contributors are observed to mark only affected rollups as
+ *        dirty, so the rollup is recomputed once per change instead of once
+ *        per read. The rollup is also recomputed when instances are added
+ *        or removed to the related entities.
+ */
+class StatusRollupCache final :
+    public IEntity::IInstance::IFieldObserver,
+    public ISingleton<StatusRollupCache>,
+    public std::enable_shared_from_this<StatusRollupCache>
+{
+  public:
+    using InstanceKey = const IEntity::IInstance*;
+    using Status = StatusProvider::Status;
+
+    /**
+     * @brief The version of the data the rollup is computed from. That is
+     *        either the instances collection of the related entity or the
+     *        values of its member. The members supplemented by providers or
+     *        computed on read follow the data they are derived from.
+     */
+    struct Dependency
+    {
+        EntityWeak entity;
+        std::optional<MemberName> member;
+        std::size_t version;
+
+        static Dependency
+            capture(const EntityPtr& entity,
+                    const std::optional<MemberName>& member = std::nullopt)
+        {
+            return {entity, member, getVersion(*entity, member)};
+        }
+
+        bool isActual() const
+        {
+            const auto entityShr = entity.lock();
+            return entityShr && getVersion(*entityShr, member) == version;
+        }
+
+      private:
+        static std::size_t getVersion(const IEntity& entity,
+                                      const std::optional<MemberName>& member)
+        {
+            return member ? entity.getMemberGeneration(*member)
+                          : entity.getInstancesVersion();
+        }
+    };
+    using Dependencies = std::vector<Dependency>;
+
+  private:
+    struct Rollup
+    {
+        std::weak_ptr<IEntity::IInstance> owner;
+        Status status;
+        bool dirty;
+        Dependencies dependencies;
+        /**
+         * @brief The entities the rollup is computed from, including the
+         *        ones of the nested rollups. The cache hit records the
+         *        access to them the same way as computing does.
+         */
+        std::vector<EntityWeak> sourceEntities;
+    };
+    struct Contributor
+    {
+        std::weak_ptr<IEntity::IInstance> owner;
+        std::optional<int> status;
+        std::optional<int> statusRollup;
+        std::set<InstanceKey> dependents;
+    };
+
+    std::unordered_map<InstanceKey, Rollup> rollups;
+    std::unordered_map<InstanceKey, Contributor> contributors;
+    /**
+     * @brief Incremented on each invalidation to detect the changes
+     *        that happen while a rollup is being computed.
+     */
+    std::size_t invalidationEpoch;
+    std::size_t pruneThreshold;
+    mutable std::mutex mutex;
+
+    static constexpr std::size_t minPruneThreshold = 256;
+
+  public:
+    StatusRollupCache(const StatusRollupCache&) = delete;
+    StatusRollupCache& operator=(const StatusRollupCache&) = delete;
+    StatusRollupCache(StatusRollupCache&&) = delete;
+    StatusRollupCache& operator=(StatusRollupCache&&) = delete;
+
+    StatusRollupCache() :
+        invalidationEpoch(0), pruneThreshold(minPruneThreshold)
+    {}
+    ~StatusRollupCache() override = default;
+
+    /**
+     * @brief Get the cached rollup of the instance.
+     *
+     * @param instance - the source instance of the rollup
+     *
+     * @note  The access to the entities the cached rollup is computed from
+     *        is recorded by the active generation trackers.
+     *
+     * @return the valid cached rollup status (if any) and the invalidation
+     *         epoch to pass to the `store()` when the rollup is computed.
+     */
+    std::pair<std::optional<Status>, std::size_t>
+        lookup(const IEntity::InstancePtr& instance)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto rollupIt = rollups.find(instance.get());
+        if (rollupIt == rollups.end())
+        {
+            return {std::nullopt, invalidationEpoch};
+        }
+        const auto& rollup = rollupIt->second;
+        if (rollup.owner.lock() != instance)
+        {
+            // The address of removed instance is reused by another one.
+            rollups.erase(rollupIt);
+            return {std::nullopt, invalidationEpoch};
+        }
+        if (rollup.dirty)
+        {
+            return {std::nullopt, invalidationEpoch};
+        }
+        for (const auto& dependency : rollup.dependencies)
+        {
+            if (!dependency.isActual())
+            {
+                return {std::nullopt, invalidationEpoch};
+            }
+        }
+        for (const auto& entityWeak : rollup.sourceEntities)
+        {
+            if (const auto entity = entityWeak.lock())
+            {
+                GenerationTracker::touch(*entity);
+            }
+        }
+        return {rollup.status, invalidationEpoch};
+    }
+
+    /**
+     * @brief Store the computed rollup and start observing the contributors
+     *
+     * @param instance      - the source instance of the rollup
+     * @param status        - the computed rollup
+     * @param epoch         - the epoch obtained by `lookup()` before
+     *                        computing
+     * @param dependencies  - the versions of related entities
+     * @param contributed   - the instances which are contributed to the
+     *                        rollup
+     *
+     * @note  The dependencies of the nested rollups are inherited, and the
+     *        rollups which are depend on the instance are invalidated if
+     *        the stored status differs from the previous one.
+     */
+    void store(const IEntity::InstancePtr& instance, Status status,
+               std::size_t epoch, Dependencies&& dependencies,
+               const IEntity::InstanceCollection& contributed)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto& rollup = rollups[instance.get()];
+            const bool changed =
+                rollup.owner.lock() == instance && rollup.status != status;
+            rollup.owner = instance;
+            rollup.status = status;
+            // Something has been changed while the rollup was computing.
+            // Keep it dirty to recompute on the next read.
+            rollup.dirty = epoch != invalidationEpoch;
+            rollup.dependencies = std::move(dependencies);
+            rollup.sourceEntities.clear();
+            std::set<const IEntity*> sourceEntities;
+            auto addSourceEntity = [&rollup,
+                                    &sourceEntities](const EntityWeak& weak) {
+                const auto entity = weak.lock();
+                if (entity && sourceEntities.insert(entity.get()).second)
+                {
+                    rollup.sourceEntities.push_back(weak);
+                }
+            };
+            for (const auto& dependency : rollup.dependencies)
+            {
+                addSourceEntity(dependency.entity);
+            }
+            for (const auto& contributorInstance : contributed)
+            {
+                const auto nestedIt = rollups.find(contributorInstance.get());
+                if (contributorInstance != instance &&
+                    nestedIt != rollups.end() &&
+                    nestedIt->second.owner.lock() == contributorInstance)
+                {
+                    for (const auto& nested : nestedIt->second.sourceEntities)
+                    {
+                        addSourceEntity(nested);
+                    }
+                    // The nested rollup isn't re-read on the cache hit, so
+                    // the changes it depends on have to be noticed here.
+                    const auto& nestedDependencies =
+                        nestedIt->second.dependencies;
+                    rollup.dependencies.insert(rollup.dependencies.end(),
+                                               nestedDependencies.begin(),
+                                               nestedDependencies.end());
+                }
+            }
+
+            for (const auto& contributorInstance : contributed)
+            {
+                auto& contributor = contributors[contributorInstance.get()];
+                if (contributor.owner.lock() != contributorInstance)
+                {
+                    contributor = Contributor();
+                    contributor.owner = contributorInstance;
+                }
+                contributor.status = getStatusValue(
+                    contributorInstance, StatusProvider::slotStatus);
+                contributor.statusRollup = getStatusValue(
+                    contributorInstance, StatusProvider::slotStatusRollup);
+                contributor.dependents.insert(instance.get());
+            }
+            if (changed)
+            {
+                invalidate(instance.get());
+                // The rollup itself is actual even if it's contributed to
+                // itself.
+                rollup.dirty = epoch + 1 != invalidationEpoch;
+            }
+            pruneExpired();
+        }
+        for (const auto& contributorInstance : contributed)
+        {
+            contributorInstance->addFieldObserver(weak_from_this());
+        }
+    }
+
+    void onFieldChanged(const IEntity::IInstance& instance,
+                        const MemberName& memberName,
+                        const IEntity::IEntityMember::IInstance::FieldType&
+                            value) override
+    {
+        const bool isStatus = memberName == StatusProvider::fieldStatus;
+        if (!isStatus && memberName != StatusProvider::fieldStatusRollup)
+        {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        auto contributorIt = contributors.find(&instance);
+        if (contributorIt == contributors.end())
+        {
+            return;
+        }
+        auto& contributor = contributorIt->second;
+        if (contributor.owner.lock().get() != &instance)
+        {
+            contributors.erase(contributorIt);
+            return;
+        }
+        std::optional<int> newValue;
+        if (std::holds_alternative<int>(value))
+        {
+            newValue = std::get<int>(value);
+        }
+        auto& observedValue =
+            isStatus ? contributor.status : contributor.statusRollup;
+        if (observedValue == newValue)
+        {
+            return;
+        }
+        observedValue = newValue;
+        invalidate(&instance);
+    }
+
+    void onComplexChanged(const IEntity::IInstance&) override
+    {
+        // The complex instances don't contribute to the status rollup
+    }
+
+  private:
+    static std::optional<int>
+        getStatusValue(const IEntity::InstancePtr& instance, FieldSlot slot)
+    {
+        const auto value = instance->getFieldValue(slot);
+        if (!value || !std::holds_alternative<int>(*value))
+        {
+            return std::nullopt;
+        }
+        return std::get<int>(*value);
+    }
+
+    /**
+     * @brief Mark dirty all rollups which are depends on the contributor
+     *        directly or via intermediate rollups.
+     */
+    void invalidate(InstanceKey changed)
+    {
+        ++invalidationEpoch;
+        std::vector<InstanceKey> queue{changed};
+        while (!queue.empty())
+        {
+            const auto contributor = queue.back();
+            queue.pop_back();
+            auto contributorIt = contributors.find(contributor);
+            if (contributorIt == contributors.end())
+            {
+                continue;
+            }
+            for (const auto dependent : contributorIt->second.dependents)
+            {
+                auto rollupIt = rollups.find(dependent);
+                if (rollupIt != rollups.end() && !rollupIt->second.dirty)
+                {
+                    rollupIt->second.dirty = true;
+                    queue.push_back(dependent);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Remove the records of instances which are already destroyed.
+     */
+    void pruneExpired()
+    {
+        if (rollups.size() + contributors.size() < pruneThreshold)
+        {
+            return;
+        }
+        std::erase_if(rollups, [](const auto& item) {
+            return item.second.owner.expired();
+        });
+        std::erase_if(contributors, [](const auto& item) {
+            return item.second.owner.expired();
+        });
+        pruneThreshold = std::max(minPruneThreshold,
+                                  (rollups.size() + contributors.size()) * 2);
+    }
+};
+
 class StatusRollup final
 {
     const EntityPtr entity;
@@ -93,7 +445,16 @@ class StatusRollup final
     IEntity::IEntityMember::IInstance::FieldType
         operator()(const IEntity::InstancePtr& instance)
     {
+        const auto& cache = StatusRollupCache::getSingleton();
+        const auto [cachedStatus, epoch] = cache->lookup(instance);
+        if (cachedStatus)
+        {
+            return static_cast<int>(*cachedStatus);
+        }
+
         StatusProvider::Status result = StatusProvider::Status::ok;
+        StatusRollupCache::Dependencies dependencies;
+        IEntity::InstanceCollection contributed;
         const auto relations = entity->getRelations();
         for (const auto& relation : relations)
         {
@@ -102,6 +463,33 @@ class StatusRollup final
             {
                 continue;
             }
+            // The versions are obtained before reading instances to be sure
+            // that the later changes will be noticed. The status of related
+            // instances might be supplemented by providers or computed on
+            // read, such changes aren't observable via the fields
+            // notifications until the instances are read again.
+            dependencies.push_back(
+                StatusRollupCache::Dependency::capture(dest));
+            dependencies.push_back(StatusRollupCache::Dependency::capture(
+                dest, StatusProvider::fieldStatus));
+            if (dest->hasMember(StatusProvider::fieldStatusRollup))
+            {
+                dependencies.push_back(StatusRollupCache::Dependency::capture(
+                    dest, StatusProvider::fieldStatusRollup));
+            }
+            // The related instances are changed by the linking fields too.
+            for (const auto& [sourceMember, destMember] :
+                 relation->getLinkMembers())
+            {
+                if (sourceMember != IEntity::IRelation::dummyField)
+                {
+                    dependencies.push_back(
+                        StatusRollupCache::Dependency::capture(entity,
+                                                               sourceMember));
+                }
+                dependencies.push_back(
+                    StatusRollupCache::Dependency::capture(dest, destMember));
+            }
             const auto instancesOfStatus =
                 instance->getRelatedInstances(relation, {}, true);
             for (const auto instance : instancesOfStatus)
@@ -113,7 +501,11 @@ class StatusRollup final
                         StatusProvider::getFieldStatusRollup(instance), result);
                 }
             }
+            contributed.insert(contributed.end(), instancesOfStatus.begin(),
+                               instancesOfStatus.end());
         }
+        cache->store(instance, result, epoch, std::move(dependencies),
+                     contributed);
         return static_cast<int>(result);
     }
 
@@ -254,7 +254,7 @@ class VirtualMedia final :
                 const auto cleanImageName =
                     std::regex_replace(imageUrl, std::regex("\""), "");
                 setFieldExportName(instance, cleanImageName);
-                instance->getField(fieldImageURL)->setValue(nullptr);
+                resetFieldImageURL(instance);
             }
         }
         inline void setWSAddress(const DBusInstancePtr& instance) const
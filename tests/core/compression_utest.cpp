@@ -0,0 +1,171 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2022 YADRO
+
+#include <zlib.h>
+
+#include <core/compression.hpp>
+#include <core/request.hpp>
+#include <core/response.hpp>
+#include <http/headers.hpp>
+
+#include <list>
+#include <memory>
+#include <string>
+
+#include <gtest/gtest.h>
+
+using namespace app::core;
+
+using Encoding = ResponseCompressor::Encoding;
+
+static std::string inflateData(const std::string& data)
+{
+    static constexpr int autoDetectWindowBits = 15 + 32;
+    z_stream stream{};
+    if (inflateInit2(&stream, autoDetectWindowBits) != Z_OK)
+    {
+        return std::string();
+    }
+    std::string result;
+    std::string chunk(4096, '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    int status = Z_OK;
+    while (status == Z_OK)
+    {
+        stream.next_out = reinterpret_cast<Bytef*>(chunk.data());
+        stream.avail_out = static_cast<uInt>(chunk.size());
+        status = inflate(&stream, Z_NO_FLUSH);
+        result.append(chunk.data(), chunk.size() - stream.avail_out);
+    }
+    inflateEnd(&stream);
+    return status == Z_STREAM_END ? result : std::string();
+}
+
+TEST(compression, testNegotiateNoEncoding)
+{
+    EXPECT_EQ(Encoding::identity, ResponseCompressor::negotiate(""));
+    EXPECT_EQ(Encoding::identity, ResponseCompressor::negotiate("br"));
+    EXPECT_EQ(Encoding::identity, ResponseCompressor::negotiate("identity"));
+}
+
+TEST(compression, testNegotiatePlainCodings)
+{
+    EXPECT_EQ(Encoding::gzip, ResponseCompressor::negotiate("gzip"));
+    EXPECT_EQ(Encoding::gzip, ResponseCompressor::negotiate("x-gzip"));
+    EXPECT_EQ(Encoding::deflate, ResponseCompressor::negotiate("deflate"));
+    EXPECT_EQ(Encoding::gzip,
+              ResponseCompressor::negotiate("deflate, GZIP, br"));
+}
+
+TEST(compression, testNegotiateQualityValues)
+{
+    EXPECT_EQ(Encoding::deflate,
+              ResponseCompressor::negotiate("gzip;q=0.5, deflate;q=0.8"));
+    EXPECT_EQ(Encoding::gzip,
+              ResponseCompressor::negotiate("gzip; q=0.9, deflate; Q=0.1"));
+    EXPECT_EQ(Encoding::deflate,
+              ResponseCompressor::negotiate("gzip;q=0, deflate"));
+    EXPECT_EQ(Encoding::identity,
+              ResponseCompressor::negotiate("gzip;q=0, deflate;q=0.000"));
+    EXPECT_EQ(Encoding::identity,
+              ResponseCompressor::negotiate("gzip;q=invalid"));
+}
+
+TEST(compression, testNegotiateWildcard)
+{
+    EXPECT_EQ(Encoding::gzip, ResponseCompressor::negotiate("*"));
+    EXPECT_EQ(Encoding::deflate,
+              ResponseCompressor::negotiate("gzip;q=0, *;q=0.5"));
+    EXPECT_EQ(Encoding::gzip,
+              ResponseCompressor::negotiate("*;q=0.3, gzip;q=0.4"));
+    EXPECT_EQ(Encoding::identity, ResponseCompressor::negotiate("*;q=0"));
+}
+
+TEST(compression, testDeflateRoundTrip)
+{
+    std::string data;
+    for (int index = 0; index < 1000; ++index)
+    {
+        data += "{\"Id\":" + std::to_string(index) + "},";
+    }
+    for (const auto encoding : {Encoding::gzip, Encoding::deflate})
+    {
+        const auto compressed = ResponseCompressor::deflate(data, encoding);
+        ASSERT_TRUE(compressed.has_value());
+        EXPECT_LT(compressed->size(), data.size());
+        EXPECT_EQ(data, inflateData(*compressed));
+    }
+}
+
+class CompressionHeadersTest : public testing::Test
+{
+  protected:
+    RequestPtr makeRequest(const std::string& acceptEncoding)
+    {
+        // The request refers to the environment of the FastCGI request.
+        auto& environment = environments.emplace_back();
+        environment.others["HTTP_ACCEPT_ENCODING"] = acceptEncoding;
+        return std::make_shared<Request>(environment);
+    }
+
+    static ResponsePtr makeResponse(std::size_t bodySize)
+    {
+        auto response = std::make_shared<Response>();
+        response->setStatus(app::http::statuses::Code::OK);
+        response->push(std::string(bodySize, 'a'));
+        return response;
+    }
+
+    static bool hasHeader(const ResponsePtr& response,
+                          const std::string& header)
+    {
+        return response->getHead().find(header) != std::string::npos;
+    }
+
+    ResponseCompressor& compressor = ResponseCompressor::getInstance();
+    std::list<Environment<char>> environments;
+};
+
+TEST_F(CompressionHeadersTest, testVaryOnIdentity)
+{
+    const auto response = makeResponse(4096);
+    compressor.compress(makeRequest(""), response);
+    EXPECT_TRUE(hasHeader(response, "Vary: Accept-Encoding"));
+    EXPECT_FALSE(hasHeader(response, app::http::headers::contentEncoding));
+    EXPECT_EQ(std::string(4096, 'a'), response->getBody());
+}
+
+TEST_F(CompressionHeadersTest, testVaryBelowThreshold)
+{
+    const auto response = makeResponse(16);
+    compressor.compress(makeRequest("gzip"), response);
+    EXPECT_TRUE(hasHeader(response, "Vary: Accept-Encoding"));
+    EXPECT_FALSE(hasHeader(response, app::http::headers::contentEncoding));
+}
+
+TEST_F(CompressionHeadersTest, testVaryOnCompressed)
+{
+    const auto response = makeResponse(4096);
+    compressor.compress(makeRequest("gzip"), response);
+    EXPECT_TRUE(hasHeader(response, "Vary: Accept-Encoding"));
+    EXPECT_TRUE(hasHeader(response, "Content-Encoding: gzip"));
+    EXPECT_EQ(std::string(4096, 'a'), inflateData(response->getBody()));
+}
+
+TEST_F(CompressionHeadersTest, testVaryOnValidatedRepresentation)
+{
+    const auto identity = makeResponse(4096);
+    compressor.compress(makeRequest("identity"), identity, "/test 0 1");
+    EXPECT_TRUE(hasHeader(identity, "Vary: Accept-Encoding"));
+
+    const auto small = makeResponse(16);
+    compressor.compress(makeRequest("gzip"), small, "/test 1 1");
+    EXPECT_TRUE(hasHeader(small, "Vary: Accept-Encoding"));
+
+    compressor.compress(makeRequest("gzip"), makeResponse(4096), "/test 1 2");
+    const auto cached = compressor.find(makeRequest("gzip"), "/test 1 2");
+    ASSERT_NE(nullptr, cached);
+    EXPECT_TRUE(hasHeader(cached, "Vary: Accept-Encoding"));
+    EXPECT_TRUE(hasHeader(cached, "Content-Encoding: gzip"));
+}
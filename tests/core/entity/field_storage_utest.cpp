@@ -0,0 +1,156 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2022 YADRO
+
+#include <core/application.hpp>
+#include <core/entity/entity.hpp>
+
+#include <atomic>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace app::entity;
+
+app::core::Application app::core::application;
+
+using FieldType = IEntity::IEntityMember::IInstance::FieldType;
+
+TEST(fieldSlot, testSameNameSameSlot)
+{
+    EXPECT_EQ(fieldSlot("Name"), fieldSlot(std::string("Name")));
+    EXPECT_EQ("Name", fieldSlotName(fieldSlot("Name")));
+}
+
+TEST(fieldSlot, testDistinctNamesNeverCollide)
+{
+    static constexpr int namesCount = 10000;
+    std::set<FieldSlot> slots;
+    for (int index = 0; index < namesCount; ++index)
+    {
+        const auto name = "CollisionMember" + std::to_string(index);
+        const auto slot = fieldSlot(name);
+        EXPECT_TRUE(slots.insert(slot).second) << name;
+        EXPECT_EQ(name, fieldSlotName(slot));
+    }
+    // The names with equal FNV-1a 32-bit hashes must have their own slots.
+    EXPECT_NE(fieldSlot("costarring"), fieldSlot("liquid"));
+    EXPECT_NE(fieldSlot("declinate"), fieldSlot("macallums"));
+}
+
+TEST(fieldSlot, testSameFieldsOfInstances)
+{
+    auto first = std::make_shared<BaseEntity::StaticInstance>("first");
+    auto second = std::make_shared<BaseEntity::StaticInstance>("second");
+    first->supplement("costarring", std::string("first"));
+    first->supplement("liquid", std::string("second"));
+    second->supplement("liquid", std::string("second"));
+
+    EXPECT_EQ(std::string("first"),
+              first->getField("costarring")->getStringValue());
+    EXPECT_EQ(std::string("second"),
+              first->getField("liquid")->getStringValue());
+    EXPECT_FALSE(second->hasField("costarring"));
+    EXPECT_TRUE(second->getField("costarring")->isNull());
+}
+
+TEST(staticInstance, testFieldIsCopied)
+{
+    auto instance = std::make_shared<BaseEntity::StaticInstance>("item");
+    instance->supplement("Name", std::string("initial"));
+    const auto field = instance->getField("Name");
+    instance->supplementOrUpdate("Name", std::string("changed"));
+
+    EXPECT_EQ(std::string("initial"), field->getStringValue());
+    EXPECT_EQ(std::string("changed"),
+              instance->getField("Name")->getStringValue());
+    EXPECT_EQ(FieldType(std::string("changed")),
+              instance->getFieldValue(fieldSlot("Name")));
+    EXPECT_FALSE(instance->getFieldValue(fieldSlot("Missing")).has_value());
+}
+
+TEST(staticInstance, testSupplementExistingThrows)
+{
+    auto instance = std::make_shared<BaseEntity::StaticInstance>("item");
+    instance->supplement("Name", std::string("initial"));
+    EXPECT_THROW(instance->supplement("Name", std::string("again")),
+                 std::logic_error);
+}
+
+TEST(staticInstance, testUnchangedValueKeepsGeneration)
+{
+    auto instance = std::make_shared<BaseEntity::StaticInstance>("item");
+    instance->supplementOrUpdate("Name", std::string("initial"));
+    const auto generation = instance->getGeneration();
+    instance->supplementOrUpdate("Name", std::string("initial"));
+    EXPECT_EQ(generation, instance->getGeneration());
+    instance->supplementOrUpdate("Name", nullptr);
+    EXPECT_NE(generation, instance->getGeneration());
+    EXPECT_TRUE(instance->getField("Name")->isNull());
+}
+
+TEST(staticInstance, testSupplementWhileReading)
+{
+    static constexpr int fieldsCount = 2000;
+    auto instance = std::make_shared<BaseEntity::StaticInstance>("item");
+    instance->supplement("Name", std::string("stable"));
+    std::vector<std::string> names;
+    for (int index = 0; index < fieldsCount; ++index)
+    {
+        names.emplace_back("SupplementedMember" + std::to_string(index));
+    }
+
+    std::atomic_bool done = false;
+    std::atomic_bool consistent = true;
+    std::vector<std::thread> readers;
+    for (int index = 0; index < 4; ++index)
+    {
+        readers.emplace_back([&instance, &done, &consistent]() {
+            const auto slot = fieldSlot("Name");
+            while (!done)
+            {
+                // The field obtained before the storage is reallocated by
+                // the writer must stay valid.
+                const auto field = instance->getField(slot);
+                std::this_thread::yield();
+                const auto& value = field->getStringValue();
+                if (value != "stable" && value != "updated")
+                {
+                    consistent = false;
+                }
+                const auto copy = instance->getFieldValue(slot);
+                if (!copy || !std::holds_alternative<std::string>(*copy))
+                {
+                    consistent = false;
+                }
+                if (instance->getMemberNames().empty())
+                {
+                    consistent = false;
+                }
+            }
+        });
+    }
+    for (const auto& name : names)
+    {
+        instance->supplementOrUpdate(name, static_cast<int64_t>(name.size()));
+        instance->supplementOrUpdate(
+            "Name", std::string(name.size() % 2 ? "stable" : "updated"));
+    }
+    done = true;
+    for (auto& reader : readers)
+    {
+        reader.join();
+    }
+
+    EXPECT_TRUE(consistent);
+    EXPECT_EQ(static_cast<std::size_t>(fieldsCount + 1),
+              instance->getMemberNames().size());
+    for (const auto& name : names)
+    {
+        EXPECT_EQ(FieldType(static_cast<int64_t>(name.size())),
+                  instance->getFieldValue(fieldSlot(name)));
+    }
+}
@@ -0,0 +1,166 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2022 YADRO
+
+#include <core/application.hpp>
+#include <core/entity/entity.hpp>
+#include <core/entity/generation_tracker.hpp>
+#include <core/router.hpp>
+
+#include <memory>
+#include <string>
+
+#include <gtest/gtest.h>
+
+app::core::Application app::core::application;
+
+namespace app
+{
+namespace entity
+{
+namespace test
+{
+
+using namespace app::query;
+
+class TestItems final : public Collection, public NamedEntity<TestItems>
+{
+  public:
+    ENTITY_DECL_FIELD(std::string, Name)
+
+    void populate() override
+    {}
+    void configure(const QueryPtr) override
+    {}
+
+  protected:
+    ENTITY_DECL_QUERY()
+};
+
+class GenerationTest : public testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        entity = std::make_shared<TestItems>();
+        entity->createMember(TestItems::fieldName);
+        instance = std::make_shared<BaseEntity::StaticInstance>("item");
+        TestItems::setFieldName(instance, "initial");
+        entity->setInstances({instance});
+    }
+
+    GenerationTracker::Generations render() const
+    {
+        GenerationTracker tracker;
+        entity->getInstances();
+        return tracker.getGenerations();
+    }
+
+    std::size_t trackedGeneration() const
+    {
+        const auto generations = render();
+        const auto findIt = generations.find(entity->getName());
+        EXPECT_NE(findIt, generations.end());
+        return findIt != generations.end() ? findIt->second : 0;
+    }
+
+    std::shared_ptr<TestItems> entity;
+    IEntity::InstancePtr instance;
+};
+
+} // namespace test
+} // namespace entity
+} // namespace app
+
+using namespace app::entity;
+using namespace app::entity::test;
+
+TEST_F(GenerationTest, testTrackerRecordsAccess)
+{
+    EXPECT_EQ(entity->getGeneration(), trackedGeneration());
+}
+
+TEST_F(GenerationTest, testTrackerRecordsFirstAccess)
+{
+    GenerationTracker outer;
+    entity->getInstances();
+    const auto recorded = outer.getGenerations().at(entity->getName());
+    {
+        GenerationTracker inner;
+        TestItems::setFieldName(instance, "changed");
+        entity->getInstances();
+        EXPECT_EQ(entity->getGeneration(),
+                  inner.getGenerations().at(entity->getName()));
+    }
+    EXPECT_EQ(recorded, outer.getGenerations().at(entity->getName()));
+    EXPECT_NE(recorded, entity->getGeneration());
+}
+
+TEST_F(GenerationTest, testFieldChangeInvalidates)
+{
+    const auto generation = trackedGeneration();
+    TestItems::setFieldName(instance, "changed");
+    EXPECT_NE(generation, entity->getGeneration());
+    EXPECT_EQ("changed", TestItems::getFieldName(instance));
+}
+
+TEST_F(GenerationTest, testSameValueKeepsGeneration)
+{
+    const auto generation = trackedGeneration();
+    TestItems::setFieldName(instance, "initial");
+    EXPECT_EQ(generation, entity->getGeneration());
+}
+
+TEST_F(GenerationTest, testInstancesChangeInvalidates)
+{
+    const auto generation = trackedGeneration();
+    auto another = std::make_shared<BaseEntity::StaticInstance>("another");
+    TestItems::setFieldName(another, "another");
+    entity->setInstances({another});
+    EXPECT_NE(generation, entity->getGeneration());
+
+    const auto afterInsert = entity->getGeneration();
+    entity->removeInstance(another->getHash());
+    EXPECT_NE(afterInsert, entity->getGeneration());
+}
+
+TEST_F(GenerationTest, testETagMatchesUnchangedRepresentation)
+{
+    static constexpr const char* representation = "/redfish/v1/Items 0";
+    const auto etag = app::core::Router::makeETag(representation, render());
+    EXPECT_NE(0U, etag);
+    // The client revalidating by 'If-None-Match' is answered by 304 while
+    // the rendered entities keep their generations.
+    EXPECT_EQ(etag, app::core::Router::makeETag(representation, render()));
+    TestItems::setFieldName(instance, "initial");
+    EXPECT_EQ(etag, app::core::Router::makeETag(representation, render()));
+    EXPECT_NE(etag, app::core::Router::makeETag("/redfish/v1/Items 1",
+                                                render()));
+}
+
+TEST_F(GenerationTest, testETagChangesAfterFieldChange)
+{
+    static constexpr const char* representation = "/redfish/v1/Items 0";
+    const auto etag = app::core::Router::makeETag(representation, render());
+    TestItems::setFieldName(instance, "changed");
+    const auto changedETag =
+        app::core::Router::makeETag(representation, render());
+    EXPECT_NE(etag, changedETag);
+    EXPECT_NE(0U, changedETag);
+}
+
+TEST_F(GenerationTest, testUnchangedStatusByMethod)
+{
+    using app::core::Router;
+    using Fastcgipp::Http::RequestMethod;
+    using app::http::statuses::Code;
+
+    EXPECT_EQ(Code::NotModified,
+              Router::getUnchangedStatus(RequestMethod::GET));
+    EXPECT_EQ(Code::NotModified,
+              Router::getUnchangedStatus(RequestMethod::HEAD));
+    // The GraphQL queries are sent by POST.
+    EXPECT_EQ(Code::PreconditionFailed,
+              Router::getUnchangedStatus(RequestMethod::POST));
+    EXPECT_EQ(Code::PreconditionFailed,
+              Router::getUnchangedStatus(RequestMethod::PUT));
+}
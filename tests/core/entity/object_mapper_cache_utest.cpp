@@ -0,0 +1,140 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2022 YADRO
+
+#include <core/application.hpp>
+#include <core/entity/dbus_query.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+app::core::Application app::core::application;
+
+namespace app
+{
+namespace query
+{
+namespace dbus
+{
+namespace test
+{
+
+/**
+ * @brief The source which reply is dispatched by the dedicated thread, as
+ *        the DBus replies are dispatched by the event loop thread.
+ */
+class TestSource final : public ObjectMapperCache::ISource
+{
+  public:
+    TestSource() :
+        tree{
+            {"/a", {{"test.Service", {"test.Interface"}}}},
+        },
+        replyFuture(reply.get_future().share())
+    {}
+    ~TestSource() override = default;
+
+    ObjectMapperCache::SubTree getTree() const override
+    {
+        if (!isDispatcherThread())
+        {
+            loadingStarted.set_value();
+            replyFuture.wait();
+        }
+        return tree;
+    }
+
+    bool isDispatcherThread() const noexcept override
+    {
+        return dispatcherThread.load() == std::this_thread::get_id();
+    }
+
+    void dispatchReply()
+    {
+        std::call_once(replyDispatched, [this]() { reply.set_value(); });
+    }
+
+    const ObjectMapperCache::SubTree tree;
+    std::atomic<std::thread::id> dispatcherThread;
+    mutable std::promise<void> loadingStarted;
+
+  private:
+    std::once_flag replyDispatched;
+    std::promise<void> reply;
+    std::shared_future<void> replyFuture;
+};
+
+class ObjectMapperCacheTest : public testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        loader = std::async(std::launch::async, [this]() {
+            return cache.getObject(source, "/a", {});
+        });
+        source.loadingStarted.get_future().wait();
+    }
+
+    void TearDown() override
+    {
+        source.dispatchReply();
+        if (loader.valid())
+        {
+            loader.wait();
+        }
+    }
+
+    std::future<ObjectMapperCache::ObjectServices> lookupByDispatcher()
+    {
+        return std::async(std::launch::async, [this]() {
+            source.dispatcherThread.store(std::this_thread::get_id());
+            return cache.getObject(source, "/a", {});
+        });
+    }
+
+    ObjectMapperCache cache;
+    TestSource source;
+    std::future<ObjectMapperCache::ObjectServices> loader;
+};
+
+} // namespace test
+} // namespace dbus
+} // namespace query
+} // namespace app
+
+using namespace std::chrono_literals;
+using namespace app::query::dbus;
+using namespace app::query::dbus::test;
+
+TEST_F(ObjectMapperCacheTest, testDispatcherDoesNotWaitForLoader)
+{
+    auto dispatcherLookup = lookupByDispatcher();
+    // The loader is blocked until the reply is dispatched, so the dispatcher
+    // waiting for the loader would never complete the lookup.
+    const auto status = dispatcherLookup.wait_for(5s);
+    source.dispatchReply();
+    ASSERT_EQ(std::future_status::ready, status);
+    EXPECT_EQ(1U, dispatcherLookup.get().size());
+    EXPECT_EQ(1U, loader.get().size());
+}
+
+TEST_F(ObjectMapperCacheTest, testUpdatesReplayedOverLoadedMirror)
+{
+    auto dispatcherLookup = lookupByDispatcher();
+    if (dispatcherLookup.wait_for(5s) != std::future_status::ready)
+    {
+        source.dispatchReply();
+        FAIL() << "The dispatcher waits for the loader";
+    }
+    // The update arrives while the loader is still in progress.
+    cache.addInterfaces("test.Service", "/b", {"test.Interface"});
+    EXPECT_EQ(1U, cache.getObject(source, "/b", {}).size());
+
+    source.dispatchReply();
+    loader.wait();
+    EXPECT_EQ(1U, cache.getObject(source, "/b", {}).size());
+}
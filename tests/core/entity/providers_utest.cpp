@@ -0,0 +1,156 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2022 YADRO
+
+#include <core/application.hpp>
+#include <core/entity/entity.hpp>
+
+#include <memory>
+#include <string>
+
+#include <gtest/gtest.h>
+
+app::core::Application app::core::application;
+
+namespace app
+{
+namespace entity
+{
+namespace test
+{
+
+using namespace app::query;
+
+class TestSource final :
+    public EntitySupplementProvider,
+    public ISingleton<TestSource>,
+    public NamedEntity<TestSource>
+{
+  public:
+    ENTITY_DECL_FIELD(std::string, Key)
+    ENTITY_DECL_FIELD(std::string, Value)
+
+    TestSource()
+    {
+        this->createMember(fieldKey);
+        this->createMember(fieldValue);
+    }
+
+    void populate() override
+    {}
+    void configure(const QueryPtr) override
+    {}
+
+  protected:
+    ENTITY_DECL_QUERY()
+};
+
+class TestTargets final : public Collection, public NamedEntity<TestTargets>
+{
+  public:
+    ENTITY_DECL_FIELD(std::string, Key)
+
+    TestTargets()
+    {
+        this->createMember(fieldKey);
+    }
+
+    void populate() override
+    {}
+    void configure(const QueryPtr) override
+    {}
+
+  protected:
+    static void linkValue(const IEntity::InstancePtr& supplement,
+                          const IEntity::InstancePtr& target)
+    {
+        if (TestSource::getFieldKey(supplement) == getFieldKey(target))
+        {
+            TestSource::setFieldValue(target,
+                                      TestSource::getFieldValue(supplement));
+        }
+    }
+
+    ENTITY_DECL_QUERY()
+    ENTITY_DECL_PROVIDERS(ENTITY_PROVIDER_LINK(TestSource, linkValue))
+};
+
+class ProvidersTest : public testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        source = TestSource::getSingleton();
+        source->resetCache();
+        targets = std::make_shared<TestTargets>();
+        targets->initialize();
+
+        sourceInstance = std::make_shared<BaseEntity::StaticInstance>("first");
+        TestSource::setFieldKey(sourceInstance, "first");
+        TestSource::setFieldValue(sourceInstance, "initial");
+        source->setInstances({sourceInstance});
+
+        target = std::make_shared<BaseEntity::StaticInstance>("target");
+        TestTargets::setFieldKey(target, "first");
+        targets->setInstances({target});
+    }
+
+    std::string providedValue() const
+    {
+        return TestSource::getFieldValue(target);
+    }
+
+    std::shared_ptr<TestSource> source;
+    std::shared_ptr<TestTargets> targets;
+    IEntity::InstancePtr sourceInstance;
+    IEntity::InstancePtr target;
+};
+
+} // namespace test
+} // namespace entity
+} // namespace app
+
+using namespace app::entity;
+using namespace app::entity::test;
+
+TEST_F(ProvidersTest, testSupplementedOnAdding)
+{
+    EXPECT_EQ("initial", providedValue());
+}
+
+TEST_F(ProvidersTest, testSupplementedOnProviderChange)
+{
+    TestSource::setFieldValue(sourceInstance, "changed");
+    // The target isn't read, the contribution is pushed by the provider.
+    EXPECT_EQ("changed", providedValue());
+}
+
+TEST_F(ProvidersTest, testReadDoesNotWrite)
+{
+    targets->getInstances();
+    const auto generation = target->getGeneration();
+    const auto entityGeneration = targets->getGeneration();
+    targets->getInstances();
+    targets->getInstances();
+    EXPECT_EQ(generation, target->getGeneration());
+    EXPECT_EQ(entityGeneration, targets->getGeneration());
+    EXPECT_EQ("initial", providedValue());
+}
+
+TEST_F(ProvidersTest, testSupplementedOnLinkFieldChange)
+{
+    auto secondInstance =
+        std::make_shared<BaseEntity::StaticInstance>("second");
+    TestSource::setFieldKey(secondInstance, "second");
+    TestSource::setFieldValue(secondInstance, "second value");
+    source->mergeInstance(secondInstance);
+    EXPECT_EQ("initial", providedValue());
+
+    TestTargets::setFieldKey(target, "second");
+    EXPECT_EQ("second value", providedValue());
+}
+
+TEST_F(ProvidersTest, testNotSuppliedMemberReset)
+{
+    source->removeInstance(sourceInstance->getHash());
+    EXPECT_TRUE(target->getField(TestSource::fieldValue)->isNull());
+}
@@ -0,0 +1,128 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2022 YADRO
+
+#include <core/entity/entity.hpp>
+
+#include <atomic>
+#include <map>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace app::entity;
+
+using Snapshot = InstancesSnapshot<std::map<int, int>>;
+
+TEST(instancesSnapshot, testReadersKeepTheirVersion)
+{
+    Snapshot snapshot;
+    snapshot.update([](auto& data) {
+        data.emplace(1, 1);
+        return true;
+    });
+    const auto before = snapshot.get();
+    snapshot.update([](auto& data) {
+        data.emplace(2, 2);
+        return true;
+    });
+    const auto after = snapshot.get();
+
+    EXPECT_EQ(1U, before->size());
+    EXPECT_EQ(2U, after->size());
+    EXPECT_NE(before.get(), after.get());
+}
+
+TEST(instancesSnapshot, testVersionCountsPublications)
+{
+    Snapshot snapshot;
+    EXPECT_EQ(0U, snapshot.getVersion());
+    snapshot.update([](auto& data) {
+        data.emplace(1, 1);
+        return true;
+    });
+    EXPECT_EQ(1U, snapshot.getVersion());
+    snapshot.reset();
+    EXPECT_EQ(2U, snapshot.getVersion());
+    EXPECT_TRUE(snapshot.get()->empty());
+}
+
+TEST(instancesSnapshot, testUnchangedDataIsNotPublished)
+{
+    Snapshot snapshot;
+    const auto initial = snapshot.get();
+    snapshot.update([](auto& data) {
+        data.emplace(1, 1);
+        return false;
+    });
+    EXPECT_EQ(0U, snapshot.getVersion());
+    EXPECT_EQ(initial.get(), snapshot.get().get());
+    EXPECT_TRUE(snapshot.get()->empty());
+}
+
+TEST(instancesSnapshot, testInspectorSkipsCopy)
+{
+    Snapshot snapshot;
+    const auto initial = snapshot.get();
+    bool modifierCalled = false;
+    snapshot.update([](const auto&) { return false; },
+                    [&modifierCalled](auto&) {
+                        modifierCalled = true;
+                        return true;
+                    });
+    EXPECT_FALSE(modifierCalled);
+    EXPECT_EQ(initial.get(), snapshot.get().get());
+
+    snapshot.update([](const auto& data) { return !data.contains(1); },
+                    [](auto& data) {
+                        data.emplace(1, 1);
+                        return true;
+                    });
+    EXPECT_EQ(1U, snapshot.getVersion());
+    EXPECT_EQ(1U, snapshot.get()->count(1));
+}
+
+TEST(instancesSnapshot, testConcurrentReadersSeeConsistentData)
+{
+    static constexpr int itemsCount = 1000;
+    Snapshot snapshot;
+    std::atomic_bool done = false;
+    std::atomic_bool consistent = true;
+
+    std::vector<std::thread> readers;
+    for (int index = 0; index < 4; ++index)
+    {
+        readers.emplace_back([&snapshot, &done, &consistent]() {
+            while (!done)
+            {
+                // Each published version holds the keys [0, size) with the
+                // values equal to the keys.
+                const auto data = snapshot.get();
+                int expected = 0;
+                for (const auto& [key, value] : *data)
+                {
+                    if (key != expected++ || value != key)
+                    {
+                        consistent = false;
+                    }
+                }
+            }
+        });
+    }
+    for (int index = 0; index < itemsCount; ++index)
+    {
+        snapshot.update([index](auto& data) {
+            data.emplace(index, index);
+            return true;
+        });
+    }
+    done = true;
+    for (auto& reader : readers)
+    {
+        reader.join();
+    }
+
+    EXPECT_TRUE(consistent);
+    EXPECT_EQ(static_cast<std::size_t>(itemsCount), snapshot.get()->size());
+    EXPECT_EQ(static_cast<std::size_t>(itemsCount), snapshot.getVersion());
+}
@@ -0,0 +1,107 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2022 YADRO
+
+#include <core/helpers/mpsc_queue.hpp>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace app::helpers;
+
+TEST(mpscQueue, testPopEmpty)
+{
+    MpscQueue<int> queue;
+    EXPECT_TRUE(queue.popAll().empty());
+}
+
+TEST(mpscQueue, testOrderOfPushing)
+{
+    MpscQueue<int> queue;
+    for (int item = 0; item < 5; ++item)
+    {
+        queue.push(int(item));
+    }
+    EXPECT_EQ((std::vector<int>{0, 1, 2, 3, 4}), queue.popAll());
+    EXPECT_TRUE(queue.popAll().empty());
+}
+
+TEST(mpscQueue, testNotifyOnlyFirstPush)
+{
+    MpscQueue<int> queue;
+    EXPECT_TRUE(queue.push(1));
+    EXPECT_FALSE(queue.push(2));
+    queue.popAll();
+    EXPECT_TRUE(queue.push(3));
+}
+
+TEST(mpscQueue, testMoveOnlyItems)
+{
+    MpscQueue<std::unique_ptr<int>> queue;
+    queue.push(std::make_unique<int>(1));
+    queue.push(std::make_unique<int>(2));
+    const auto items = queue.popAll();
+    ASSERT_EQ(2U, items.size());
+    EXPECT_EQ(1, *items[0]);
+    EXPECT_EQ(2, *items[1]);
+}
+
+TEST(mpscQueue, testPendingItemsReleased)
+{
+    auto item = std::make_shared<int>(1);
+    {
+        MpscQueue<std::shared_ptr<int>> queue;
+        queue.push(std::shared_ptr<int>(item));
+        queue.push(std::shared_ptr<int>(item));
+        EXPECT_EQ(3, item.use_count());
+    }
+    EXPECT_EQ(1, item.use_count());
+}
+
+TEST(mpscQueue, testConcurrentProducers)
+{
+    static constexpr int producersCount = 4;
+    static constexpr int itemsCount = 10000;
+    MpscQueue<std::pair<int, int>> queue;
+    std::atomic<int> finished(0);
+
+    std::vector<std::thread> producers;
+    for (int producer = 0; producer < producersCount; ++producer)
+    {
+        producers.emplace_back([&queue, &finished, producer]() {
+            for (int item = 0; item < itemsCount; ++item)
+            {
+                queue.push({producer, item});
+            }
+            ++finished;
+        });
+    }
+
+    // Each producer's items must be taken once and in the order of pushing.
+    std::vector<int> expected(producersCount, 0);
+    auto consume = [&queue, &expected]() {
+        for (const auto& [producer, item] : queue.popAll())
+        {
+            EXPECT_EQ(expected[producer], item);
+            expected[producer] = item + 1;
+        }
+    };
+    while (finished != producersCount)
+    {
+        consume();
+    }
+    for (auto& producer : producers)
+    {
+        producer.join();
+    }
+    consume();
+
+    for (int producer = 0; producer < producersCount; ++producer)
+    {
+        EXPECT_EQ(itemsCount, expected[producer]);
+    }
+}
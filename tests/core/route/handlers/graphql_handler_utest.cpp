@@ -0,0 +1,348 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2022 YADRO
+
+#include <core/application.hpp>
+#include <core/entity/entity.hpp>
+#include <core/route/handlers/graphql_handler.hpp>
+#include <graphqlparser/AstVisitor.h>
+#include <graphqlparser/GraphQLParser.h>
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+app::core::Application app::core::application;
+
+namespace app
+{
+namespace entity
+{
+namespace test
+{
+
+using namespace app::query;
+
+class TestItems final : public Collection, public NamedEntity<TestItems>
+{
+  public:
+    ENTITY_DECL_FIELD(std::string, Name)
+    ENTITY_DECL_FIELD_DEF(int64_t, Id, 0)
+
+    void populate() override
+    {}
+    void configure(const QueryPtr) override
+    {}
+
+  protected:
+    ENTITY_DECL_QUERY()
+};
+
+} // namespace test
+} // namespace entity
+} // namespace app
+
+using namespace app::core::route;
+using namespace app::core::route::handlers;
+using namespace app::entity;
+using namespace app::entity::test;
+
+TEST(graphqlNormalize, testSeparatorsCollapsed)
+{
+    EXPECT_EQ("{ Items { Id Name } }",
+              GraphqlRouter::normalizeQuery("  {\n\tItems {\r\n Id,\n Name"
+                                            " }\n}\n"));
+    EXPECT_EQ("{Items{Id Name}}",
+              GraphqlRouter::normalizeQuery("{Items{Id,,,Name}}"));
+    EXPECT_EQ("", GraphqlRouter::normalizeQuery(" ,\n\t "));
+}
+
+TEST(graphqlNormalize, testCommentsStripped)
+{
+    EXPECT_EQ("{ Items { Id } }",
+              GraphqlRouter::normalizeQuery("# the list of items\n"
+                                            "{ Items { # trailing\n"
+                                            "  Id # another\r\n} }"));
+    EXPECT_EQ("{ Items }", GraphqlRouter::normalizeQuery("{ Items }# end"));
+}
+
+TEST(graphqlNormalize, testStringsKeptVerbatim)
+{
+    EXPECT_EQ(R"({ Items(Name: "a,  b # c") { Id } })",
+              GraphqlRouter::normalizeQuery(
+                  "{ Items(Name: \"a,  b # c\") {\n Id\n} }"));
+    EXPECT_EQ(R"({ Items(Name: "say \"hi,  there\"") })",
+              GraphqlRouter::normalizeQuery(
+                  R"({ Items(Name:   "say \"hi,  there\"") })"));
+}
+
+TEST(graphqlNormalize, testBlockStringsKeptVerbatim)
+{
+    EXPECT_EQ("{ Items(Name: \"\"\"line 1,\n  # not a comment\n\"\"\") }",
+              GraphqlRouter::normalizeQuery(
+                  "{ Items(Name:\n\"\"\"line 1,\n  # not a comment\n\"\"\") "
+                  "}"));
+    EXPECT_EQ(R"({ Items(Name: """escaped \""" quote""") })",
+              GraphqlRouter::normalizeQuery(
+                  R"({ Items(Name: """escaped \""" quote""")   })"));
+}
+
+TEST(graphqlNormalize, testUnterminatedStrings)
+{
+    EXPECT_EQ(R"({ Items(Name: "open,  string)",
+              GraphqlRouter::normalizeQuery(R"({ Items(Name: "open,  string)"));
+    EXPECT_EQ(R"({ Items(Name: """open,  block)",
+              GraphqlRouter::normalizeQuery(
+                  R"({ Items(Name: """open,  block)"));
+}
+
+namespace
+{
+
+using facebook::graphql::ast::Argument;
+
+class ArgumentsCollector : public facebook::graphql::ast::visitor::AstVisitor
+{
+  public:
+    bool visitArgument(const Argument& argument) override
+    {
+        arguments.push_back(&argument);
+        return false;
+    }
+
+    std::vector<const Argument*> arguments;
+};
+
+class GraphqlFilterTest : public testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        entity = std::make_shared<TestItems>();
+        entity->createMember(TestItems::fieldName);
+        entity->createMember(TestItems::fieldId);
+        first = createInstance("first", "item-1", 1);
+        second = createInstance("second", "item-2", 2);
+        other = createInstance("other", "other", 3);
+    }
+
+    static IEntity::InstancePtr createInstance(const std::string& identity,
+                                               const std::string& name,
+                                               int64_t id)
+    {
+        auto instance = std::make_shared<BaseEntity::StaticInstance>(identity);
+        TestItems::setFieldName(instance, name);
+        TestItems::setFieldId(instance, id);
+        return instance;
+    }
+
+    /**
+     * @brief Build the condition of the single argument of the object field
+     *
+     * @param argument - the GraphQL text of the argument
+     */
+    IEntity::ConditionPtr buildCondition(const std::string& argument) const
+    {
+        const std::string text = "{ TestItems(" + argument + ") { Id } }";
+        const char* error = nullptr;
+        const auto ast = facebook::graphql::parseString(text.c_str(), &error);
+        if (!ast)
+        {
+            free(const_cast<char*>(error));
+            ADD_FAILURE() << "Malformed document: " << text;
+            return nullptr;
+        }
+        ArgumentsCollector collector;
+        ast->accept(&collector);
+        if (collector.arguments.size() != 1)
+        {
+            ADD_FAILURE() << "Single argument expected: " << text;
+            return nullptr;
+        }
+        const auto& parsed = *collector.arguments.front();
+        return GqlQueryVisitor::buildCondition(
+            entity, parsed.getName().getValue(), parsed.getValue());
+    }
+
+    std::shared_ptr<TestItems> entity;
+    IEntity::InstancePtr first;
+    IEntity::InstancePtr second;
+    IEntity::InstancePtr other;
+};
+
+} // namespace
+
+TEST_F(GraphqlFilterTest, testEqual)
+{
+    const auto byName = buildCondition(R"(Name: "item-1")");
+    ASSERT_TRUE(byName);
+    EXPECT_TRUE(first->checkCondition(byName));
+    EXPECT_FALSE(second->checkCondition(byName));
+
+    const auto byId = buildCondition("Id: 2");
+    ASSERT_TRUE(byId);
+    EXPECT_FALSE(first->checkCondition(byId));
+    EXPECT_TRUE(second->checkCondition(byId));
+}
+
+TEST_F(GraphqlFilterTest, testNot)
+{
+    const auto byName = buildCondition(R"(Name_not: "item-1")");
+    ASSERT_TRUE(byName);
+    EXPECT_FALSE(first->checkCondition(byName));
+    EXPECT_TRUE(second->checkCondition(byName));
+    EXPECT_TRUE(other->checkCondition(byName));
+
+    const auto byId = buildCondition("Id_not: 3.0");
+    ASSERT_TRUE(byId);
+    EXPECT_TRUE(first->checkCondition(byId));
+    EXPECT_FALSE(other->checkCondition(byId));
+}
+
+TEST_F(GraphqlFilterTest, testIn)
+{
+    const auto byName = buildCondition(R"(Name_in: ["item-2", "other"])");
+    ASSERT_TRUE(byName);
+    EXPECT_FALSE(first->checkCondition(byName));
+    EXPECT_TRUE(second->checkCondition(byName));
+    EXPECT_TRUE(other->checkCondition(byName));
+
+    const auto byId = buildCondition("Id_in: [1, 3]");
+    ASSERT_TRUE(byId);
+    EXPECT_TRUE(first->checkCondition(byId));
+    EXPECT_FALSE(second->checkCondition(byId));
+    EXPECT_TRUE(other->checkCondition(byId));
+
+    const auto empty = buildCondition("Id_in: []");
+    ASSERT_TRUE(empty);
+    EXPECT_FALSE(first->checkCondition(empty));
+}
+
+TEST_F(GraphqlFilterTest, testStartsWith)
+{
+    const auto byName = buildCondition(R"(Name_starts_with: "item-")");
+    ASSERT_TRUE(byName);
+    EXPECT_TRUE(first->checkCondition(byName));
+    EXPECT_TRUE(second->checkCondition(byName));
+    EXPECT_FALSE(other->checkCondition(byName));
+
+    const auto byId = buildCondition(R"(Id_starts_with: "1")");
+    ASSERT_TRUE(byId);
+    EXPECT_FALSE(first->checkCondition(byId));
+}
+
+TEST_F(GraphqlFilterTest, testInvalidArguments)
+{
+    using app::core::route::handlers::exceptions::GqlInvalidArgument;
+    EXPECT_THROW(buildCondition(R"(Unknown: "value")"), GqlInvalidArgument);
+    EXPECT_THROW(buildCondition(R"(Unknown_not: "value")"),
+                 GqlInvalidArgument);
+    EXPECT_THROW(buildCondition(R"(Name_in: "item-1")"), GqlInvalidArgument);
+    EXPECT_THROW(buildCondition("Id_starts_with: 1"), GqlInvalidArgument);
+}
+
+namespace
+{
+
+/**
+ * @brief The instance which fields fail to be read
+ */
+class BrokenInstance final : public BaseEntity::StaticInstance
+{
+  public:
+    using BaseEntity::StaticInstance::getField;
+    using BaseEntity::StaticInstance::StaticInstance;
+
+    const IEntity::IEntityMember::InstancePtr
+        getField(const IEntity::EntityMemberPtr&) const override
+    {
+        throw app::entity::exceptions::EntityException("Broken instance");
+    }
+};
+
+class GraphqlWriteDataTest : public testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        entity = std::make_shared<TestItems>();
+        entity->createMember(TestItems::fieldName);
+        entity->createMember(TestItems::fieldId);
+        auto instance = std::make_shared<BaseEntity::StaticInstance>("first");
+        TestItems::setFieldName(instance, "item-1");
+        TestItems::setFieldId(instance, 1);
+        instances.push_back(instance);
+    }
+
+    static GqlPlanNode projectMember(const EntityPtr& entity,
+                                     const std::string& member)
+    {
+        GqlPlanNode node;
+        node.action = GqlPlanNode::Action::projectMember;
+        node.fieldName = member;
+        node.member = entity->getMember(member);
+        return node;
+    }
+
+    /**
+     * @brief Execute '{ TestItems { Id Name } }' and write its result
+     */
+    json writeData(int indent)
+    {
+        entity->setInstances(instances);
+        GqlPlanNode items;
+        items.action = GqlPlanNode::Action::scanEntity;
+        items.fieldName = "TestItems";
+        items.entity = entity;
+        items.selections.push_back(projectMember(entity, TestItems::fieldId));
+        items.selections.push_back(
+            projectMember(entity, TestItems::fieldName));
+        const GqlPlan plan{{"query", {items}}};
+
+        GraphqlRouter::GqlPlanExecutors executors;
+        executors.push_back(std::make_unique<GqlPlanExecutor>(plan.front()));
+        std::ostringstream os;
+        GraphqlRouter::writeData(os, plan, executors, indent);
+        EXPECT_TRUE(json::accept(os.str())) << os.str();
+        return json::parse(os.str(), nullptr, false);
+    }
+
+    std::shared_ptr<TestItems> entity;
+    IEntity::InstanceCollection instances;
+};
+
+} // namespace
+
+TEST_F(GraphqlWriteDataTest, testWriteData)
+{
+    const auto result = writeData(0);
+    EXPECT_FALSE(result.contains(fields::respFieldError));
+    const auto& items = result[fields::respFieldData]["query"]["TestItems"];
+    ASSERT_EQ(1U, items.size());
+    EXPECT_EQ(1, items[0]["Id"]);
+    EXPECT_EQ("item-1", items[0]["Name"]);
+}
+
+TEST_F(GraphqlWriteDataTest, testNestedErrorKeepsDocumentValid)
+{
+    instances.push_back(std::make_shared<BrokenInstance>("broken"));
+    for (const int indent : {0, 2})
+    {
+        const auto result = writeData(indent);
+        ASSERT_FALSE(result.is_discarded());
+        // The result written before the error is kept, the field which
+        // failed to be written is null.
+        const auto& items =
+            result[fields::respFieldData]["query"]["TestItems"];
+        ASSERT_EQ(2U, items.size());
+        const auto& written = items[0]["Id"].is_null() ? items[1] : items[0];
+        const auto& failed = items[0]["Id"].is_null() ? items[0] : items[1];
+        EXPECT_EQ(1, written["Id"]);
+        EXPECT_TRUE(failed["Id"].is_null());
+        EXPECT_FALSE(failed.contains("Name"));
+        EXPECT_EQ("Invalid Argument",
+                  result[fields::respFieldError]["Target"]);
+    }
+}
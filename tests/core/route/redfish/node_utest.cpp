@@ -0,0 +1,164 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2022 YADRO
+
+#include <core/application.hpp>
+#include <core/entity/entity.hpp>
+#include <core/request.hpp>
+#include <core/route/redfish/node.hpp>
+
+#include <array>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+app::core::Application app::core::application;
+
+namespace app
+{
+namespace core
+{
+namespace redfish
+{
+namespace test
+{
+
+using namespace app::query;
+
+class TestItems final : public Collection, public NamedEntity<TestItems>
+{
+  public:
+    ENTITY_DECL_FIELD(std::string, Name)
+
+    void populate() override
+    {}
+    void configure(const QueryPtr) override
+    {}
+
+  protected:
+    ENTITY_DECL_QUERY()
+};
+
+/**
+ * @brief The parameterized node which claims any segment
+ */
+class ParameterizedChild :
+    public Node<ParameterizedChild>,
+    public ParameterizedNode<ParameterizedChild>
+{
+  public:
+    using TParameterEntity = TestItems;
+
+    explicit ParameterizedChild(const RedfishContextPtr ctx) :
+        Node<ParameterizedChild>(ctx),
+        ParameterizedNode<ParameterizedChild>(ctx)
+    {}
+    ~ParameterizedChild() override = default;
+
+    static bool matchParameter(const RedfishContextPtr, const std::string&)
+    {
+        return true;
+    }
+
+    static IEntity::ConditionsList getConditions(const RedfishContextPtr,
+                                                 const std::string&)
+    {
+        return {};
+    }
+};
+
+class StaticChild : public Node<StaticChild>
+{
+  public:
+    static constexpr const char* segment = "Static";
+
+    explicit StaticChild(const RedfishContextPtr ctx) : Node<StaticChild>(ctx)
+    {}
+    ~StaticChild() override = default;
+};
+
+class PrefixedChild : public Node<PrefixedChild>, public IStaticSegments
+{
+  public:
+    static constexpr const char* segment = "Item";
+    static constexpr std::array<const char*, 1> uriPrefix{"Prefix"};
+
+    explicit PrefixedChild(const RedfishContextPtr ctx) :
+        Node<PrefixedChild>(ctx)
+    {}
+    ~PrefixedChild() override = default;
+};
+
+/**
+ * @brief The parameterized child is declared first, so it would claim each
+ *        segment if the children were validated in the declaration order.
+ */
+class TestRoot :
+    public Node<TestRoot, ParameterizedChild, StaticChild, PrefixedChild>
+{
+  public:
+    static constexpr const char* segment = "redfish";
+
+    explicit TestRoot(const RedfishContextPtr ctx) :
+        Node<TestRoot, ParameterizedChild, StaticChild, PrefixedChild>(ctx)
+    {}
+    ~TestRoot() override = default;
+};
+
+} // namespace test
+} // namespace redfish
+} // namespace core
+} // namespace app
+
+using namespace app::core;
+using namespace app::core::redfish;
+using namespace app::core::redfish::test;
+
+class ChildDispatchTest : public testing::Test
+{
+  protected:
+    std::shared_ptr<INode> resolve(const std::vector<std::string>& pathInfo)
+    {
+        // The request refers to the environment of the FastCGI request.
+        auto& environment = environments.emplace_back();
+        environment.pathInfo = pathInfo;
+        const auto request = std::make_shared<Request>(environment);
+        return TestRoot::uriResolver(
+            std::make_shared<RedfishContext>(request));
+    }
+
+    template <class TNode>
+    static bool isResolvedTo(const std::shared_ptr<INode>& node)
+    {
+        return std::dynamic_pointer_cast<TNode>(node) != nullptr;
+    }
+
+    std::list<Environment<char>> environments;
+};
+
+TEST_F(ChildDispatchTest, testStaticChildTakesPrecedence)
+{
+    EXPECT_TRUE(isResolvedTo<StaticChild>(resolve({"redfish", "Static"})));
+    EXPECT_TRUE(isResolvedTo<PrefixedChild>(
+        resolve({"redfish", "Prefix", "Item"})));
+}
+
+TEST_F(ChildDispatchTest, testParameterizedChildFallback)
+{
+    EXPECT_TRUE(
+        isResolvedTo<ParameterizedChild>(resolve({"redfish", "Other"})));
+    // The segment differs from the static one only by the case.
+    EXPECT_TRUE(
+        isResolvedTo<ParameterizedChild>(resolve({"redfish", "static"})));
+}
+
+TEST_F(ChildDispatchTest, testUnknownNode)
+{
+    EXPECT_TRUE(isResolvedTo<TestRoot>(resolve({"redfish"})));
+    // The static child claims its segment even if the rest of path is not
+    // found.
+    EXPECT_TRUE(isResolvedTo<NodeNotFound>(
+        resolve({"redfish", "Static", "Unknown"})));
+}
@@ -0,0 +1,87 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2022 YADRO
+
+#include <core/application.hpp>
+#include <core/route/redfish/response.hpp>
+#include <core/router.hpp>
+#include <http/headers.hpp>
+#include <nlohmann/json.hpp>
+
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+app::core::Application app::core::application;
+
+using namespace app::core;
+using namespace app::core::redfish;
+
+namespace
+{
+
+/**
+ * @brief Expose the headers common for all responses to check them
+ */
+class TestRouter final : public Router
+{
+  public:
+    using Router::setGeneralHeaders;
+};
+
+} // namespace
+
+class RedfishResponseTest : public testing::Test
+{
+  protected:
+    RedfishResponsePtr makeResponse(bool prettyOutput) const
+    {
+        auto response = std::make_shared<RedfishResponse>(prettyOutput);
+        response->add("Name", "Test");
+        response->add("Members",
+                      nlohmann::json::array({{{"@odata.id", "/a"}},
+                                             {{"@odata.id", "/b"}}}));
+        response->flash();
+        TestRouter::setGeneralHeaders(response);
+        return response;
+    }
+
+    static std::string writeBody(const IResponse& response)
+    {
+        std::ostringstream os;
+        response.writeBody(os);
+        return os.str();
+    }
+};
+
+TEST_F(RedfishResponseTest, testPayloadStreamedWithoutContentLength)
+{
+    const auto response = makeResponse(false);
+    EXPECT_TRUE(response->isStreamed());
+    EXPECT_EQ(std::string::npos,
+              response->getHead().find(app::http::headers::contentLength));
+
+    const auto body = writeBody(*response);
+    ASSERT_TRUE(nlohmann::json::accept(body));
+    EXPECT_EQ(response->getJson(), nlohmann::json::parse(body));
+}
+
+TEST_F(RedfishResponseTest, testFlashReplacesBody)
+{
+    const auto response = makeResponse(false);
+    response->add("Id", "1");
+    response->flash();
+    const auto payload = nlohmann::json::parse(writeBody(*response));
+    EXPECT_EQ("1", payload["Id"]);
+    EXPECT_EQ("Test", payload["Name"]);
+}
+
+TEST_F(RedfishResponseTest, testPrettyOutputBuffered)
+{
+    const auto response = makeResponse(true);
+    EXPECT_FALSE(response->isStreamed());
+    EXPECT_NE(std::string::npos,
+              response->getHead().find(app::http::headers::contentLength));
+    EXPECT_EQ(response->getBody(), writeBody(*response));
+}
@@ -0,0 +1,133 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2022 YADRO
+
+#include <core/timer_wheel.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <typeinfo>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace app::core;
+using namespace std::chrono_literals;
+
+class TimerWheelTest : public testing::Test
+{
+  protected:
+    using Clock = TimerWheel::Clock;
+
+    void SetUp() override
+    {
+        wheel.run();
+    }
+
+    void TearDown() override
+    {
+        wheel.terminate();
+    }
+
+    TimerWheel::Callback record(int tag)
+    {
+        return [this, tag]() {
+            {
+                std::lock_guard lock(mutex);
+                performed.emplace_back(tag, Clock::now());
+            }
+            changed.notify_all();
+        };
+    }
+
+    bool waitPerformed(std::size_t count,
+                       Clock::duration timeout = std::chrono::seconds(5))
+    {
+        std::unique_lock lock(mutex);
+        return changed.wait_for(lock, timeout, [this, count]() {
+            return performed.size() >= count;
+        });
+    }
+
+    std::size_t performedCount()
+    {
+        std::lock_guard lock(mutex);
+        return performed.size();
+    }
+
+    TimerWheel wheel;
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::vector<std::pair<int, Clock::time_point>> performed;
+};
+
+TEST_F(TimerWheelTest, testScheduleNotBeforeDelay)
+{
+    const auto started = Clock::now();
+    wheel.schedule(50ms, record(1));
+    ASSERT_TRUE(waitPerformed(1));
+    EXPECT_GE(performed[0].second - started, 50ms);
+}
+
+TEST_F(TimerWheelTest, testScheduleOrderOfDeadlines)
+{
+    wheel.schedule(60ms, record(3));
+    wheel.schedule(20ms, record(1));
+    wheel.schedule(40ms, record(2));
+    ASSERT_TRUE(waitPerformed(3));
+    EXPECT_EQ(1, performed[0].first);
+    EXPECT_EQ(2, performed[1].first);
+    EXPECT_EQ(3, performed[2].first);
+}
+
+TEST_F(TimerWheelTest, testScheduleBeyondFirstLevel)
+{
+    // The deadline doesn't fit the lowest level and is cascaded down when the
+    // wheel turns to its slot.
+    const auto started = Clock::now();
+    wheel.schedule(700ms, record(1));
+    ASSERT_TRUE(waitPerformed(1));
+    EXPECT_GE(performed[0].second - started, 700ms);
+}
+
+TEST_F(TimerWheelTest, testCancel)
+{
+    const auto timerId = wheel.schedule(30ms, record(1));
+    wheel.schedule(60ms, record(2));
+    EXPECT_TRUE(wheel.cancel(timerId));
+    EXPECT_FALSE(wheel.cancel(timerId));
+    ASSERT_TRUE(waitPerformed(1));
+    EXPECT_EQ(2, performed[0].first);
+}
+
+TEST_F(TimerWheelTest, testDebounceCoalesced)
+{
+    const TimerWheel::DebounceKey key{typeid(TimerWheelTest), 1};
+    EXPECT_TRUE(wheel.debounce(key, 30ms, record(1)));
+    EXPECT_FALSE(wheel.debounce(key, 30ms, record(2)));
+    EXPECT_TRUE(wheel.debounce({typeid(TimerWheel), 1}, 30ms, record(3)));
+    ASSERT_TRUE(waitPerformed(2));
+    EXPECT_FALSE(waitPerformed(3, 100ms));
+    EXPECT_EQ(1, performed[0].first);
+    EXPECT_EQ(3, performed[1].first);
+
+    // The key is released once the task is performed.
+    EXPECT_TRUE(wheel.debounce(key, 30ms, record(4)));
+    ASSERT_TRUE(waitPerformed(3));
+    EXPECT_EQ(4, performed[2].first);
+}
+
+TEST_F(TimerWheelTest, testDebounceLimitPerformsOnNextTick)
+{
+    const auto window = 10s;
+    for (std::size_t key = 0; key < TimerWheel::maxPendingDebounced; ++key)
+    {
+        ASSERT_TRUE(
+            wheel.debounce({typeid(TimerWheelTest), key}, window, []() {}));
+    }
+    EXPECT_TRUE(wheel.debounce(
+        {typeid(TimerWheelTest), TimerWheel::maxPendingDebounced}, window,
+        record(1)));
+    ASSERT_TRUE(waitPerformed(1, 1s));
+    EXPECT_EQ(1U, performedCount());
+}
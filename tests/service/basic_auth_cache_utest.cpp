@@ -0,0 +1,179 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2022 YADRO
+
+#include <core/application.hpp>
+#include <service/basic_auth_cache.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+app::core::Application app::core::application;
+
+using namespace app::service;
+using namespace app::service::authorization;
+using namespace std::chrono_literals;
+
+class BasicAuthCacheTest : public testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        char directoryTemplate[] = "/tmp/basic_auth_cache_utestXXXXXX";
+        ASSERT_NE(nullptr, mkdtemp(directoryTemplate));
+        directory = directoryTemplate;
+        shadowFile = directory + "/shadow";
+        std::ofstream(shadowFile) << "root:hash\n";
+        cache = createCache(1h);
+    }
+
+    void TearDown() override
+    {
+        cache.reset();
+        std::filesystem::remove_all(directory);
+    }
+
+    std::unique_ptr<BasicAuthCache>
+        createCache(std::chrono::steady_clock::duration lifetime)
+    {
+        return std::make_unique<BasicAuthCache>(
+            lifetime, shadowFile, [this]() { return accountsGeneration; });
+    }
+
+    static session::UserSessionPtr makeSession()
+    {
+        auto session = std::make_shared<session::UserSession>();
+        session->persistence = session::PersistenceType::SINGLE_REQUEST;
+        return session;
+    }
+
+    void touchShadowFile()
+    {
+        const auto modified = std::filesystem::last_write_time(shadowFile);
+        std::filesystem::last_write_time(shadowFile, modified + 1s);
+    }
+
+    std::string directory;
+    std::string shadowFile;
+    std::size_t accountsGeneration = 1;
+    std::unique_ptr<BasicAuthCache> cache;
+};
+
+TEST_F(BasicAuthCacheTest, testKeyedByCredentials)
+{
+    const auto session = makeSession();
+    cache->store("user", "password", session);
+    EXPECT_EQ(session, cache->find("user", "password"));
+    EXPECT_EQ(nullptr, cache->find("user", "wrong"));
+    EXPECT_EQ(nullptr, cache->find("other", "password"));
+    // The same concatenation of the username and the password.
+    EXPECT_EQ(nullptr, cache->find("userp", "assword"));
+    EXPECT_EQ(nullptr, cache->find("use", "rpassword"));
+}
+
+TEST_F(BasicAuthCacheTest, testKeyIsPerInstance)
+{
+    cache->store("user", "password", makeSession());
+    const auto otherCache = createCache(1h);
+    EXPECT_EQ(nullptr, otherCache->find("user", "password"));
+}
+
+TEST_F(BasicAuthCacheTest, testSingleSessionPerPrincipal)
+{
+    cache->store("user", "old", makeSession());
+    const auto session = makeSession();
+    cache->store("user", "new", session);
+    EXPECT_EQ(nullptr, cache->find("user", "old"));
+    EXPECT_EQ(session, cache->find("user", "new"));
+}
+
+TEST_F(BasicAuthCacheTest, testExpired)
+{
+    cache = createCache(50ms);
+    cache->store("user", "password", makeSession());
+    EXPECT_NE(nullptr, cache->find("user", "password"));
+    std::this_thread::sleep_for(100ms);
+    EXPECT_EQ(nullptr, cache->find("user", "password"));
+}
+
+TEST_F(BasicAuthCacheTest, testEvictedAboveLimit)
+{
+    for (std::size_t index = 0; index <= BasicAuthCache::maxEntries; ++index)
+    {
+        cache->store("user" + std::to_string(index), "password",
+                     makeSession());
+    }
+    std::size_t found = 0;
+    for (std::size_t index = 0; index <= BasicAuthCache::maxEntries; ++index)
+    {
+        if (cache->find("user" + std::to_string(index), "password"))
+        {
+            ++found;
+        }
+    }
+    EXPECT_EQ(BasicAuthCache::maxEntries, found);
+    EXPECT_NE(nullptr,
+              cache->find("user" + std::to_string(BasicAuthCache::maxEntries),
+                          "password"));
+}
+
+TEST_F(BasicAuthCacheTest, testInvalidatedOnAccountsChanged)
+{
+    cache->store("user", "password", makeSession());
+    ++accountsGeneration;
+    EXPECT_EQ(nullptr, cache->find("user", "password"));
+}
+
+TEST_F(BasicAuthCacheTest, testInvalidatedOnShadowChanged)
+{
+    cache->store("user", "password", makeSession());
+    EXPECT_NE(nullptr, cache->find("user", "password"));
+    touchShadowFile();
+    EXPECT_EQ(nullptr, cache->find("user", "password"));
+}
+
+TEST_F(BasicAuthCacheTest, testInvalidatedOnShadowMissed)
+{
+    cache->store("user", "password", makeSession());
+    std::filesystem::remove(shadowFile);
+    EXPECT_EQ(nullptr, cache->find("user", "password"));
+}
+
+TEST_F(BasicAuthCacheTest, testPrincipalForgottenOnPamFailure)
+{
+    cache->store("user", "password", makeSession());
+    cache->store("other", "password", makeSession());
+    ASSERT_TRUE(cache->await("user", "wrong", [](std::optional<int>) {}));
+    cache->complete("user", "wrong", PAM_AUTH_ERR);
+    EXPECT_EQ(nullptr, cache->find("user", "password"));
+    EXPECT_NE(nullptr, cache->find("other", "password"));
+}
+
+TEST_F(BasicAuthCacheTest, testConcurrentMissesCoalesced)
+{
+    std::optional<int> first;
+    std::optional<int> second;
+    EXPECT_TRUE(cache->await("user", "password",
+                             [&first](std::optional<int> pamStatus) {
+                                 first = pamStatus;
+                             }));
+    EXPECT_FALSE(cache->await("user", "password",
+                              [&second](std::optional<int> pamStatus) {
+                                  second = pamStatus;
+                              }));
+    // Another credentials are verified independently.
+    EXPECT_TRUE(cache->await("user", "other", [](std::optional<int>) {}));
+
+    cache->complete("user", "password", PAM_SUCCESS);
+    EXPECT_EQ(PAM_SUCCESS, first);
+    EXPECT_EQ(PAM_SUCCESS, second);
+
+    // The next miss starts the new verification.
+    EXPECT_TRUE(cache->await("user", "password", [](std::optional<int>) {}));
+}
@@ -0,0 +1,288 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2022 YADRO
+
+#include <core/application.hpp>
+#include <nlohmann/json.hpp>
+#include <service/session.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+app::core::Application app::core::application;
+
+using namespace app::service::session;
+using namespace std::chrono_literals;
+
+namespace
+{
+
+constexpr auto storageType = configFileStorageType::configCurrentBmcSession;
+
+/**
+ * @brief Make the session restored from the configuration file
+ */
+UserSessionPtr makeSession(const std::string& token,
+                           const std::string& uniqueId = "")
+{
+    auto session = UserSession::fromJson({
+        {"unique_id", uniqueId.empty() ? "id" + token : uniqueId},
+        {"session_token", token},
+        {"username", "user"},
+        {"csrf_token", "csrf" + token},
+        {"client_ip", "127.0.0.1"},
+    });
+    session->storageType = storageType;
+    return session;
+}
+
+/**
+ * @brief Make the distinct session token of the valid size
+ */
+std::string makeToken(std::size_t index)
+{
+    auto token = std::to_string(index);
+    token.insert(0, sessionTokenSize - token.size(), 't');
+    return token;
+}
+
+} // namespace
+
+class ConfigFileTest : public testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        char directoryTemplate[] = "/tmp/config_file_utestXXXXXX";
+        ASSERT_NE(nullptr, mkdtemp(directoryTemplate));
+        directory = directoryTemplate;
+        config = std::make_unique<ConfigFile>(ConfigDict{
+            {configFileStorageType::configLongTermStorage,
+             {directory + "/persistent", "persistent.json"}},
+            {storageType, {directory + "/sessions", "sessions.json"}},
+        });
+    }
+
+    void TearDown() override
+    {
+        config.reset();
+        SessionStore::getInstance().retainSessions(storageType, {});
+        std::filesystem::remove_all(directory);
+    }
+
+    nlohmann::json readSessionsFile() const
+    {
+        std::ifstream file(directory + "/sessions/sessions.json");
+        return nlohmann::json::parse(file);
+    }
+
+    /**
+     * @brief Replace the sessions file as bmcweb does
+     */
+    void writeSessionsFile(const nlohmann::json& data) const
+    {
+        const auto fileName = directory + "/sessions/sessions.json";
+        {
+            std::ofstream file(fileName + ".bmcweb");
+            file << data.dump();
+        }
+        std::rename((fileName + ".bmcweb").c_str(), fileName.c_str());
+    }
+
+    std::set<std::string> storedTokens() const
+    {
+        std::set<std::string> tokens;
+        const auto data = readSessionsFile();
+        for (const auto& session : data["sessions"])
+        {
+            tokens.insert(session["session_token"].get<std::string>());
+        }
+        return tokens;
+    }
+
+    std::string directory;
+    std::unique_ptr<ConfigFile> config;
+};
+
+TEST_F(ConfigFileTest, testCommitAfterReloadOfChangedFile)
+{
+    const std::string ownToken = "s0000000000000000000";
+    const std::string bmcwebToken = "x0000000000000000000";
+
+    SessionStore::getInstance().restore(makeSession(ownToken));
+    config->commit();
+    EXPECT_EQ(std::set<std::string>{ownToken}, storedTokens());
+
+    // bmcweb creates another session.
+    auto data = readSessionsFile();
+    data["sessions"].push_back({
+        {"unique_id", "id" + bmcwebToken},
+        {"session_token", bmcwebToken},
+        {"username", "user"},
+        {"csrf_token", "csrf" + bmcwebToken},
+        {"client_ip", "127.0.0.1"},
+    });
+    writeSessionsFile(data);
+    config->reloadChangedData();
+    ASSERT_NE(nullptr, SessionStore::getInstance().loginSessionByToken(
+                           bmcwebToken));
+
+    // The session is closed, so the sessions are the same as written before
+    // the reload, but the file still keeps the closed one.
+    SessionStore::getInstance().retainSessions(storageType, {ownToken});
+    config->commit();
+    EXPECT_EQ(std::set<std::string>{ownToken}, storedTokens());
+}
+
+class SessionStoreTest : public testing::Test
+{
+  protected:
+    void TearDown() override
+    {
+        store.updateSessionTimeout(std::chrono::seconds(3600));
+        store.retainSessions(storageType, {});
+    }
+
+    UserSessionPtr restoreSession(
+        const std::string& token, const std::string& uniqueId = "",
+        std::chrono::steady_clock::duration idle =
+            std::chrono::steady_clock::duration::zero())
+    {
+        auto session = makeSession(token, uniqueId);
+        session->lastUpdated = std::chrono::steady_clock::now() - idle;
+        store.restore(session);
+        return session;
+    }
+
+    bool isStored(const UserSessionPtr& session) const
+    {
+        const auto sessions = store.getSessions();
+        return std::find(sessions.begin(), sessions.end(), session) !=
+               sessions.end();
+    }
+
+    SessionStore& store = SessionStore::getInstance();
+};
+
+TEST_F(SessionStoreTest, testLookupByToken)
+{
+    // The sessions are distributed among all shards.
+    static constexpr std::size_t sessionsCount = 64;
+    std::vector<UserSessionPtr> sessions;
+    for (std::size_t index = 0; index < sessionsCount; ++index)
+    {
+        sessions.push_back(restoreSession(makeToken(index)));
+    }
+    for (std::size_t index = 0; index < sessionsCount; ++index)
+    {
+        EXPECT_EQ(sessions[index],
+                  store.loginSessionByToken(makeToken(index)));
+    }
+    EXPECT_EQ(sessionsCount, store.getSessions().size());
+    EXPECT_EQ(nullptr, store.loginSessionByToken(makeToken(sessionsCount)));
+    EXPECT_EQ(nullptr, store.loginSessionByToken("short"));
+}
+
+TEST_F(SessionStoreTest, testUsedTokenKeepsStoredSession)
+{
+    const auto stored = restoreSession(makeToken(0), "stored");
+    const auto duplicate = restoreSession(makeToken(0), "duplicate");
+    EXPECT_EQ(stored, store.loginSessionByToken(makeToken(0)));
+    EXPECT_EQ(stored, store.getSessionByUid("stored"));
+    EXPECT_EQ(nullptr, store.getSessionByUid("duplicate"));
+    EXPECT_FALSE(isStored(duplicate));
+}
+
+TEST_F(SessionStoreTest, testUidIndexFollowsRemoval)
+{
+    const auto closed = restoreSession(makeToken(0), "closed");
+    const auto retained = restoreSession(makeToken(1), "retained");
+    EXPECT_EQ(closed, store.getSessionByUid("closed"));
+
+    store.retainSessions(storageType, {makeToken(1)});
+    EXPECT_EQ(nullptr, store.getSessionByUid("closed"));
+    EXPECT_EQ(nullptr, store.loginSessionByToken(makeToken(0)));
+    EXPECT_EQ(retained, store.getSessionByUid("retained"));
+    EXPECT_EQ(std::vector<std::string>{"retained"}, store.getUniqueIds());
+}
+
+TEST_F(SessionStoreTest, testExpiredSessionsRemoved)
+{
+    store.updateSessionTimeout(std::chrono::seconds(60));
+    const auto expired = restoreSession(makeToken(0), "", 2min);
+    const auto alive = restoreSession(makeToken(1), "", 30s);
+
+    store.applySessionTimeouts();
+    EXPECT_FALSE(isStored(expired));
+    EXPECT_EQ(nullptr, store.getSessionByUid(expired->uniqueId));
+    EXPECT_TRUE(isStored(alive));
+}
+
+TEST_F(SessionStoreTest, testAccessedSessionNotExpired)
+{
+    store.updateSessionTimeout(std::chrono::seconds(60));
+    const auto session = restoreSession(makeToken(0), "", 2min);
+    // The expiry queue still keeps the access time known at the restoring.
+    session->lastUpdated = std::chrono::steady_clock::now();
+
+    store.applySessionTimeouts();
+    EXPECT_TRUE(isStored(session));
+    EXPECT_EQ(session, store.getSessionByUid(session->uniqueId));
+}
+
+TEST_F(SessionStoreTest, testConcurrentLookups)
+{
+    static constexpr std::size_t sessionsCount = 64;
+    static constexpr std::size_t readersCount = 4;
+    std::vector<UserSessionPtr> sessions;
+    for (std::size_t index = 0; index < sessionsCount; ++index)
+    {
+        sessions.push_back(restoreSession(makeToken(index)));
+    }
+
+    std::atomic<std::size_t> mismatches(0);
+    std::vector<std::thread> readers;
+    for (std::size_t reader = 0; reader < readersCount; ++reader)
+    {
+        readers.emplace_back([this, &sessions, &mismatches]() {
+            for (std::size_t round = 0; round < 100; ++round)
+            {
+                for (std::size_t index = 0; index < sessionsCount; ++index)
+                {
+                    if (store.loginSessionByToken(makeToken(index)) !=
+                        sessions[index])
+                    {
+                        ++mismatches;
+                    }
+                }
+            }
+        });
+    }
+    // The sessions of other shards are added and removed meanwhile.
+    for (std::size_t index = sessionsCount; index < sessionsCount * 2; ++index)
+    {
+        restoreSession(makeToken(index));
+    }
+    std::set<std::string> retained;
+    for (std::size_t index = 0; index < sessionsCount; ++index)
+    {
+        retained.insert(makeToken(index));
+    }
+    store.retainSessions(storageType, retained);
+    for (auto& reader : readers)
+    {
+        reader.join();
+    }
+    EXPECT_EQ(0U, mismatches.load());
+    EXPECT_EQ(sessionsCount, store.getSessions().size());
+}
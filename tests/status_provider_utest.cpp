@@ -0,0 +1,235 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2022 YADRO
+
+#include <core/application.hpp>
+#include <core/entity/entity.hpp>
+#include <status_provider.hpp>
+
+#include <memory>
+#include <string>
+
+#include <gtest/gtest.h>
+
+app::core::Application app::core::application;
+
+namespace app
+{
+namespace entity
+{
+namespace test
+{
+
+using namespace app::query;
+using Status = obmc::entity::StatusProvider::Status;
+using StatusProvider = obmc::entity::StatusProvider;
+
+class TestChassis final : public Collection, public NamedEntity<TestChassis>
+{
+  public:
+    ENTITY_DECL_FIELD(std::string, Id)
+
+    void populate() override
+    {}
+    void configure(const QueryPtr) override
+    {}
+
+    const Relations& getRelations() const override
+    {
+        return relations;
+    }
+
+    Relations relations;
+
+  protected:
+    ENTITY_DECL_QUERY()
+};
+
+class TestSensors final : public Collection, public NamedEntity<TestSensors>
+{
+  public:
+    ENTITY_DECL_FIELD(std::string, ChassisId)
+
+    void populate() override
+    {}
+    void configure(const QueryPtr) override
+    {}
+
+  protected:
+    ENTITY_DECL_QUERY()
+};
+
+class TestStatusSource final :
+    public EntitySupplementProvider,
+    public ISingleton<TestStatusSource>,
+    public NamedEntity<TestStatusSource>
+{
+  public:
+    ENTITY_DECL_FIELD(std::string, ChassisId)
+
+    TestStatusSource()
+    {
+        this->createMember(fieldChassisId);
+        this->createMember(StatusProvider::fieldStatus);
+    }
+
+    void populate() override
+    {}
+    void configure(const QueryPtr) override
+    {}
+
+  protected:
+    ENTITY_DECL_QUERY()
+};
+
+/**
+ * @brief The sensors which status is supplemented by the provider on read.
+ */
+class TestProvidedSensors final :
+    public Collection,
+    public NamedEntity<TestProvidedSensors>
+{
+  public:
+    void populate() override
+    {}
+    void configure(const QueryPtr) override
+    {}
+
+  protected:
+    static void linkStatus(const IEntity::InstancePtr& supplement,
+                           const IEntity::InstancePtr& target)
+    {
+        if (TestStatusSource::getFieldChassisId(supplement) ==
+            TestSensors::getFieldChassisId(target))
+        {
+            StatusProvider::setFieldStatus(
+                target, StatusProvider::getFieldStatus(supplement));
+        }
+    }
+
+    ENTITY_DECL_QUERY()
+    ENTITY_DECL_PROVIDERS(ENTITY_PROVIDER_LINK(TestStatusSource, linkStatus))
+};
+
+class StatusRollupTest : public testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        chassis = std::make_shared<TestChassis>();
+        sensors = std::make_shared<TestSensors>();
+        chassis->initialize();
+        chassis->createMember(TestChassis::fieldId);
+        sensors->initialize();
+        sensors->createMember(TestSensors::fieldChassisId);
+        sensors->createMember(StatusProvider::fieldStatus);
+        chassis->relations.push_back(
+            BaseEntity::Relation::build(chassis, sensors, linkRules()));
+
+        chassisInstance =
+            std::make_shared<BaseEntity::StaticInstance>("chassis");
+        TestChassis::setFieldId(chassisInstance, "chassis");
+        chassis->setInstances({chassisInstance});
+
+        sensor = addSensor("sensor", "chassis", Status::ok);
+    }
+
+    static const IEntity::IRelation::RelationRulesList& linkRules()
+    {
+        static const IEntity::IRelation::RelationRulesList rules{
+            {
+                TestChassis::fieldId,
+                TestSensors::fieldChassisId,
+                IEntity::ICondition::Equal<std::string>(),
+            },
+        };
+        return rules;
+    }
+
+    IEntity::InstancePtr addSensor(const std::string& id,
+                                   const std::string& chassisId, Status status)
+    {
+        auto instance = std::make_shared<BaseEntity::StaticInstance>(id);
+        TestSensors::setFieldChassisId(instance, chassisId);
+        StatusProvider::setFieldStatus(instance, status);
+        sensors->mergeInstance(instance);
+        return instance;
+    }
+
+    Status rollup()
+    {
+        obmc::entity::StatusRollup statusRollup(chassis);
+        return static_cast<Status>(
+            std::get<int>(statusRollup(chassisInstance)));
+    }
+
+    std::shared_ptr<TestChassis> chassis;
+    std::shared_ptr<TestSensors> sensors;
+    IEntity::InstancePtr chassisInstance;
+    IEntity::InstancePtr sensor;
+};
+
+} // namespace test
+} // namespace entity
+} // namespace app
+
+using namespace app::entity;
+using namespace app::entity::test;
+
+TEST_F(StatusRollupTest, testContributorStatusChanged)
+{
+    EXPECT_EQ(Status::ok, rollup());
+    StatusProvider::setFieldStatus(sensor, Status::critical);
+    EXPECT_EQ(Status::critical, rollup());
+    StatusProvider::setFieldStatus(sensor, Status::ok);
+    EXPECT_EQ(Status::ok, rollup());
+}
+
+TEST_F(StatusRollupTest, testContributorAdded)
+{
+    EXPECT_EQ(Status::ok, rollup());
+    addSensor("warning", "chassis", Status::warning);
+    EXPECT_EQ(Status::warning, rollup());
+}
+
+TEST_F(StatusRollupTest, testLinkingFieldChanged)
+{
+    const auto unrelated = addSensor("unrelated", "other", Status::critical);
+    EXPECT_EQ(Status::ok, rollup());
+
+    // The unrelated instance becomes a contributor.
+    TestSensors::setFieldChassisId(unrelated, "chassis");
+    EXPECT_EQ(Status::critical, rollup());
+
+    // The contributor leaves the rollup.
+    TestSensors::setFieldChassisId(unrelated, "other");
+    EXPECT_EQ(Status::ok, rollup());
+}
+
+TEST_F(StatusRollupTest, testProvidedStatusChanged)
+{
+    const auto provided = std::make_shared<TestProvidedSensors>();
+    provided->initialize();
+    provided->createMember(TestSensors::fieldChassisId);
+    provided->createMember(StatusProvider::fieldStatus);
+    chassis->relations.clear();
+    chassis->relations.push_back(
+        BaseEntity::Relation::build(chassis, provided, linkRules()));
+
+    auto providedSensor =
+        std::make_shared<BaseEntity::StaticInstance>("provided");
+    TestSensors::setFieldChassisId(providedSensor, "chassis");
+    provided->setInstances({providedSensor});
+
+    const auto source = TestStatusSource::getSingleton();
+    auto sourceInstance =
+        std::make_shared<BaseEntity::StaticInstance>("source");
+    TestStatusSource::setFieldChassisId(sourceInstance, "chassis");
+    StatusProvider::setFieldStatus(sourceInstance, Status::ok);
+    source->setInstances({sourceInstance});
+
+    EXPECT_EQ(Status::ok, rollup());
+    // The status of the contributor is changed only by the provider, the
+    // contributor itself isn't read until the rollup is recomputed.
+    StatusProvider::setFieldStatus(sourceInstance, Status::warning);
+    EXPECT_EQ(Status::warning, rollup());
+}